@@ -7,6 +7,7 @@
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 
 /* 이 파일의 코드는 ATA (IDE) 컨트롤러에 대한 인터페이스입니다. 
 	[ATA-3] 표준을 준수하려고 시도합니다. */
@@ -231,6 +232,7 @@ disk_size(struct disk *d)
 		PANIC("%s: disk read failed, sector=%" PRDSNu, d->name, sec_no);
 	input_sector(c, buffer);
 	d->read_cnt++;
+	thread_usage()->sectors_read++;
 	lock_release(&c->lock);
 }
 
@@ -254,6 +256,7 @@ disk_size(struct disk *d)
 	output_sector(c, buffer);
 	sema_down(&c->completion_wait);
 	d->write_cnt++;
+	thread_usage()->sectors_written++;
 	lock_release(&c->lock);
 }
 
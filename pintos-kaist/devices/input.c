@@ -2,14 +2,19 @@
 #include <debug.h>
 #include "devices/intq.h"
 #include "devices/serial.h"
+#include "threads/synch.h"
 
 /* Stores keys from the keyboard and serial port. */
 static struct intq buffer;
 
+/* poll()로 입력을 기다리는 스레드들. */
+static struct poll_queue input_pollers;
+
 /* Initializes the input buffer. */
 void
 input_init (void) {
 	intq_init (&buffer);
+	poll_queue_init (&input_pollers);
 }
 
 /* Adds a key to the input buffer.
@@ -21,6 +26,7 @@ input_putc (uint8_t key) {
 
 	intq_putc (&buffer, key);
 	serial_notify ();
+	poll_queue_wake (&input_pollers);
 }
 
 /* Retrieves a key from the input buffer.
@@ -46,3 +52,18 @@ input_full (void) {
 	ASSERT (intr_get_level () == INTR_OFF);
 	return intq_full (&buffer);
 }
+
+/* Returns true if a key can be read without waiting. */
+bool
+input_ready (void) {
+	enum intr_level old_level = intr_disable ();
+	bool ready = !intq_empty (&buffer);
+	intr_set_level (old_level);
+	return ready;
+}
+
+/* Returns the queue woken whenever a key is added. */
+struct poll_queue *
+input_poll_queue (void) {
+	return &input_pollers;
+}
@@ -0,0 +1,193 @@
+#include "devices/lapic.h"
+#include <debug.h>
+#include "devices/timer.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/pte.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* See [IA32-v3a] chapter 10 "Advanced Programmable Interrupt
+   Controller (APIC)" for hardware details. */
+
+/* 레지스터 오프셋(바이트). */
+#define LAPIC_ID 0x020        /* Local APIC ID. */
+#define LAPIC_TPR 0x080       /* Task priority. */
+#define LAPIC_EOI 0x0b0       /* End of interrupt. */
+#define LAPIC_SVR 0x0f0       /* Spurious interrupt vector. */
+#define LAPIC_ESR 0x280       /* Error status. */
+#define LAPIC_ICR_LO 0x300    /* Interrupt command, low half. */
+#define LAPIC_ICR_HI 0x310    /* Interrupt command, high half. */
+#define LAPIC_LVT_TIMER 0x320 /* LVT timer. */
+#define LAPIC_LVT_LINT0 0x350 /* LVT LINT0. */
+#define LAPIC_LVT_LINT1 0x360 /* LVT LINT1. */
+#define LAPIC_LVT_ERR 0x370   /* LVT error. */
+#define LAPIC_TICR 0x380      /* Timer initial count. */
+#define LAPIC_TCCR 0x390      /* Timer current count. */
+#define LAPIC_TDCR 0x3e0      /* Timer divide configuration. */
+
+/* 레지스터 값. */
+#define LAPIC_ENABLE 0x100    /* SVR: APIC software enable. */
+#define LAPIC_MASKED 0x10000  /* LVT: masked. */
+#define LAPIC_PERIODIC 0x20000 /* LVT timer: periodic mode. */
+#define LAPIC_NMI 0x400       /* LVT/ICR: NMI delivery. */
+#define LAPIC_EXTINT 0x700    /* LVT: ExtINT delivery (8259 PIC). */
+#define LAPIC_INIT 0x500      /* ICR: INIT delivery. */
+#define LAPIC_STARTUP 0x600   /* ICR: STARTUP delivery. */
+#define LAPIC_DELIVS 0x1000   /* ICR: send pending. */
+#define LAPIC_ASSERT 0x4000   /* ICR: level assert. */
+#define LAPIC_LEVEL 0x8000    /* ICR: level triggered. */
+#define LAPIC_DIV_16 0x3      /* TDCR: divide by 16. */
+
+/* lapic_calibrate()에서 타이머를 잴 틱 수 */
+#define LAPIC_CALIBRATE_TICKS 4
+
+/* 레지스터가 매핑된 커널 가상 주소. 모든 CPU가 같은 주소로 자기
+   local APIC을 봅니다. */
+static volatile uint32_t *lapic;
+
+/* 틱 하나 동안 타이머가 세는 수. lapic_calibrate()가 잽니다. */
+static uint32_t lapic_timer_count;
+
+static intr_handler_func lapic_timer_interrupt;
+
+static uint32_t
+lapic_read (int reg) {
+	return lapic[reg / 4];
+}
+
+/* REG에 V를 씁니다. 쓰기가 끝나도록 ID 레지스터를 한 번 읽습니다. */
+static void
+lapic_write (int reg, uint32_t v) {
+	lapic[reg / 4] = v;
+	(void) lapic[LAPIC_ID / 4];
+}
+
+/* APIC ID가 APIC_ID인 CPU로 LO 명령을 보내고 전달될 때까지 기다립니다. */
+static void
+lapic_icr (uint8_t apic_id, uint32_t lo) {
+	enum intr_level old_level = intr_disable ();
+
+	lapic_write (LAPIC_ICR_HI, (uint32_t) apic_id << 24);
+	lapic_write (LAPIC_ICR_LO, lo);
+	while (lapic_read (LAPIC_ICR_LO) & LAPIC_DELIVS)
+		asm volatile ("pause");
+	intr_set_level (old_level);
+}
+
+/* 물리 주소 PADDR의 local APIC 레지스터를 캐시하지 않는 페이지로 커널
+   페이지 테이블에 매핑하고 타이머 인터럽트를 등록합니다. BSP가 AP를
+   깨우기 전에 한 번 부릅니다. */
+void
+lapic_map (uint64_t paddr) {
+	uint64_t va = (uint64_t) ptov (paddr);
+	uint64_t *pte = pml4e_walk (base_pml4, va, 1);
+
+	ASSERT (pg_ofs ((void *) va) == 0);
+	if (pte == NULL)
+		PANIC ("lapic_map: out of memory");
+	*pte = paddr | PTE_P | PTE_W | PTE_PWT | PTE_PCD;
+	invlpg (va);
+	lapic = (volatile uint32_t *) va;
+
+	intr_register_ext (LAPIC_TIMER_VEC, lapic_timer_interrupt, "LAPIC Timer");
+}
+
+/* 이 CPU의 local APIC을 켭니다. BSP는 LINT0으로 8259 PIC의 인터럽트를
+   그대로 받고 타이머는 PIT를 씁니다. AP는 PIC 인터럽트를 받지 않고
+   local APIC 타이머로 TIMER_FREQ마다 틱을 받습니다. */
+void
+lapic_init (bool bsp) {
+	ASSERT (lapic != NULL);
+
+	lapic_write (LAPIC_SVR, LAPIC_ENABLE | LAPIC_SPURIOUS_VEC);
+	lapic_write (LAPIC_TPR, 0);
+	lapic_write (LAPIC_LVT_ERR, LAPIC_MASKED);
+	if (bsp) {
+		lapic_write (LAPIC_LVT_LINT0, LAPIC_EXTINT);
+		lapic_write (LAPIC_LVT_LINT1, LAPIC_NMI);
+		lapic_write (LAPIC_LVT_TIMER, LAPIC_MASKED);
+	} else {
+		ASSERT (lapic_timer_count != 0);
+		lapic_write (LAPIC_LVT_LINT0, LAPIC_MASKED);
+		lapic_write (LAPIC_LVT_LINT1, LAPIC_MASKED);
+		lapic_write (LAPIC_TDCR, LAPIC_DIV_16);
+		lapic_write (LAPIC_LVT_TIMER, LAPIC_PERIODIC | LAPIC_TIMER_VEC);
+		lapic_write (LAPIC_TICR, lapic_timer_count);
+	}
+
+	/* 쌓여 있던 오류와 인터럽트를 비웁니다 */
+	lapic_write (LAPIC_ESR, 0);
+	lapic_write (LAPIC_ESR, 0);
+	lapic_eoi ();
+}
+
+/* PIT 틱 몇 개 동안 local APIC 타이머가 세는 수로 lapic_timer_count를
+   잽니다. CPU마다 버스 클럭이 같으므로 BSP에서 한 번만 재면 됩니다. */
+void
+lapic_calibrate (void) {
+	int64_t start;
+
+	ASSERT (intr_get_level () == INTR_ON);
+
+	lapic_write (LAPIC_TDCR, LAPIC_DIV_16);
+	lapic_write (LAPIC_LVT_TIMER, LAPIC_MASKED);
+
+	/* 틱 경계에서 재기 시작합니다 */
+	start = timer_ticks ();
+	while (timer_ticks () == start)
+		barrier ();
+	lapic_write (LAPIC_TICR, 0xffffffff);
+	start = timer_ticks ();
+	while (timer_ticks () - start < LAPIC_CALIBRATE_TICKS)
+		barrier ();
+	lapic_timer_count = (0xffffffff - lapic_read (LAPIC_TCCR))
+		/ LAPIC_CALIBRATE_TICKS;
+	lapic_write (LAPIC_TICR, 0);
+}
+
+/* 이 CPU의 local APIC ID를 반환합니다. */
+uint8_t
+lapic_id (void) {
+	return lapic_read (LAPIC_ID) >> 24;
+}
+
+/* 처리한 인터럽트를 local APIC에 알립니다. */
+void
+lapic_eoi (void) {
+	lapic_write (LAPIC_EOI, 0);
+}
+
+/* APIC ID가 APIC_ID인 CPU에 VEC 인터럽트를 보냅니다. */
+void
+lapic_send_ipi (uint8_t apic_id, uint8_t vec) {
+	lapic_icr (apic_id, vec);
+}
+
+/* APIC ID가 APIC_ID인 AP를 INIT-SIPI-SIPI로 깨워 물리 주소 PADDR부터
+   리얼 모드로 돌게 합니다. PADDR는 1MB 아래의 페이지 경계여야 합니다.
+   See [MP] appendix B.4 "Application Processor Startup". */
+void
+lapic_start_ap (uint8_t apic_id, uint64_t paddr) {
+	int i;
+
+	ASSERT (paddr < 0x100000 && pg_ofs ((void *) paddr) == 0);
+
+	lapic_icr (apic_id, LAPIC_INIT | LAPIC_LEVEL | LAPIC_ASSERT);
+	timer_msleep (10);
+	lapic_icr (apic_id, LAPIC_INIT | LAPIC_LEVEL);
+
+	for (i = 0; i < 2; i++) {
+		lapic_icr (apic_id, LAPIC_STARTUP | (paddr >> 12));
+		timer_usleep (200);
+	}
+}
+
+/* AP의 타이머 인터럽트. BSP의 틱은 devices/timer.c가 셉니다. */
+static void
+lapic_timer_interrupt (struct intr_frame *f) {
+	thread_tick ((f->cs & 3) == 3);
+}
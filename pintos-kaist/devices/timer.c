@@ -5,8 +5,13 @@
 #include <stdio.h>
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "intrinsic.h"
+#include "threads/cpu.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#ifdef USERPROG
+#include "userprog/vdso.h"
+#endif
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -20,6 +25,11 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* 마지막 틱 경계의 TSC 값과 틱 한 번 동안 흐르는 TSC 수(timer_calibrate()가
+   잽니다). timer_nanoseconds()가 틱 사이를 나누는 데 씁니다. */
+static uint64_t tick_tsc;
+static uint64_t tsc_per_tick;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
@@ -28,18 +38,57 @@ static intr_handler_func timer_interrupt;
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
-static void wake_up(int64_t cur_tick);
-static bool compare_tick(const struct list_elem *a, const struct list_elem *b, void *aux);
-
-typedef struct block_threads_struct
-{
-	struct thread *block_threads;
-	int64_t wakeup_tick;
-	struct list_elem elem;
-} block_thread;
 
-struct list block_thread_list;
-int64_t closet_tick = NULL; // 다음에 깨워야할 틱
+typedef struct block_threads_struct block_thread;
+
+/* 잠든 스레드와 알람을 담는 계층형 타이머 휠입니다. 레벨 L의 슬롯 하나는
+   64^L 틱을 맡고, 깨울 틱까지 남은 거리로 레벨을, 깨울 틱의 해당 자리
+   비트로 슬롯을 고릅니다. 넣기와 꺼내기가 모두 O(1)이고 항목은 호출자가
+   가진 block_thread를 그대로 씁니다. */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_SHIFT(LEVEL) (WHEEL_BITS * (LEVEL))
+#define WHEEL_SPAN ((int64_t)1 << WHEEL_SHIFT(WHEEL_LEVELS))
+
+static struct list wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+
+static void wheel_add(block_thread *);
+static void wheel_advance(void);
+
+/* PIT 모드 전환. 평소에는 mode 2로 TIMER_FREQ마다 틱을 내고, tickless
+   idle이나 틱 사이에 만료되는 hrtimer가 있으면 mode 0(one-shot)으로
+   바꿔 필요한 때에만 인터럽트를 받습니다. PIT 카운터는 16비트라 한 번에
+   ONESHOT_MAX_COUNT까지만 잴 수 있습니다. */
+#define PIT_HZ 1193180
+#define PIT_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+#define ONESHOT_MAX_COUNT 0xffff
+
+static bool oneshot_armed;		  /* PIT가 one-shot으로 설정돼 있음 */
+static uint16_t oneshot_count;	  /* one-shot으로 건 카운트 */
+static uint16_t oneshot_first;	  /* 걸 때부터 첫 틱 경계까지의 카운트 */
+static int64_t oneshot_carry;	  /* 다시 걸기 전에 지나갔지만 아직 못 센 틱 수 */
+
+static void pit_periodic(void);
+static void pit_oneshot(uint16_t count);
+static uint16_t pit_read(void);
+static uint16_t pit_to_boundary(void);
+static void pit_arm(uint16_t first, uint16_t count);
+
+/* 만료 시각 순으로 정렬된 hrtimer 목록. 보통 몇 개 되지 않습니다. */
+static struct list hrtimer_list;
+
+/* 틱 사이를 나누는 hrtimer를 막 재우는 데 쓸 수 있는 가장 짧은 시간.
+   이보다 짧으면 문맥 전환과 PIT 설정 비용이 더 크므로 돌며 기다립니다. */
+#define HRTIMER_MIN_SLEEP_NS 20000
+
+/* timer_calibrate()에서 TSC를 잴 틱 수 */
+#define TSC_CALIBRATE_TICKS 8
+
+static uint16_t hrtimer_counts(uint16_t limit);
+static void hrtimer_expire(void);
+static void hrtimer_sleep(int64_t ns);
 
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
    interrupt PIT_FREQ times per second, and registers the
@@ -48,12 +97,13 @@ void timer_init(void)
 {
 	/* 8254 input frequency divided by TIMER_FREQ, rounded to
 	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
+	int level, slot;
 
-	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
-	list_init(&block_thread_list); // 블락 스레드 리스트 초기화
+	pit_periodic();
+	for (level = 0; level < WHEEL_LEVELS; level++)
+		for (slot = 0; slot < WHEEL_SLOTS; slot++)
+			list_init(&wheel[level][slot]);
+	list_init(&hrtimer_list);
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 }
@@ -81,6 +131,16 @@ void timer_calibrate(void)
 		if (!too_many_loops(high_bit | test_bit))
 			loops_per_tick |= test_bit;
 
+	/* 틱 경계에서 경계까지 흐른 TSC로 틱 하나의 TSC 수를 잽니다 */
+	int64_t start = ticks;
+	while (ticks == start)
+		barrier();
+	uint64_t tsc = rdtsc();
+	start = ticks;
+	while (ticks - start < TSC_CALIBRATE_TICKS)
+		barrier();
+	tsc_per_tick = (rdtsc() - tsc) / TSC_CALIBRATE_TICKS;
+
 	printf("%'" PRIu64 " loops/s.\n", (uint64_t)loops_per_tick * TIMER_FREQ);
 }
 
@@ -103,36 +163,270 @@ timer_elapsed(int64_t then)
 	return timer_ticks() - then;
 }
 
+/* 부팅 후 흐른 시간을 나노초로 반환합니다. 틱 사이는 TSC로 나눠서
+   틱보다 잘게 잽니다. 반환값은 줄어들지 않습니다. */
+int64_t
+timer_nanoseconds(void)
+{
+	enum intr_level old_level = intr_disable();
+	int64_t t = ticks;
+	uint64_t base = tick_tsc, per = tsc_per_tick;
+	uint64_t now = rdtsc();
+	intr_set_level(old_level);
+
+	int64_t ns = t * NS_PER_TICK;
+	if (per != 0 && now > base)
+	{
+		uint64_t sub = (now - base) * NS_PER_TICK / per;
+		/* 틱이 늦게 들어와도 다음 틱의 시각을 넘지 않게 합니다 */
+		ns += sub < NS_PER_TICK ? sub : NS_PER_TICK - 1;
+	}
+	return ns;
+}
+
 /* Suspends execution for approximately TICKS timer ticks. */
 void timer_sleep(int64_t ticks)
 {
+	/* 깨어날 때까지 이 함수를 벗어나지 않으므로 항목은 스택에 둡니다 */
+	block_thread target;
 
 	ASSERT(intr_get_level() == INTR_ON);
 
-	struct thread *cur = thread_current(); // 현재 쓰레드 가져오기
-	block_thread *target = malloc(sizeof(block_thread));
+	if (ticks <= 0)
+		return;
 
-	target->block_threads = cur;				 // 블락되는 쓰레드
-	target->wakeup_tick = timer_ticks() + ticks; // 깨울 틱 저장
-	dprintf("깨울 틱 : %d\n", target->wakeup_tick);
+	target.block_threads = thread_current(); // 블락되는 쓰레드
+	target.sema = NULL;
 
 	enum intr_level old_level = intr_disable(); // 인터럽트 끄기 -> 레이스 컨디션을 막기 위해 먼저
-	if (closet_tick == NULL || closet_tick > target->wakeup_tick)
+	target.wakeup_tick = timer_ticks() + ticks;	// 깨울 틱 저장
+	wheel_add(&target);
+	thread_block();			   // 쓰레드 블락
+	intr_set_level(old_level); // 원래 상태 복원
+}
+
+/* WAKEUP_TICK이 되면 SEMA를 up하도록 ALARM을 대기 목록에 겁니다.
+ * poll()처럼 다른 이벤트와 시간 초과를 한 세마포어로 기다릴 때 씁니다.
+ * 울리기 전에 필요 없어지면 timer_alarm_cancel()로 떼어야 합니다. */
+void timer_alarm_set(block_thread *alarm, int64_t wakeup_tick, struct semaphore *sema)
+{
+	ASSERT(sema != NULL);
+
+	alarm->block_threads = NULL;
+	alarm->sema = sema;
+
+	enum intr_level old_level = intr_disable();
+	/* 이미 지난 시각이면 다음 틱에 울립니다 */
+	alarm->wakeup_tick = wakeup_tick > ticks ? wakeup_tick : ticks + 1;
+	wheel_add(alarm);
+	intr_set_level(old_level);
+}
+
+/* 아직 울리지 않았다면 ALARM을 대기 목록에서 뗍니다. */
+void timer_alarm_cancel(block_thread *alarm)
+{
+	enum intr_level old_level = intr_disable();
+	if (alarm->sema != NULL)
 	{
-		closet_tick = target->wakeup_tick;
+		list_remove(&alarm->elem);
+		alarm->sema = NULL;
 	}
+	intr_set_level(old_level);
+}
 
-	list_insert_ordered(&block_thread_list, &target->elem, compare_tick, NULL);
-	thread_block();			   // 쓰레드 블락
-	intr_set_level(old_level); // 원래 상태 복원
+/* ALARM을 휠에 넣습니다. 인터럽트가 꺼진 상태에서 불러야 하며,
+   wakeup_tick은 현재 틱보다 작으면 안 됩니다. 현재 틱과 같은 항목은
+   wheel_advance()가 자리를 옮길 때만 들어오고, 바로 이어서 울립니다. */
+static void
+wheel_add(block_thread *alarm)
+{
+	int64_t expires = alarm->wakeup_tick;
+	int64_t delta = expires - ticks;
+	int level;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(delta >= 0);
+
+	for (level = 0; level < WHEEL_LEVELS - 1; level++)
+		if (delta < (int64_t)1 << WHEEL_SHIFT(level + 1))
+			break;
+
+	/* 휠 전체보다 먼 항목은 마지막 레벨 끝에 두었다가 그 슬롯이 돌아올
+	   때 다시 넣습니다 */
+	if (delta >= WHEEL_SPAN)
+		expires = ticks + WHEEL_SPAN - 1;
+
+	list_push_back(&wheel[level][(expires >> WHEEL_SHIFT(level)) & WHEEL_MASK],
+				   &alarm->elem);
 }
 
-static bool compare_tick(const struct list_elem *a, const struct list_elem *b, void *aux)
+/* 틱이 하나 늘어난 뒤 타이머 인터럽트에서 부릅니다. 한 바퀴를 다 돈 위
+   레벨 슬롯의 항목을 아래 레벨로 내려보내고, 레벨 0의 현재 슬롯에 있는
+   항목을 모두 깨웁니다. */
+static void
+wheel_advance(void)
 {
-	block_thread *t1 = list_entry(a, block_thread, elem);
-	block_thread *t2 = list_entry(b, block_thread, elem);
+	struct list *slot;
+	int level;
+
+	for (level = WHEEL_LEVELS - 1; level > 0; level--)
+	{
+		if ((ticks & (((int64_t)1 << WHEEL_SHIFT(level)) - 1)) != 0)
+			continue;
+
+		slot = &wheel[level][(ticks >> WHEEL_SHIFT(level)) & WHEEL_MASK];
+		while (!list_empty(slot))
+			wheel_add(list_entry(list_pop_front(slot), block_thread, elem));
+	}
+
+	slot = &wheel[0][ticks & WHEEL_MASK];
+	while (!list_empty(slot))
+	{
+		block_thread *entry = list_entry(list_pop_front(slot), block_thread, elem);
+
+		if (entry->sema != NULL)
+		{
+			struct semaphore *sema = entry->sema;
 
-	return t1->wakeup_tick < t2->wakeup_tick;
+			entry->sema = NULL;
+			sema_up(sema);
+		}
+		else
+			thread_unblock(entry->block_threads);
+	}
+}
+
+/* 다음에 깨울 항목까지 남은 틱 수를 LIMIT까지만 셉니다. 64틱 경계에서는
+   위 레벨 항목이 내려올 수 있으므로 거기서 멈춥니다. */
+static int64_t
+wheel_next_event(int64_t limit)
+{
+	int64_t d;
+
+	for (d = 1; d < limit; d++)
+	{
+		int64_t t = ticks + d;
+
+		if ((t & WHEEL_MASK) == 0 || !list_empty(&wheel[0][t & WHEEL_MASK]))
+			break;
+	}
+	return d;
+}
+
+/* idle 스레드가 hlt 직전에 인터럽트를 끈 채로 부릅니다. 다음 깨울
+   틱까지 두 틱 이상 남았으면 PIT를 one-shot으로 바꿔 그 사이의 틱
+   인터럽트를 건너뜁니다. mlfqs는 틱마다 load_avg와 recent_cpu를 재야
+   하므로 건너뛰지 않습니다. CPU가 여럿이면 BSP가 자는 동안 다른 CPU가
+   ticks를 읽고 휠에 항목을 넣으므로 역시 건너뛰지 않습니다. */
+void
+timer_idle_enter(void)
+{
+	uint16_t first;
+	int64_t n;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (thread_mlfqs || oneshot_armed || cpu_cnt > 1)
+		return;
+
+	/* 틱 경계를 지키도록 지금 주기에 남은 카운트부터 잽니다 */
+	first = pit_to_boundary();
+	if (first == 0)
+		return;
+
+	n = wheel_next_event(1 + (ONESHOT_MAX_COUNT - first) / PIT_COUNT);
+	if (n < 2)
+		return;
+
+	pit_arm(first, hrtimer_counts(first + (n - 1) * PIT_COUNT));
+}
+
+/* hlt에서 깨어난 idle 스레드가 부릅니다. 타이머가 아닌 인터럽트로 일찍
+   깼다면 지나간 틱을 모아 두고, 다음 틱 경계(그보다 이른 hrtimer가
+   있으면 그 시각)에 인터럽트가 들어오도록 PIT를 다시 겁니다. 모아 둔
+   틱은 그 인터럽트가 셉니다. */
+void
+timer_idle_exit(void)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (oneshot_armed)
+	{
+		uint16_t first = pit_to_boundary();
+
+		if (first != 0)
+			pit_arm(first, hrtimer_counts(first));
+	}
+	intr_set_level(old_level);
+}
+
+/* 지금부터 다음 틱 경계까지 남은 PIT 카운트를 반환합니다. one-shot이
+   걸려 있었다면 그동안 지나간 틱을 oneshot_carry에 모으므로 호출자는
+   곧바로 pit_arm()으로 다시 걸어야 합니다. 인터럽트가 이미 들어올
+   참이라 다시 걸 수 없으면 0을 반환합니다. */
+static uint16_t
+pit_to_boundary(void)
+{
+	uint16_t left = pit_read();
+	uint16_t elapsed;
+
+	if (!oneshot_armed)
+		return left <= PIT_COUNT ? left : 0;
+
+	/* 0이 됐거나 넘어가 버렸다면 인터럽트가 곧 들어옵니다 */
+	if (left == 0 || left > oneshot_count)
+		return 0;
+
+	elapsed = oneshot_count - left;
+	if (elapsed < oneshot_first)
+		return oneshot_first - elapsed;
+
+	oneshot_carry += 1 + (elapsed - oneshot_first) / PIT_COUNT;
+	return PIT_COUNT - (elapsed - oneshot_first) % PIT_COUNT;
+}
+
+/* 지금부터 COUNT만큼 지나면 인터럽트가 한 번 들어오게 합니다. FIRST는
+   지금부터 다음 틱 경계까지의 카운트로, 인터럽트에서 지나간 틱을 셀 때
+   씁니다. */
+static void
+pit_arm(uint16_t first, uint16_t count)
+{
+	ASSERT(first >= 1 && first <= PIT_COUNT);
+
+	oneshot_first = first;
+	oneshot_count = count > 0 ? count : 1;
+	oneshot_armed = true;
+	pit_oneshot(oneshot_count);
+}
+
+/* PIT를 TIMER_FREQ 주기로 되돌립니다. */
+static void
+pit_periodic(void)
+{
+	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb(0x40, PIT_COUNT & 0xff);
+	outb(0x40, PIT_COUNT >> 8);
+}
+
+/* COUNT가 지나면 한 번만 인터럽트가 들어오게 합니다. */
+static void
+pit_oneshot(uint16_t count)
+{
+	outb(0x43, 0x30); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+}
+
+/* 카운터 0의 남은 카운트를 읽습니다. */
+static uint16_t
+pit_read(void)
+{
+	uint8_t lo, hi;
+
+	outb(0x43, 0x00); /* CW: counter 0, latch. */
+	lo = inb(0x40);
+	hi = inb(0x40);
+	return lo | (hi << 8);
 }
 
 /* Suspends execution for approximately MS milliseconds. */
@@ -161,47 +455,178 @@ void timer_print_stats(void)
 
 // 여기서 틱을 보고 같으면 쓰레드 꺠우기
 static void
-timer_interrupt(struct intr_frame *args UNUSED)
-{
-	ticks++;
-	thread_tick();
-	int64_t cur_tick = timer_ticks();
-	// printf("현재 틱 : %d\n", cur_tick);
-	// dprintf("실행 쓰레드 %s, 우선순위 : %d\n", thread_name(), thread_get_priority());
-	if (closet_tick != NULL && cur_tick >= closet_tick) // 현재 틱이 블락된 쓰레드 로컬 틱이랑 같거나 크면
+timer_interrupt(struct intr_frame *args)
+{
+	uint64_t now = rdtsc();
+	bool was_oneshot = oneshot_armed;
+	uint16_t into = 0; /* 마지막 틱 경계를 지나 흐른 카운트 */
+	int64_t n = 1;
+
+	/* one-shot이었다면 그동안 지난 틱을 한꺼번에 셉니다. 마지막 틱을 뺀
+	   나머지는 tickless idle로 건너뛴, idle 스레드가 돈 틱입니다. 틱
+	   경계 전에 hrtimer 때문에 들어온 인터럽트라면 셀 틱이 없습니다. */
+	if (was_oneshot)
+	{
+		oneshot_armed = false;
+		n = oneshot_carry;
+		oneshot_carry = 0;
+		if (oneshot_count >= oneshot_first)
+		{
+			n += 1 + (oneshot_count - oneshot_first) / PIT_COUNT;
+			into = (oneshot_count - oneshot_first) % PIT_COUNT;
+		}
+		else
+			into = PIT_COUNT - (oneshot_first - oneshot_count);
+	}
+
+	if (n > 0)
+	{
+		tick_tsc = now - (uint64_t)into * tsc_per_tick / PIT_COUNT;
+		while (n-- > 0)
+		{
+			ticks++;
+			if (n > 0)
+				thread_idle_tick();
+			else
+				thread_tick((args->cs & 3) == 3);
+			wheel_advance();
+		}
+#ifdef USERPROG
+		vdso_tick(ticks);
+#endif
+	}
+
+	hrtimer_expire();
+
+	/* 다음 틱 경계 전에 만료되는 hrtimer가 있거나 틱 경계에서 벗어나
+	   있으면 one-shot을 다시 걸고, 아니면 주기 모드로 돌아갑니다 */
+	uint16_t left = PIT_COUNT - into;
+	uint16_t count = hrtimer_counts(left);
+	if (count < left || into != 0)
+		pit_arm(left, count);
+	else if (was_oneshot)
+		pit_periodic();
+}
+
+/* 만료 시각이 지난 hrtimer를 목록에서 떼고 콜백을 부릅니다. */
+static void
+hrtimer_expire(void)
+{
+	int64_t now = timer_nanoseconds();
+
+	while (!list_empty(&hrtimer_list))
 	{
-		// printf("wakeup\n");
-		wake_up(cur_tick);
+		struct hrtimer *timer = list_entry(list_front(&hrtimer_list),
+										   struct hrtimer, elem);
+
+		if (timer->expires > now)
+			break;
+		list_pop_front(&hrtimer_list);
+		timer->pending = false;
+		timer->func(timer);
 	}
 }
 
-static void wake_up(int64_t cur_tick)
+/* 가장 먼저 만료되는 hrtimer까지 남은 PIT 카운트를 LIMIT까지만 셉니다. */
+static uint16_t
+hrtimer_counts(uint16_t limit)
+{
+	struct hrtimer *timer;
+	int64_t ns;
+
+	if (list_empty(&hrtimer_list))
+		return limit;
+
+	timer = list_entry(list_front(&hrtimer_list), struct hrtimer, elem);
+	ns = timer->expires - timer_nanoseconds();
+	if (ns <= 0)
+		return 1;
+	if (ns >= (int64_t)limit * 1000000000 / PIT_HZ)
+		return limit;
+	return DIV_ROUND_UP(ns * PIT_HZ, 1000000000);
+}
+
+/* TIMER를 FUNC가 AUX와 함께 불리도록 초기화합니다. */
+void
+hrtimer_init(struct hrtimer *timer, hrtimer_func *func, void *aux)
+{
+	ASSERT(func != NULL);
+
+	timer->func = func;
+	timer->aux = aux;
+	timer->pending = false;
+}
+
+/* timer_nanoseconds()가 EXPIRES가 되면 TIMER의 콜백을 부릅니다. 이미
+   걸려 있으면 시각만 바꿉니다. 콜백은 타이머 인터럽트 안에서 불리므로
+   잠들면 안 됩니다. */
+void
+hrtimer_start(struct hrtimer *timer, int64_t expires)
 {
 	struct list_elem *e;
-	for (e = list_begin(&block_thread_list); e != list_end(&block_thread_list);)
+	enum intr_level old_level = intr_disable();
+
+	if (timer->pending)
+		list_remove(&timer->elem);
+	timer->expires = expires;
+	timer->pending = true;
+
+	for (e = list_begin(&hrtimer_list); e != list_end(&hrtimer_list);
+		 e = list_next(e))
+		if (list_entry(e, struct hrtimer, elem)->expires > expires)
+			break;
+	list_insert(e, &timer->elem);
+
+	/* 새 타이머가 맨 앞이고 다음 틱 경계보다 먼저 만료되면 PIT를 그
+	   시각에 맞춰 다시 겁니다 */
+	if (list_front(&hrtimer_list) == &timer->elem)
 	{
-		block_thread *entry = list_entry(e, block_thread, elem);
-		struct list_elem *next = list_next(e);
-		if (entry->wakeup_tick <= cur_tick)
+		uint16_t first = pit_to_boundary();
+
+		if (first != 0)
 		{
-			dprintf("wakeup\n");
-			list_remove(e);
-			thread_unblock(entry->block_threads);
-		}
-		else
-			break;
+			uint16_t count = hrtimer_counts(first);
 
-		e = next;
+			if (oneshot_armed || count < first)
+				pit_arm(first, count);
+		}
 	}
+	intr_set_level(old_level);
+}
+
+/* 아직 만료되지 않았다면 TIMER를 뗍니다. 뗐으면 true를 반환합니다. */
+bool
+hrtimer_cancel(struct hrtimer *timer)
+{
+	enum intr_level old_level = intr_disable();
+	bool pending = timer->pending;
 
-	if (list_empty(&block_thread_list)) // 리스트가 비어있을 경우
-		closet_tick = NULL;				// 깨워야할 틱이 없으니까 -1로
-	else								// 있을 경우
+	if (pending)
 	{
-		e = list_front(&block_thread_list); // 맨 앞의 엔트리를 가져와서 전역 틱에 저장
-		block_thread *entry = list_entry(e, block_thread, elem);
-		closet_tick = entry->wakeup_tick;
+		list_remove(&timer->elem);
+		timer->pending = false;
 	}
+	intr_set_level(old_level);
+	return pending;
+}
+
+static void
+hrtimer_wake(struct hrtimer *timer)
+{
+	sema_up(timer->aux);
+}
+
+/* NS 나노초 동안 hrtimer를 걸고 잠듭니다. */
+static void
+hrtimer_sleep(int64_t ns)
+{
+	struct semaphore sema;
+	struct hrtimer timer;
+
+	sema_init(&sema, 0);
+	hrtimer_init(&timer, hrtimer_wake, &sema);
+	hrtimer_start(&timer, timer_nanoseconds() + ns);
+	sema_down(&sema);
 }
 
 /* mlfqs에서 틱마다 발생하는 상황에 대응하기 위한 함수입니다 */
@@ -209,18 +634,22 @@ void mlfqs_on_tick()
 {
 	update_recent_cpu();
 
-	if (timer_ticks() % TIMER_FREQ == 0)
+	/* 1초마다 모든 스레드의 recent_cpu와 우선순위를 계산하고, 그 사이
+	   4틱마다는 recent_cpu가 바뀐 스레드의 우선순위만 계산합니다.
+	   전역 값이므로 PIT 틱을 받는 BSP에서만 합니다 */
+	if (this_cpu() == &cpus[0])
 	{
-		update_load_avg();
-		update_recent_cpu_all();
-	} // 모든 스레드 recent_cpu 계산
+		if (timer_ticks() % TIMER_FREQ == 0)
+		{
+			update_load_avg();
+			update_recent_cpu_all();
+		}
+		else if (timer_ticks() % 4 == 0)
+			update_changed_priority();
+	}
 
-	if (timer_ticks() % 4 == 0)
-	{
-		// update_priority(thread_current());
-		update_all_priority();
+	if (this_cpu()->ticks % 4 == 0)
 		compare_cur_next_priority();
-	}
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -276,6 +705,12 @@ real_time_sleep(int64_t num, int32_t denom)
 		   processes. */
 		timer_sleep(ticks);
 	}
+	else if (tsc_per_tick != 0 &&
+			 num * 1000000000 / denom >= HRTIMER_MIN_SLEEP_NS)
+	{
+		/* 한 틱보다 짧아도 충분히 길면 hrtimer로 잠듭니다 */
+		hrtimer_sleep(num * 1000000000 / denom);
+	}
 	else
 	{
 		/* Otherwise, use a busy-wait loop for more accurate
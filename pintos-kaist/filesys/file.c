@@ -7,19 +7,26 @@
  * and returns the new file.  Returns a null pointer if an
  * allocation fails or if INODE is null. */
 
-void increase_dup_count(struct file *file)
+/* FILE의 참조를 하나 늘립니다. 참조가 이미 0이 되어 닫히는 중이면
+ * 늘리지 않고 false를 반환합니다. */
+bool file_ref_tryget(struct file *file)
 {
-	file->dup_count++;
-}
+	int cnt = __atomic_load_n(&file->ref_cnt, __ATOMIC_RELAXED);
 
-void decrease_dup_count(struct file *file)
-{
-	file->dup_count--;
+	do
+	{
+		if (cnt == 0)
+			return false;
+	} while (!__atomic_compare_exchange_n(&file->ref_cnt, &cnt, cnt + 1, true,
+										  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+	return true;
 }
 
-int check_dup_count(struct file *file)
+/* FILE의 참조를 하나 줄이고, 마지막 참조였으면 true를 반환합니다. */
+bool file_ref_drop(struct file *file)
 {
-	return file->dup_count;
+	ASSERT(file->ref_cnt > 0);
+	return __atomic_sub_fetch(&file->ref_cnt, 1, __ATOMIC_ACQ_REL) == 0;
 }
 
 
@@ -49,8 +56,7 @@ file_open(struct inode *inode)
 	{
 		file->inode = inode;
 		file->pos = 0;
-		/* extra 2 */
-		file->dup_count = 1;
+		file->ref_cnt = 1;
 		file->deny_write = false;
 		return file;
 	}
@@ -90,12 +96,19 @@ void file_close(struct file *file)
 {
 	if (file != NULL)
 	{
-		file_allow_write(file);
-		inode_close(file->inode);
+		file_release(file);
 		free(file);
 	}
 }
 
+/* FILE을 닫되 구조체는 해제하지 않습니다. 락 없이 FILE을 읽는 쪽이
+ * 남아 있을 수 있는 fd 테이블이 유예 기간 뒤에 따로 해제합니다. */
+void file_release(struct file *file)
+{
+	file_allow_write(file);
+	inode_close(file->inode);
+}
+
 /* Returns the inode encapsulated by FILE. */
 struct inode *
 file_get_inode(struct file *file)
@@ -52,6 +52,14 @@ byte_to_sector (const struct inode *inode, off_t pos) {
 		return -1;
 }
 
+/* Returns the disk sector that contains byte offset POS within
+ * INODE, or -1 if INODE has no data at POS.  Used by callers that
+ * keep their own block map of a file (e.g. a swap file). */
+disk_sector_t
+inode_byte_to_sector (const struct inode *inode, off_t pos) {
+	return byte_to_sector (inode, pos);
+}
+
 /* List of open inodes, so that opening a single inode twice
  * returns the same `struct inode'. */
 static struct list open_inodes;
@@ -4,9 +4,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+struct poll_queue;
+
 void input_init (void);
 void input_putc (uint8_t);
 uint8_t input_getc (void);
 bool input_full (void);
+bool input_ready (void);
+struct poll_queue *input_poll_queue (void);
 
 #endif /* devices/input.h */
@@ -0,0 +1,27 @@
+#ifndef DEVICES_LAPIC_H
+#define DEVICES_LAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* CPU마다 하나씩 있는 local APIC.
+ *
+ * AP를 깨우는 INIT/STARTUP IPI, CPU 사이의 IPI, 그리고 AP의 틱을 내는
+ * 타이머에 씁니다. 장치 인터럽트는 여전히 8259 PIC가 BSP의 LINT0으로
+ * 넘겨주므로(virtual wire 모드) I/O APIC은 건드리지 않습니다. */
+
+/* PIC 벡터(0x20...0x2f)와 겹치지 않는 외부 인터럽트 벡터. */
+#define LAPIC_TIMER_VEC 0xf0    /* AP의 타이머 틱. */
+#define IPI_RESCHEDULE_VEC 0xf1 /* 레디 큐에 스레드가 들어왔음. */
+#define IPI_TLB_VEC 0xf2        /* TLB를 비워 달라는 요청. */
+#define LAPIC_SPURIOUS_VEC 0xff /* 스퓨리어스 인터럽트. */
+
+void lapic_map (uint64_t paddr);
+void lapic_init (bool bsp);
+void lapic_calibrate (void);
+uint8_t lapic_id (void);
+void lapic_eoi (void);
+void lapic_send_ipi (uint8_t apic_id, uint8_t vec);
+void lapic_start_ap (uint8_t apic_id, uint64_t paddr);
+
+#endif /* devices/lapic.h */
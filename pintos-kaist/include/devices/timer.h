@@ -1,19 +1,61 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+struct thread;
+struct semaphore;
+
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* 틱 한 번의 길이(나노초). */
+#define NS_PER_TICK (1000000000 / TIMER_FREQ)
+
 void timer_init (void);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_nanoseconds (void);
+
+/* timer_sleep()의 대기 목록 항목. SEMA가 NULL이 아니면 시각이 됐을 때
+ * 스레드를 깨우는 대신 SEMA를 up합니다(timer_alarm_set). */
+struct block_threads_struct
+{
+	struct thread *block_threads;
+	struct semaphore *sema;
+	int64_t wakeup_tick;
+	struct list_elem elem;
+};
+
+/* 틱보다 잘게 만료되는 타이머. 만료 시각은 timer_nanoseconds() 기준이며
+ * 콜백은 타이머 인터럽트 안에서 불립니다. */
+struct hrtimer;
+typedef void hrtimer_func (struct hrtimer *);
+
+struct hrtimer
+{
+	int64_t expires;			/* 만료 시각(나노초) */
+	hrtimer_func *func;			/* 만료되면 부를 함수 */
+	void *aux;					/* FUNC가 쓸 값 */
+	bool pending;				/* 목록에 걸려 있음 */
+	struct list_elem elem;
+};
+
+void hrtimer_init (struct hrtimer *, hrtimer_func *, void *aux);
+void hrtimer_start (struct hrtimer *, int64_t expires);
+bool hrtimer_cancel (struct hrtimer *);
 
 void timer_sleep (int64_t ticks);
+void timer_alarm_set (struct block_threads_struct *, int64_t wakeup_tick,
+		struct semaphore *);
+void timer_alarm_cancel (struct block_threads_struct *);
+void timer_idle_enter (void);
+void timer_idle_exit (void);
 void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
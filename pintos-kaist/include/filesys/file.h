@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "filesys/off_t.h"
 #include "filesys/inode.h"
+#include "threads/rcu.h"
 
 struct inode;
 /* An open file. */
@@ -12,14 +13,18 @@ struct file
 	struct inode *inode; /* File's inode. */
 	off_t pos;			 /* Current position. */
 	bool deny_write;	 /* Has file_deny_write() been called? */
-	int dup_count;		 /* extra2 */
+	int ref_cnt;		 /* fd 자리와 쓰는 중인 syscall이 쥔 참조 수 */
 	int mapping_cnt;
+	struct pipe *pipe;	 /* 파이프의 끝이면 그 파이프, 아니면 NULL */
+	bool pipe_writer;	 /* 파이프의 쓰기 끝인가? */
+	struct rcu_head rcu; /* fd 테이블에서 닫힌 뒤 해제를 미룰 때 */
 };
 /* Opening and closing files. */
 struct file *file_open(struct inode *);
 struct file *file_reopen(struct file *);
 struct file *file_duplicate(struct file *file);
 void file_close(struct file *);
+void file_release(struct file *);
 struct inode *file_get_inode(struct file *);
 
 /* Reading and writing. */
@@ -37,10 +42,9 @@ void file_seek(struct file *, off_t);
 off_t file_tell(struct file *);
 off_t file_length(struct file *);
 
-/* extra2 */
-void increase_dup_count(struct file *);
-void decrease_dup_count(struct file *);
-int check_dup_count(struct file *);
+/* Reference counting. */
+bool file_ref_tryget(struct file *);
+bool file_ref_drop(struct file *);
 
 
 void increase_mapping_count(struct file *);
@@ -1,4 +1,5 @@
 #ifndef INSTRINSIC_H
+#define INSTRINSIC_H
 #include "threads/mmu.h"
 
 /* Store the physical address of the page directory into CR3
@@ -122,6 +123,14 @@ static __inline uint64_t rcr2(void) {
 	return val;
 }
 
+/* 타임스탬프 카운터(TSC)를 읽습니다. 부팅 후 지난 CPU 사이클 수입니다. */
+__attribute__((always_inline))
+static __inline uint64_t rdtsc(void) {
+	uint32_t lo, hi;
+	__asm __volatile("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
 /*MSR(Model-Specific Register)에 값 기록.
 인자로 받은 ecx(MSR 번호)와 val(64비트 값)을 wrmsr 명령어를 통해 해당 MSR에 기록함.
 eax에는 하위 32비트, dex에는 상위 32비트, ecx에는 MSR 번호를 각각 넣어 wrmsr을 실행.*/
@@ -0,0 +1,58 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* 힙(우선순위 큐).
+ *
+ * 페어링 힙으로 구현합니다. 넣기와 최댓값 보기는 O(1), 꺼내기와 임의의
+ * 요소 빼기는 분할 상환 O(log n)입니다.
+ *
+ * 리스트나 해시처럼 동적 할당을 쓰지 않습니다. 힙에 들어갈 구조체는
+ * struct heap_elem 멤버를 포함해야 하고, heap_entry 매크로로 그 구조체를
+ * 다시 얻습니다. 한 요소는 한 번에 한 힙에만 들어갈 수 있습니다.
+ *
+ * 힙에 들어 있는 요소의 키를 바꿀 때는 heap_update()로 자리를 다시 잡아야
+ * 합니다. 그러지 않으면 heap_top()이 틀린 요소를 돌려줄 수 있습니다. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem
+{
+	struct heap_elem *child; /* 첫 자식. */
+	struct heap_elem *next;	 /* 다음 형제. */
+	struct heap_elem *prev;	 /* 첫 자식이면 부모, 아니면 이전 형제. */
+};
+
+/* 힙 요소 포인터 HEAP_ELEM을, HEAP_ELEM이 포함된 구조체의 포인터로 변환합니다. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER) \
+	((STRUCT *)((uint8_t *)(HEAP_ELEM) - offsetof(STRUCT, MEMBER)))
+
+/* 두 힙 요소 A와 B의 값을, 보조 데이터 AUX를 사용하여 비교합니다.
+ * A가 B보다 작으면 true를, 그렇지 않으면 false를 반환합니다. */
+typedef bool heap_less_func(const struct heap_elem *a,
+							const struct heap_elem *b,
+							void *aux);
+
+/* Heap.  가장 큰 요소가 맨 위에 옵니다. */
+struct heap
+{
+	struct heap_elem *root; /* 가장 큰 요소, 비어 있으면 NULL. */
+	size_t elem_cnt;		/* 요소 개수. */
+	heap_less_func *less;	/* 비교 함수. */
+	void *aux;				/* `less`를 위한 보조 데이터. */
+};
+
+void heap_init(struct heap *, heap_less_func *, void *aux);
+
+void heap_push(struct heap *, struct heap_elem *);
+struct heap_elem *heap_pop(struct heap *);
+void heap_remove(struct heap *, struct heap_elem *);
+void heap_update(struct heap *, struct heap_elem *);
+
+struct heap_elem *heap_top(const struct heap *);
+size_t heap_size(const struct heap *);
+bool heap_empty(const struct heap *);
+
+#endif /* lib/kernel/heap.h */
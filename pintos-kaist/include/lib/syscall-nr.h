@@ -36,6 +36,28 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extra */
+	SYS_SYSCALL_STATS,          /* Per-syscall call counts and cycles. */
+	SYS_READV,                  /* Scatter read into several buffers. */
+	SYS_WRITEV,                 /* Gather write from several buffers. */
+	SYS_PREAD,                  /* Read at an offset. */
+	SYS_PWRITE,                 /* Write at an offset. */
+	SYS_COPY_FILE_RANGE,        /* Copy between files inside the kernel. */
+	SYS_RING_SETUP,             /* Map a submission/completion ring. */
+	SYS_RING_ENTER,             /* Submit and wait on ring entries. */
+	SYS_PIPE,                   /* Create a pipe. */
+	SYS_POLL,                   /* Wait for fds to become ready. */
+	SYS_SPAWN,                  /* Start a child directly from a file. */
+	SYS_SHM_MAP,                /* Map a named shared memory segment. */
+	SYS_SHM_UNLINK,             /* Remove a shared memory segment name. */
+	SYS_FUTEX,                  /* Wait or wake on a user address. */
+	SYS_CLONE,                  /* Start a thread in this address space. */
+	SYS_JOIN,                   /* Wait for a cloned thread. */
+	SYS_CLOCK_GETTIME,          /* Read a clock. */
+	SYS_NANOSLEEP,              /* Sleep for a while. */
+	SYS_GETRUSAGE,              /* Report resource usage. */
+	SYS_CLONE_EXIT,             /* End only the calling cloned thread. */
 };
 
 #endif /* lib/syscall-nr.h */
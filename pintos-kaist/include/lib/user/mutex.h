@@ -0,0 +1,20 @@
+#ifndef __LIB_USER_MUTEX_H
+#define __LIB_USER_MUTEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* 퓨텍스 기반 유저 뮤텍스. 경합이 없으면 시스템 콜 없이 잡고 놓습니다.
+ * 같은 shm 세그먼트 위에 두면 프로세스 사이에서도 쓸 수 있습니다. */
+struct mutex {
+	uint32_t state;             /* 0: 풀림, 1: 잠김, 2: 잠김 + 대기자 있음 */
+};
+
+#define MUTEX_INITIALIZER { 0 }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+#endif /* lib/user/mutex.h */
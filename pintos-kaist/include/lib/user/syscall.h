@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -25,6 +26,7 @@ void halt (void) NO_RETURN;
 void exit (int status) NO_RETURN;
 pid_t fork (const char *thread_name);
 int exec (const char *file);
+pid_t spawn (const char *cmd_line, const int *fd_map, int nfds);
 int wait (pid_t);
 bool create (const char *file, unsigned initial_size);
 bool remove (const char *file);
@@ -38,10 +40,127 @@ void close (int fd);
 
 int dup2(int oldfd, int newfd);
 
+/* syscall_stats()가 채우는 시스템 콜별 통계. */
+struct syscall_stat {
+	uint64_t count;             /* 호출 횟수 */
+	uint64_t cycles;            /* 핸들러에서 보낸 누적 TSC 사이클 */
+};
+int syscall_stats (struct syscall_stat *buf, int cnt);
+
+/* readv()/writev()에 넘기는 버퍼 조각. */
+struct iovec {
+	void *iov_base;             /* 버퍼 시작 주소 */
+	size_t iov_len;             /* 버퍼 길이 */
+};
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int pread (int fd, void *buffer, unsigned length, off_t offset);
+int pwrite (int fd, const void *buffer, unsigned length, off_t offset);
+int copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+		size_t length);
+
+/* 비동기 I/O용 제출/완료 링. ring_setup()이 한 페이지에 매핑합니다.
+ * 유저는 sqes[sq_tail % RING_ENTRIES]를 채우고 sq_tail을 올린 뒤
+ * ring_enter()를 부르며, 커널이 채운 cqes[cq_head % RING_ENTRIES]를
+ * 읽고 cq_head를 올립니다. 인덱스는 계속 증가하는 값입니다. */
+#define RING_ENTRIES 64
+
+enum ring_op {
+	RING_OP_NOP,                /* 아무것도 하지 않음 */
+	RING_OP_READ,               /* fd에서 addr로 len 바이트 */
+	RING_OP_WRITE,              /* addr에서 fd로 len 바이트 */
+	RING_OP_OPEN,               /* addr의 이름으로 열기, res는 새 fd */
+	RING_OP_CLOSE,              /* fd 닫기 */
+	RING_OP_SEEK,               /* fd의 위치를 off로 */
+};
+
+/* 제출 엔트리 */
+struct ring_sqe {
+	uint32_t opcode;            /* enum ring_op */
+	int32_t fd;
+	uint64_t addr;              /* 유저 버퍼 또는 파일 이름 */
+	uint32_t len;
+	uint32_t pad;
+	int64_t off;                /* READ/WRITE: 음수면 파일 위치 사용 */
+	uint64_t user_data;         /* 완료 엔트리로 그대로 돌려줌 */
+};
+
+/* 완료 엔트리 */
+struct ring_cqe {
+	uint64_t user_data;
+	int64_t res;                /* 시스템 콜 반환값, 실패하면 -1 */
+};
+
+struct ring {
+	uint32_t sq_head;           /* 커널이 소비한 위치 */
+	uint32_t sq_tail;           /* 유저가 채운 위치 */
+	uint32_t cq_head;           /* 유저가 소비한 위치 */
+	uint32_t cq_tail;           /* 커널이 채운 위치 */
+	struct ring_sqe sqes[RING_ENTRIES];
+	struct ring_cqe cqes[RING_ENTRIES];
+};
+
+int ring_setup (struct ring *ring);
+int ring_enter (unsigned to_submit, unsigned min_complete);
+
+int pipe (int fds[2]);
+
+/* poll()이 검사할 fd와 기다릴 사건. revents는 커널이 채웁니다. */
+struct pollfd {
+	int fd;                     /* 음수이면 건너뜀 */
+	short events;               /* 기다릴 POLL* 비트 */
+	short revents;              /* 일어난 POLL* 비트 */
+};
+#define POLLIN   0x001          /* 막힘 없이 읽을 수 있음 */
+#define POLLOUT  0x004          /* 막힘 없이 쓸 수 있음 */
+#define POLLERR  0x008          /* 읽는 쪽이 모두 닫힌 파이프 (항상 보고) */
+#define POLLHUP  0x010          /* 쓰는 쪽이 모두 닫힌 파이프 (항상 보고) */
+#define POLLNVAL 0x020          /* 열려 있지 않은 fd (항상 보고) */
+int poll (struct pollfd *fds, unsigned nfds, int timeout);
+
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
 
+/* 이름 있는 공유 메모리 세그먼트. 같은 이름을 매핑한 프로세스들은 같은
+ * 물리 페이지를 봅니다. 해제는 munmap()으로 합니다. */
+void *shm_map (const char *name, size_t size, void *addr, bool writable);
+bool shm_unlink (const char *name);
+
+/* futex()의 OP */
+#define FUTEX_WAIT 0            /* *UADDR == VAL이면 잠듦 */
+#define FUTEX_WAKE 1            /* UADDR에서 잠든 스레드를 VAL개까지 깨움 */
+int futex (uint32_t *uaddr, int op, uint32_t val);
+
+/* 같은 주소 공간과 fd 테이블을 쓰는 스레드. 어느 스레드든 exit()하거나
+ * 죽으면 프로세스의 모든 스레드가 끝납니다. 스레드 하나만 끝내려면
+ * clone_exit()을 부릅니다. */
+pid_t clone (void (*fn) (void *), void *aux, void *stack);
+void clone_exit (int status) NO_RETURN;
+int join (pid_t);
+
+/* clock_gettime()이 채우는 시각 */
+struct timespec {
+	int64_t tv_sec;
+	int64_t tv_nsec;
+};
+#define CLOCK_MONOTONIC 0       /* 부팅 후 흐른 시간 */
+int clock_gettime (int clock, struct timespec *ts);
+int nanosleep (const struct timespec *req);
+
+/* getrusage()가 채우는 프로세스의 자원 사용량. clone 스레드의 몫도
+ * 포함합니다. */
+struct rusage {
+	int64_t utime_ticks;        /* 유저 모드에서 보낸 타이머 틱 */
+	int64_t stime_ticks;        /* 커널 모드에서 보낸 타이머 틱 */
+	int64_t page_faults;        /* 페이지 폴트 수 */
+	int64_t swap_ins;           /* 스왑에서 읽어 온 페이지 수 */
+	int64_t swap_outs;          /* 스왑으로 내보낸 페이지 수 */
+	int64_t sectors_read;       /* 디스크에서 읽은 섹터 수 */
+	int64_t sectors_written;    /* 디스크에 쓴 섹터 수 */
+};
+int getrusage (struct rusage *usage);
+
 /* Project 4 only. */
 bool chdir (const char *dir);
 bool mkdir (const char *dir);
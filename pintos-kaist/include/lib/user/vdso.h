@@ -0,0 +1,21 @@
+#ifndef __LIB_USER_VDSO_H
+#define __LIB_USER_VDSO_H
+
+#include <stdint.h>
+
+/* 커널이 모든 유저 프로세스에 읽기 전용으로 매핑해 두는 페이지의 주소.
+ * 유저 스택 바로 위에 있습니다. */
+#define VDSO_ADDR 0x47480000
+
+/* VDSO 페이지의 내용. 커널만 쓰고 유저는 시스템 콜 없이 읽습니다. */
+struct vdso_data {
+	volatile int64_t ticks;     /* 부팅 후 타이머 틱 수 */
+	volatile int tid;           /* 지금 실행 중인 스레드의 tid, CPU가 여럿이면 -1 */
+	volatile int load_avg;      /* 시스템 load average의 100배 */
+};
+
+int64_t vdso_ticks (void);
+int vdso_gettid (void);
+int vdso_load_avg (void);
+
+#endif /* lib/user/vdso.h */
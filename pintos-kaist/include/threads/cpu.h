@@ -0,0 +1,75 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+/* CPU마다 따로 두는 상태.
+ *
+ * 스케줄러와 인터럽트 처리가 "이 CPU의 것"으로 다루는 값은 전역 변수
+ * 대신 여기에 모읍니다. BSP는 cpus[0]이고, smp_init()이 깨운 AP가
+ * 차례로 cpus[1]부터 채웁니다 (threads/smp.c).
+ *
+ * 커널은 빅 커널 락(BKL) 하나로 CPU들을 줄 세웁니다. 커널 코드를 도는
+ * CPU는 락을 쥐고 있고, 유저 모드로 돌아가거나 idle에서 hlt할 때만
+ * 놓습니다. 그래서 아래 필드 중 다른 CPU가 읽는 것들도 BKL 아래에서
+ * 읽고 씁니다. */
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* cpus[]의 크기 */
+#define NCPU_MAX 8
+
+/* CPU 하나의 레디 큐. 우선순위마다 FIFO 큐를 하나씩 두고, BITMAP의
+ * 비트 P로 QUEUES[P]가 비어 있지 않음을 표시합니다. 넣기, 빼기, 다음
+ * 스레드 고르기가 모두 O(1)입니다. */
+struct run_queue
+{
+	struct spinlock lock;			 /* 아래 필드 보호 */
+	struct list queues[PRI_MAX + 1]; /* 우선순위별 FIFO */
+	uint64_t bitmap;				 /* 비어 있지 않은 큐 */
+	int cnt;						 /* 들어 있는 스레드 수 */
+};
+
+/* 앞의 세 필드는 syscall-entry.S가 GS 베이스로 읽으므로 자리를 옮기면
+ * 안 됩니다. */
+struct cpu
+{
+	uint64_t syscall_tmp[2]; /* syscall_entry가 레지스터를 잠시 두는 곳 */
+	void *tss;				 /* 이 CPU의 TSS (userprog/tss.c) */
+	int id;					 /* cpus[]에서의 위치 */
+	uint8_t apic_id;		 /* local APIC ID (threads/smp.c) */
+	struct thread *idle;	 /* 이 CPU의 idle 스레드 */
+	struct thread *curr;	 /* 지금 이 CPU에서 돌고 있는 스레드 */
+	uint64_t *pml4;			 /* 지금 올려 둔 페이지 테이블, 커널 것이면 NULL */
+	struct run_queue rq;	 /* 이 CPU의 레디 큐 */
+	bool bkl_held;			 /* 이 CPU가 빅 커널 락을 쥐고 있음 */
+	volatile bool tlb_flush; /* 다른 CPU가 TLB를 비워 달라고 요청함 */
+	bool in_external_intr;	 /* 외부 인터럽트를 처리하는 중 (interrupt.c) */
+	bool yield_on_return;	 /* 인터럽트에서 돌아갈 때 양보 (interrupt.c) */
+	unsigned thread_ticks;	 /* 마지막 양보 뒤 지난 틱 수 */
+	long long ticks;		 /* 이 CPU가 받은 틱 수 */
+	long long idle_ticks;	 /* idle 스레드가 돈 틱 수 */
+	long long kernel_ticks;	 /* 커널 스레드가 돈 틱 수 */
+	long long user_ticks;	 /* 유저 프로그램이 돈 틱 수 */
+	long long steals;		 /* 비어서 다른 CPU에서 훔쳐 온 횟수 */
+	long long migrations;	 /* 다른 CPU에서 이 CPU로 옮겨 온 스레드 수 */
+	uint64_t rcu_gp_seen;	 /* quiescent state를 알린 마지막 유예 기간 (rcu.c) */
+};
+
+extern struct cpu cpus[NCPU_MAX];
+extern int cpu_cnt; /* 올라와 있는 CPU 수 */
+
+/* 지금 코드가 돌고 있는 CPU. 스레드는 돌기 직전에 struct thread의 cpu를
+ * 자기가 올라갈 CPU로 맞추므로, 스택 포인터로 찾은 실행 중인 스레드에서
+ * 읽습니다. thread_init() 전에는 부르면 안 됩니다. */
+static inline struct cpu *
+this_cpu(void)
+{
+	return ((struct thread *)pg_round_down(rrsp()))->cpu;
+}
+
+#endif /* threads/cpu.h */
@@ -0,0 +1,55 @@
+#ifndef THREADS_RCU_H
+#define THREADS_RCU_H
+
+/* 읽기-복사-갱신(RCU).
+ *
+ * 읽는 쪽은 rcu_read_lock()과 rcu_read_unlock() 사이에서 락 없이
+ * 자료를 훑고, 고치는 쪽은 자기들끼리만 락으로 맞춘 뒤 떼어 낸 항목을
+ * call_rcu()로 넘겨 유예 기간(grace period)이 지난 다음 해제합니다.
+ *
+ * 유예 기간은 quiescent state로 잽니다. 읽기 구간 안에서는 잠들 수
+ * 없고 양보도 구간이 끝날 때까지 미뤄지므로, 모든 CPU가 한 번씩 문맥
+ * 전환을 하거나 유저 모드에서 틱을 맞으면 그 전에 시작한 읽기는 모두
+ * 끝난 것입니다. 콜백은 "rcu" 커널 스레드가 부릅니다. */
+
+#include <list.h>
+#include <stdint.h>
+
+/* call_rcu()에 넘기는 항목. 해제할 구조체 안에 넣어 둡니다. */
+struct rcu_head;
+typedef void rcu_callback_func (struct rcu_head *);
+
+struct rcu_head
+{
+	struct list_elem elem;		/* 대기 목록의 원소 */
+	rcu_callback_func *func;	/* 유예 기간 뒤 부를 함수 */
+	uint64_t gp;				/* 끝나기를 기다리는 유예 기간 번호 */
+};
+
+void rcu_init (void);
+
+void rcu_read_lock (void);
+void rcu_read_unlock (void);
+void rcu_qs (void);
+
+void call_rcu (struct rcu_head *, rcu_callback_func *);
+void synchronize_rcu (void);
+void rcu_free (void *);
+
+/* 읽기 구간에서 RCU로 보호되는 포인터 P를 읽습니다. */
+#define rcu_dereference(P) __atomic_load_n (&(P), __ATOMIC_ACQUIRE)
+
+/* 포인터 P에 V를 게시합니다. V가 가리키는 내용이 먼저 보이게 됩니다. */
+#define rcu_assign_pointer(P, V) __atomic_store_n (&(P), (V), __ATOMIC_RELEASE)
+
+/* RCU로 보호되는 struct list. 읽는 쪽은 앞으로만 훑고(list_end()는 그대로
+ * 씁니다), 고치는 쪽은 자기 락을 쥔 채 아래 함수로만 바꿉니다. 뗀 원소는
+ * 유예 기간이 지나기 전에는 해제하거나 다시 넣으면 안 됩니다. */
+struct list_elem *list_begin_rcu (struct list *);
+struct list_elem *list_next_rcu (struct list_elem *);
+void list_insert_rcu (struct list_elem *before, struct list_elem *);
+void list_push_back_rcu (struct list *, struct list_elem *);
+void list_push_front_rcu (struct list *, struct list_elem *);
+void list_remove_rcu (struct list_elem *);
+
+#endif /* threads/rcu.h */
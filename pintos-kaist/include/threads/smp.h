@@ -0,0 +1,31 @@
+#ifndef THREADS_SMP_H
+#define THREADS_SMP_H
+
+/* Multiprocessor support.
+ *
+ * smp_init() finds the other CPUs in the BIOS's MP configuration
+ * table and starts them.  Each one gets its own GDT, TSS, local
+ * APIC timer, and idle thread, then joins the scheduler.
+ *
+ * All kernel code runs under one big kernel lock (BKL).  A CPU
+ * takes it on entry from user mode or when it wakes from the idle
+ * loop's hlt, and drops it when it returns to user mode or halts
+ * again.  Kernel data structures therefore keep the single-CPU
+ * rules they were written for, and user programs run in parallel. */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct cpu;
+
+void smp_init (void);
+
+void bkl_acquire (void);
+void bkl_release (void);
+bool bkl_held (void);
+
+void smp_send_reschedule (struct cpu *);
+void tlb_shootdown (uint64_t *pml4);
+void tlb_flush_local (void);
+
+#endif /* threads/smp.h */
@@ -1,25 +1,76 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+/* Spinlock.
+ *
+ * Guards short critical sections that never sleep.  The holder
+ * must have interrupts off, so on a single CPU the flag is never
+ * found taken; once other CPUs run, the atomic exchange is what
+ * keeps them out. */
+struct spinlock {
+	volatile int locked;        /* Nonzero while held. */
+};
+
+void spin_init (struct spinlock *);
+void spin_lock (struct spinlock *);
+void spin_unlock (struct spinlock *);
+
+struct thread;
+
+/* Wait queue.
+ *
+ * Blocked threads ordered by priority, first come first served
+ * among equals, shared by semaphores and condition variables.  A
+ * thread sleeps in at most one queue; when its priority changes
+ * while it waits, thread_change_priority() moves it. */
+struct wait_queue {
+	struct heap waiters;        /* Threads, by wait_elem. */
+	uint64_t seq;               /* Next arrival number. */
+};
+
+void wait_queue_init (struct wait_queue *);
+void wait_queue_push (struct wait_queue *, struct thread *);
+struct thread *wait_queue_pop (struct wait_queue *);
+bool wait_queue_empty (const struct wait_queue *);
+void wait_queue_update (struct thread *);
 
 /* A counting semaphore. */
 struct semaphore {
+	struct spinlock lock;       /* Protects VALUE and WAITERS. */
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct wait_queue waiters;  /* Waiting threads. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
+void sema_wake (struct semaphore *);
 void sema_self_test (void);
 
-/* Lock. */
+/* Something a thread holds that others can donate through: a
+ * lock, or its share of a reader-writer lock.  The thread keeps
+ * them in its held_locks heap keyed by PRIORITY, so the priority
+ * it has been donated is the top of that heap. */
+struct hold {
+	int priority;               /* Highest priority donated. */
+	struct heap_elem elem;      /* Element in holder's held_locks. */
+};
+
+/* Lock.
+ *
+ * Threads blocked in lock_acquire() sit in DONORS, keyed by their
+ * priority, and HOLD.PRIORITY caches the top of it. */
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	struct heap donors;         /* Waiting threads, by priority. */
+	struct hold hold;           /* Holder's share of the donation. */
 };
 
 void lock_init (struct lock *);
@@ -28,9 +79,47 @@ bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
 
+/* Reader-writer lock.
+ *
+ * Any number of readers, or one writer.  A writer holds WRITER for
+ * its whole critical section, so everyone queued behind it donates
+ * to it through the usual lock machinery.  Readers only pass
+ * through WRITER on the way in; once a writer is waiting for the
+ * readers to drain it keeps WRITER, so new readers line up behind
+ * it and writers cannot starve.
+ *
+ * Each reader inside has an rw_hold on HOLDS and in its own
+ * held_locks, and a writer waiting on DRAINED donates its priority
+ * to every one of them.  Neither side is recursive. */
+struct rwlock {
+	struct spinlock guard;      /* Protects the members below. */
+	struct lock writer;         /* Held by the writer, briefly by readers. */
+	struct semaphore drained;   /* Upped by the last reader for a writer. */
+	int readers;                /* Readers inside. */
+	bool draining;              /* A writer waits on DRAINED. */
+	struct list holds;          /* struct rw_hold of each reader. */
+};
+
+/* A reader's share of a reader-writer lock.  Each thread has
+ * RW_HOLD_MAX of them, so it can read that many rwlocks at once. */
+struct rw_hold {
+	struct hold hold;           /* Donated by a draining writer. */
+	struct rwlock *rwlock;      /* Lock being read, NULL if unused. */
+	struct thread *reader;      /* Thread reading. */
+	struct list_elem elem;      /* Element in rwlock's HOLDS. */
+};
+
+#define RW_HOLD_MAX 4
+
+void rwlock_init (struct rwlock *);
+void rwlock_read_acquire (struct rwlock *);
+void rwlock_read_release (struct rwlock *);
+void rwlock_write_acquire (struct rwlock *);
+void rwlock_write_release (struct rwlock *);
+
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct wait_queue waiters;  /* Waiting threads. */
 };
 
 void cond_init (struct condition *);
@@ -38,6 +127,27 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Poll wait queue.
+ *
+ * An object whose readiness can change (a pipe, the console) keeps
+ * one.  A poller registers a waiter carrying its own semaphore on
+ * every object it watches, then rechecks readiness and sleeps on the
+ * semaphore; each wake ups the semaphore of every waiter. */
+struct poll_queue {
+	struct list waiters;        /* List of struct poll_waiter. */
+};
+
+struct poll_waiter {
+	struct list_elem elem;      /* Element in poll_queue's list. */
+	struct semaphore *sema;     /* Upped on wake, NULL if unregistered. */
+};
+
+void poll_queue_init (struct poll_queue *);
+void poll_queue_add (struct poll_queue *, struct poll_waiter *,
+		struct semaphore *);
+void poll_queue_remove (struct poll_waiter *);
+void poll_queue_wake (struct poll_queue *);
+
 /* Optimization barrier.
  *
  * The compiler will not reorder operations across an
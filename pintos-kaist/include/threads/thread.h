@@ -30,10 +30,8 @@ typedef int tid_t;
 #define PRI_MIN 0	   /* Lowest priority. */
 #define PRI_DEFAULT 31 /* Default priority. */
 #define PRI_MAX 63	   /* Highest priority. */
-// #define MAX_FD 128
 /* Project 2 */
-#define FDT_PAGES 3					// pages to allocate for file descriptor tables (thread_create, process_exit)
-#define MAX_FD FDT_PAGES * (1 << 9) // Limit fd_idx
+#define MAX_FD 1536 // fd 테이블이 늘어날 수 있는 최대 크기 (64의 배수)
 
 /* Project2 - extra */
 #define STDIN 1
@@ -87,6 +85,19 @@ typedef int tid_t;
  * thread_current()에서 assertion 실패가 가장 먼저 나타날 것입니다.
  * 스택 오버플로우가 발생하면 이 값이 변하게 되어 assertion이 트리거됩니다.
  */
+/* 프로세스 하나가 쓴 자원. getrusage()가 보고합니다. clone 스레드의
+ * 몫도 leader에 모입니다(thread_usage()). */
+struct thread_usage
+{
+	int64_t user_ticks;		 /* 유저 모드에서 보낸 틱 */
+	int64_t kernel_ticks;	 /* 커널 모드에서 보낸 틱 */
+	int64_t page_faults;	 /* 페이지 폴트 수 */
+	int64_t swap_ins;		 /* 스왑에서 읽어 온 페이지 수 */
+	int64_t swap_outs;		 /* 스왑으로 내보낸 페이지 수 */
+	int64_t sectors_read;	 /* 디스크에서 읽은 섹터 수 */
+	int64_t sectors_written; /* 디스크에 쓴 섹터 수 */
+};
+
 /* `elem` 멤버는 두 가지 용도로 사용됩니다.
  * run queue(thread.c)의 요소가 될 수도 있고,
  * 세마포어 대기 리스트(synch.c)의 요소가 될 수도 있습니다.
@@ -106,15 +117,26 @@ struct thread
 
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem; /* List element. */
-	struct list donations; /* 자신한테 기부해준 리스트 */
-	struct lock *pending_lock;
+	struct heap held_locks;		  /* 잡고 있는 락과 읽는 rwlock, 기부받은 우선순위 순 (synch.c) */
+	struct heap_elem donor_elem;  /* 기다리는 락의 donors 힙 원소 */
+	struct lock *pending_lock;	  /* 기다리는 락 */
+	struct rwlock *draining_rw;	  /* 읽는 쪽이 빠지기를 기다리는 rwlock */
+	struct rw_hold rw_holds[RW_HOLD_MAX]; /* 읽고 있는 rwlock (synch.c) */
+	struct heap_elem wait_elem;	  /* 잠든 wait_queue의 원소 (synch.c) */
+	struct wait_queue *wait_queue; /* 잠든 wait_queue, 없으면 NULL */
+	uint64_t wait_seq;			  /* wait_queue에 들어온 순서 */
+	int rcu_nesting;			  /* 겹쳐 연 RCU 읽기 구간 수 (rcu.c) */
+	bool rcu_resched;			  /* 읽기 구간 안이라 미뤄 둔 양보가 있음 */
 
 	int nice;			// 양보하려는 정도?
 	fixed_t recent_cpu; // CPU를 얼마나 점유했나?
 	struct list_elem all_elem;
-	// TODO : 동적할당으로 해야할지도
-	struct file **fd_table; // 파일 디스크럽터 테이블
-	int fd_idx;
+	struct cpu *cpu;			 /* 마지막으로 돈 CPU, READY면 들어 있는 레디 큐의 CPU */
+	struct list_elem dirty_elem; /* MLFQS 우선순위 재계산 대기 목록의 원소 */
+	bool mlfqs_dirty;			 /* dirty_elem이 목록에 들어 있는가 */
+	struct file **fd_table; // 파일 디스크럽터 테이블 (userprog/fdtable.c)
+	int fd_cap;				// fd_table의 슬롯 수
+	uint64_t *fd_map;		// 사용 중인 fd 비트맵
 	struct semaphore fork_sema; // fork 동기화를 위한 세마포어
 	struct semaphore wait_sema; // wait를 위한 세마포어
 	struct semaphore free_sema; // 받았음을 전달하는 세마포어
@@ -124,18 +146,33 @@ struct thread
 	struct file *running_file;
 	int exit_status; /* 종료 코드 저장 */
 
-	int stdin_count;
-	int stdout_count;
+	struct thread_usage usage; /* 자원 사용량 */
 
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4; /* Page map level 4 */
+	struct io_ring *ring; /* ring_setup()으로 만든 비동기 I/O 링 */
+
+	/* clone()으로 만든 스레드는 LEADER의 pml4, SPT, fd 테이블을 함께
+	 * 씁니다. 프로세스의 첫 스레드는 LEADER가 NULL입니다. */
+	struct thread *leader;
+	int clone_cnt;				 /* 살아 있는 clone 스레드 수 (leader만) */
+	struct lock clone_lock;		 /* clone_cnt 보호 */
+	struct condition clone_done; /* clone_cnt가 0이 되면 signal */
+	struct lock fd_lock;		 /* fd 테이블 보호 (leader만) */
+	struct list clones;			 /* 살아 있는 clone 스레드 (leader만) */
+	struct list_elem clone_elem; /* leader의 clones 원소 */
+
+	/* 어느 스레드든 exit하면 그룹 전체가 끝납니다. 잠든 스레드는
+	 * kill_sema에서 깨워 유저 모드로 돌아가기 전에 끝나게 합니다. */
+	bool group_dying;			 /* 그룹이 끝나는 중 (leader만) */
+	int group_status;			 /* 그룹의 종료 코드 (leader만) */
+	struct semaphore *kill_sema; /* 잠들어 있는 세마포어, 없으면 NULL */
 
 #endif
 #ifdef VM
 	/* Table for whole virtual memory owned by thread. */
 	struct supplemental_page_table spt;
-	void *user_rsp;
 #endif
 
 	/* Owned by thread.c. */
@@ -150,8 +187,11 @@ extern bool thread_mlfqs;
 
 void thread_init(void);
 void thread_start(void);
+struct thread *thread_create_idle(struct cpu *);
+void thread_start_ap(void) NO_RETURN;
 
-void thread_tick(void);
+void thread_tick(bool user);
+void thread_idle_tick(void);
 void thread_print_stats(void);
 
 typedef void thread_func(void *aux);
@@ -165,6 +205,17 @@ tid_t thread_tid(void);
 const char *thread_name(void);
 
 void thread_exit(void) NO_RETURN;
+struct thread_usage *thread_usage(void);
+
+#ifdef USERPROG
+/* T가 속한 프로세스의 첫 스레드. 주소 공간, SPT, fd 테이블은 이
+ * 스레드의 것을 씁니다. */
+static inline struct thread *
+thread_leader(struct thread *t)
+{
+	return t->leader != NULL ? t->leader : t;
+}
+#endif
 void thread_yield(void);
 
 int thread_get_priority(void);
@@ -177,7 +228,9 @@ int thread_get_recent_cpu(void);
 int thread_get_load_avg(void);
 
 void update_priority(struct thread *);
-void update_all_priority(void);
+void thread_change_priority(struct thread *, int priority);
+bool thread_refresh_priority(struct thread *);
+void update_changed_priority(void);
 void update_recent_cpu(void);
 void update_recent_cpu_all(void);
 void update_load_avg(void);
@@ -185,18 +238,10 @@ void mlfqs_on_tick(void);
 
 void do_iret(struct intr_frame *tf);
 
-typedef struct __donation__
-{
-	struct list_elem elem;
-	int priority;
-	struct thread *donor;
-	struct lock *lock;
-} donation;
-
 struct fork_info
 {
 	struct thread *parent;
 	struct intr_frame parent_if;
 };
 
-#endif /* threads/thread.h */
\ No newline at end of file
+#endif /* threads/thread.h */
\ No newline at end of file
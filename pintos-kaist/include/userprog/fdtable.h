@@ -0,0 +1,19 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdbool.h>
+
+struct thread;
+struct file;
+
+bool fdt_init (struct thread *);
+void fdt_destroy (struct thread *);
+struct file *fdt_get (struct thread *, int fd);
+void fdt_put (struct file *);
+int fdt_alloc (struct thread *, struct file *);
+bool fdt_install (struct thread *, int fd, struct file *);
+bool fdt_replace (struct thread *, int fd, struct file *, struct file **old);
+struct file *fdt_clear (struct thread *, int fd);
+int fdt_next (struct thread *, int fd);
+
+#endif /* userprog/fdtable.h */
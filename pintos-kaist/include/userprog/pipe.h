@@ -0,0 +1,25 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/file.h"
+#include "threads/thread.h"
+
+/* FILE이 파이프의 한쪽 끝이면 true. 콘솔 표식(STDIN, STDOUT)도 받습니다. */
+static inline bool
+file_is_pipe (const struct file *file) {
+	return file != NULL && file != (struct file *) STDIN
+		&& file != (struct file *) STDOUT && file->pipe != NULL;
+}
+
+bool pipe_create (struct file **read_end, struct file **write_end);
+struct file *pipe_duplicate (struct file *end);
+void pipe_close (struct file *end);
+void pipe_release (struct file *end);
+int pipe_read (struct file *end, void *buf, size_t size);
+int pipe_write (struct file *end, const void *buf, size_t size);
+short pipe_poll (struct file *end);
+struct poll_queue *pipe_poll_queue (struct file *end);
+
+#endif /* userprog/pipe.h */
@@ -6,11 +6,19 @@
 tid_t process_create_initd (const char *file_name);
 tid_t process_fork (const char *name, struct intr_frame *if_);
 int process_exec (void *f_name);
+tid_t process_spawn (char *cmd_line, const int *fd_map, int nfds);
 int process_wait (tid_t);
+tid_t process_clone (struct intr_frame *if_, void *entry, uint64_t arg0,
+		uint64_t arg1, void *stack);
+int process_join (tid_t);
 void process_exit (void);
+void process_kill_group (struct thread *leader, int status);
+bool process_dying (void);
+void process_die (void) NO_RETURN;
+bool process_sleep (struct semaphore *);
 void process_activate (struct thread *next);
 bool lazy_load_segment(struct page *page, void *aux);
-struct lock filesys_lock;
+struct rwlock filesys_lock;
 
 
 #endif /* userprog/process.h */
@@ -1,6 +1,14 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <debug.h>
+
+struct file;
+
 void syscall_init (void);
+void syscall_init_cpu (void);
+void sys_exit (int status) NO_RETURN;
+void sys_close (int fd);
+int find_unused_fd (struct file *file);
 
 #endif /* userprog/syscall.h */
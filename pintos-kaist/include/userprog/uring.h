@@ -0,0 +1,11 @@
+#ifndef USERPROG_URING_H
+#define USERPROG_URING_H
+
+#include "lib/user/syscall.h"
+
+void uring_init (void);
+int uring_setup (struct ring *uring);
+int uring_enter (unsigned to_submit, unsigned min_complete);
+void uring_destroy (void);
+
+#endif /* userprog/uring.h */
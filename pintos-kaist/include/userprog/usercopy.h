@@ -0,0 +1,53 @@
+#ifndef USERPROG_USERCOPY_H
+#define USERPROG_USERCOPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/vaddr.h"
+
+/* usercopy.S */
+size_t __copy_user (void *dst, const void *src, size_t n);
+int64_t __strncpy_user (char *dst, const char *src, size_t n);
+
+/* [UADDR, UADDR + SIZE)가 전부 유저 영역 안에 있으면 true. */
+static inline bool
+user_range_ok (const void *uaddr, size_t size) {
+	uint64_t start = (uint64_t) uaddr;
+	return start + size >= start && start + size <= KERN_BASE;
+}
+
+/* 유저 주소 USRC에서 커널 버퍼 KDST로 SIZE 바이트를 복사합니다.
+ * 유저 메모리를 미리 검사하지 않고 바로 접근하며, 잘못된 주소는
+ * 예외 테이블을 통해 복구됩니다. 성공하면 true를 반환합니다. */
+static inline bool
+copy_from_user (void *kdst, const void *usrc, size_t size) {
+	return user_range_ok (usrc, size) && __copy_user (kdst, usrc, size) == 0;
+}
+
+/* 커널 버퍼 KSRC에서 유저 주소 UDST로 SIZE 바이트를 복사합니다.
+ * 성공하면 true를 반환합니다. */
+static inline bool
+copy_to_user (void *udst, const void *ksrc, size_t size) {
+	return user_range_ok (udst, size) && __copy_user (udst, ksrc, size) == 0;
+}
+
+/* 유저 문자열 USRC를 KDST로 최대 SIZE 바이트 복사합니다.
+ * 문자열 길이를 반환하며, SIZE 바이트 안에 끝나지 않으면 SIZE를,
+ * 잘못된 주소면 -1을 반환합니다. */
+static inline int64_t
+strncpy_from_user (char *kdst, const char *usrc, size_t size) {
+	size_t room;
+
+	if (!is_user_vaddr (usrc))
+		return -1;
+	/* 커널 영역에 닿기 전까지만 읽습니다. */
+	room = KERN_BASE - (uint64_t) usrc;
+	if (room < size) {
+		int64_t len = __strncpy_user (kdst, usrc, room);
+		return len == (int64_t) room ? -1 : len;
+	}
+	return __strncpy_user (kdst, usrc, size);
+}
+
+#endif /* userprog/usercopy.h */
@@ -0,0 +1,23 @@
+#ifndef USERPROG_VDSO_H
+#define USERPROG_VDSO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lib/user/vdso.h"
+#include "threads/vaddr.h"
+
+struct thread;
+
+void vdso_init (void);
+bool vdso_map (uint64_t *pml4);
+void vdso_unmap (uint64_t *pml4);
+void vdso_tick (int64_t ticks);
+void vdso_switch (struct thread *next);
+
+/* VA가 VDSO 페이지 안에 있는지 확인합니다. */
+static inline bool
+is_vdso_page (const void *va) {
+	return pg_round_down (va) == (void *) VDSO_ADDR;
+}
+
+#endif /* userprog/vdso.h */
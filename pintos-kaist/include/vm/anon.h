@@ -1,18 +1,32 @@
 #ifndef VM_ANON_H
 #define VM_ANON_H
 #include "vm/vm.h"
+#include "devices/disk.h"
 struct page;
 enum vm_type;
+struct swap_device;
 
-#define SECTORS_PER_PAGE (PGSIZE/BLOCK_SECTOR_SIZE)
+#define SECTORS_PER_PAGE (PGSIZE/DISK_SECTOR_SIZE)
 
 struct anon_page
 {
     /* 음수이면 스왑 아웃 상태가 아님 */
     int swap_idx;
+    /* swap_idx가 가리키는 슬롯을 가진 스왑 장치 */
+    struct swap_device *swap_dev;
 };
 
 void vm_anon_init(void);
 bool anon_initializer(struct page *page, enum vm_type type, void *kva);
 
+/* 스왑 슬롯 하나를 다루는 함수들. 익명 페이지가 아닌 곳(shm)에서도
+ * struct anon_page를 스왑 위치로 삼아 씁니다. */
+bool swap_slot_save(struct anon_page *slot, void *kva);
+void swap_slot_load(struct anon_page *slot, void *kva);
+void swap_slot_discard(struct anon_page *slot);
+
+/* 커널 커맨드라인 -swap-disk, -swap-file 옵션 */
+bool swap_add_disk_option(const char *spec);
+bool swap_add_file_option(const char *spec);
+
 #endif
@@ -0,0 +1,38 @@
+#ifndef VM_SHM_H
+#define VM_SHM_H
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "vm/vm.h"
+
+struct page;
+enum vm_type;
+struct shm_segment;
+
+/* 세그먼트 이름의 최대 길이 */
+#define SHM_NAME_MAX 14
+
+struct shm_page
+{
+    /* 이 페이지가 가리키는 세그먼트와 그 안에서의 페이지 번호 */
+    struct shm_segment *seg;
+    size_t idx;
+    /* 매핑 페이지의 주소 공간 주인. clone 스레드가 만든 매핑이어도
+       pml4를 가진 스레드 그룹의 리더입니다 */
+    struct thread *owner;
+    /* 프레임을 매핑하고 있는 동안 세그먼트 슬롯의 mappers 목록 원소 */
+    struct list_elem elem;
+    /* 매핑의 첫 페이지이면 매핑 길이(페이지 수), 아니면 0 */
+    size_t map_cnt;
+};
+
+void vm_shm_init(void);
+bool shm_initializer(struct page *page, enum vm_type type, void *kva);
+bool shm_claim_page(struct page *page);
+bool shm_copy_page(struct page *src);
+bool shm_anchor_pin(struct page *anchor);
+void *shm_map(const char *name, size_t size, void *addr, bool writable);
+void shm_unmap(void *addr);
+bool shm_unlink(const char *name);
+
+#endif
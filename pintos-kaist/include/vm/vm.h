@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include "threads/palloc.h"
 #include "lib/kernel/hash.h"
+#include "threads/synch.h"
 
 enum vm_type
 {
@@ -14,6 +15,8 @@ enum vm_type
 	VM_FILE = 2,
 	/* 페이지 캐시를 보유하는 페이지, 프로젝트 4용 */
 	VM_PAGE_CACHE = 3,
+	/* 여러 프로세스가 함께 매핑하는 공유 메모리 세그먼트의 페이지 */
+	VM_SHM = 4,
 
 	/* 상태를 저장하기 위한 비트 플래그 */
 
@@ -29,6 +32,7 @@ enum vm_type
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
+#include "vm/shm.h"
 #ifdef EFILESYS
 #include "filesys/page_cache.h"
 #endif
@@ -76,6 +80,7 @@ struct page
 		struct uninit_page uninit;
 		struct anon_page anon;
 		struct file_page file;
+		struct shm_page shm;
 #ifdef EFILESYS
 		struct page_cache page_cache;
 #endif
@@ -117,6 +122,7 @@ struct page_operations
 struct supplemental_page_table
 {
 	struct hash spt_hash;
+	struct lock lock; /* clone 스레드끼리 공유하므로 해시를 보호합니다 */
 };
 
 struct frame_table
@@ -127,10 +133,12 @@ struct frame_table
 
 #include "threads/thread.h"
 extern struct frame_table *frame_table;
+
 void supplemental_page_table_init(struct supplemental_page_table *spt);
 bool supplemental_page_table_copy(struct supplemental_page_table *dst,
 								  struct supplemental_page_table *src);
 void supplemental_page_table_kill(struct supplemental_page_table *spt);
+struct supplemental_page_table *current_spt(void);
 struct page *spt_find_page(struct supplemental_page_table *spt,
 						   void *va);
 bool spt_insert_page(struct supplemental_page_table *spt, struct page *page);
@@ -138,6 +146,7 @@ void spt_remove_page(struct supplemental_page_table *spt, struct page *page);
 
 void vm_init(void);
 void frame_table_init();
+struct frame *vm_get_frame(void);
 bool vm_try_handle_fault(struct intr_frame *f, void *addr, bool user,
 						 bool write, bool not_present);
 
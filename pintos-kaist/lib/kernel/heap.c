@@ -0,0 +1,168 @@
+/* Pairing heap.
+
+   See heap.h for basic information. */
+
+#include "heap.h"
+#include "../debug.h"
+
+static struct heap_elem *meld(struct heap *, struct heap_elem *,
+							  struct heap_elem *);
+static struct heap_elem *merge_pairs(struct heap *, struct heap_elem *);
+static void cut(struct heap_elem *);
+
+/* 힙 H를 LESS와 보조 데이터 AUX로 요소를 비교하는 빈 힙으로 초기화합니다. */
+void heap_init(struct heap *h, heap_less_func *less, void *aux)
+{
+	ASSERT(h != NULL);
+	ASSERT(less != NULL);
+
+	h->root = NULL;
+	h->elem_cnt = 0;
+	h->less = less;
+	h->aux = aux;
+}
+
+/* E를 H에 넣습니다. */
+void heap_push(struct heap *h, struct heap_elem *e)
+{
+	ASSERT(h != NULL);
+	ASSERT(e != NULL);
+
+	e->child = e->next = e->prev = NULL;
+	h->root = h->root != NULL ? meld(h, h->root, e) : e;
+	h->elem_cnt++;
+}
+
+/* H에서 가장 큰 요소를 빼서 반환합니다. H는 비어 있으면 안 됩니다. */
+struct heap_elem *
+heap_pop(struct heap *h)
+{
+	struct heap_elem *top = h->root;
+
+	ASSERT(top != NULL);
+
+	h->root = merge_pairs(h, top->child);
+	h->elem_cnt--;
+	return top;
+}
+
+/* H에 들어 있는 E를 뺍니다. */
+void heap_remove(struct heap *h, struct heap_elem *e)
+{
+	struct heap_elem *sub;
+
+	ASSERT(h != NULL && h->root != NULL);
+	ASSERT(e != NULL);
+
+	if (e == h->root)
+	{
+		heap_pop(h);
+		return;
+	}
+
+	cut(e);
+	sub = merge_pairs(h, e->child);
+	if (sub != NULL)
+		h->root = meld(h, h->root, sub);
+	h->elem_cnt--;
+}
+
+/* 키가 바뀐 E의 자리를 다시 잡습니다. */
+void heap_update(struct heap *h, struct heap_elem *e)
+{
+	heap_remove(h, e);
+	heap_push(h, e);
+}
+
+/* H에서 가장 큰 요소를 반환합니다. 비어 있으면 NULL을 반환합니다. */
+struct heap_elem *
+heap_top(const struct heap *h)
+{
+	return h->root;
+}
+
+/* H의 요소 개수를 반환합니다. */
+size_t
+heap_size(const struct heap *h)
+{
+	return h->elem_cnt;
+}
+
+/* H가 비어 있으면 true를 반환합니다. */
+bool heap_empty(const struct heap *h)
+{
+	return h->root == NULL;
+}
+
+/* 두 루트 A와 B를 합쳐 작은 쪽을 큰 쪽의 첫 자식으로 붙이고, 큰 쪽을
+   반환합니다. */
+static struct heap_elem *
+meld(struct heap *h, struct heap_elem *a, struct heap_elem *b)
+{
+	if (h->less(a, b, h->aux))
+	{
+		struct heap_elem *t = a;
+		a = b;
+		b = t;
+	}
+
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+
+	a->next = a->prev = NULL;
+	return a;
+}
+
+/* FIRST부터 이어지는 형제들을 두 번에 걸쳐 짝지어 합치고, 그 루트를
+   반환합니다. 왼쪽부터 둘씩 합친 다음 오른쪽부터 하나로 합칩니다. */
+static struct heap_elem *
+merge_pairs(struct heap *h, struct heap_elem *first)
+{
+	struct heap_elem *pairs = NULL; /* next로 이어진 스택. */
+	struct heap_elem *root = NULL;
+
+	while (first != NULL)
+	{
+		struct heap_elem *a = first;
+		struct heap_elem *b = a->next;
+
+		if (b != NULL)
+		{
+			first = b->next;
+			a = meld(h, a, b);
+		}
+		else
+			first = NULL;
+		a->next = pairs;
+		pairs = a;
+	}
+
+	while (pairs != NULL)
+	{
+		struct heap_elem *next = pairs->next;
+
+		root = root != NULL ? meld(h, root, pairs) : pairs;
+		pairs = next;
+	}
+
+	if (root != NULL)
+		root->next = root->prev = NULL;
+	return root;
+}
+
+/* 루트가 아닌 E를 부모와 형제들에게서 떼어 냅니다. E의 자식은 그대로
+   둡니다. */
+static void
+cut(struct heap_elem *e)
+{
+	if (e->prev->child == e)
+		e->prev->child = e->next;
+	else
+		e->prev->next = e->next;
+	if (e->next != NULL)
+		e->next->prev = e->prev;
+	e->next = e->prev = NULL;
+}
@@ -0,0 +1,44 @@
+#include <mutex.h>
+#include <syscall.h>
+
+/* 커널에 들어가기 전에 잠긴 뮤텍스를 다시 확인해 보는 횟수 */
+#define MUTEX_SPIN 100
+
+void
+mutex_init (struct mutex *m) {
+	m->state = 0;
+}
+
+/* 풀려 있으면 잡고 true를, 아니면 바로 false를 반환합니다. */
+bool
+mutex_trylock (struct mutex *m) {
+	uint32_t c = 0;
+	return __atomic_compare_exchange_n (&m->state, &c, 1, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/* 잡을 때까지 기다립니다. 잠시 돌며 기다리다가 그래도 잠겨 있으면
+ * state를 2로 바꿔 대기자가 있음을 알리고 커널에서 잠듭니다. */
+void
+mutex_lock (struct mutex *m) {
+	uint32_t c;
+
+	for (int i = 0; i < MUTEX_SPIN; i++) {
+		if (mutex_trylock (m))
+			return;
+		asm volatile ("pause");
+	}
+
+	c = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+	while (c != 0) {
+		futex (&m->state, FUTEX_WAIT, 2);
+		c = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+	}
+}
+
+/* 뮤텍스를 놓고, 대기자가 있었으면 하나를 깨웁니다. */
+void
+mutex_unlock (struct mutex *m) {
+	if (__atomic_exchange_n (&m->state, 0, __ATOMIC_RELEASE) == 2)
+		futex (&m->state, FUTEX_WAKE, 1);
+}
@@ -72,12 +72,9 @@ __attribute__((always_inline)) static __inline int64_t syscall(uint64_t num_, ui
 /* syscall4:
  * 네 개의 인자를 받는 시스템 콜을 호출한다.
  * ARG0 → rdi, ARG1 → rsi, ARG2 → rdx, ARG3 → r10.
- * 나머지 2개 인자는 0으로 채운다.
- *
- * ❗주의: NUMBER를 (uint64_t *)로 잘못 형변환하고 있음.
- * 실제 구현에서는 (uint64_t)로 고쳐야 함. */
+ * 나머지 2개 인자는 0으로 채운다. */
 #define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3) ( \
-	syscall(((uint64_t *)NUMBER),                  \
+	syscall(((uint64_t)NUMBER),                    \
 			((uint64_t)ARG0),                      \
 			((uint64_t)ARG1),                      \
 			((uint64_t)ARG2),                      \
@@ -125,6 +122,15 @@ int exec(const char *file)
 {
 	return (pid_t)syscall1(SYS_EXEC, file);
 }
+/* spawn:
+ * CMD_LINE을 실행하는 자식 프로세스를 fork() 없이 바로 만든다.
+ * 자식의 fd i는 부모의 fd FD_MAP[i]를 물려받고(음수면 비움),
+ * FD_MAP이 NULL이면 콘솔 fd 0, 1만 가진다.
+ * 로드까지 성공하면 자식의 pid를, 실패하면 -1을 반환한다. */
+pid_t spawn(const char *cmd_line, const int *fd_map, int nfds)
+{
+	return (pid_t)syscall3(SYS_SPAWN, cmd_line, fd_map, nfds);
+}
 /* wait:
  * 주어진 pid의 자식 프로세스가 종료될 때까지 대기한다.
  * SYS_WAIT 시스템 콜 번호와 대기할 자식의 pid를 전달한다.
@@ -234,6 +240,80 @@ int dup2(int oldfd, int newfd)
 	return syscall2(SYS_DUP2, oldfd, newfd);
 }
 
+/* syscall_stats:
+ * 시스템 콜 번호별 호출 횟수와 누적 사이클을 BUF에 최대 CNT개 채운다.
+ * 반환값은 커널이 아는 시스템 콜 수이다. */
+int syscall_stats(struct syscall_stat *buf, int cnt)
+{
+	return syscall2(SYS_SYSCALL_STATS, buf, cnt);
+}
+
+/* readv, writev:
+ * IOV[0..IOVCNT) 버퍼들을 하나로 이어 붙인 것처럼 한 번에 읽고 쓴다.
+ * 반환값은 전송한 총 바이트 수이다. */
+int readv(int fd, const struct iovec *iov, int iovcnt)
+{
+	return syscall3(SYS_READV, fd, iov, iovcnt);
+}
+
+int writev(int fd, const struct iovec *iov, int iovcnt)
+{
+	return syscall3(SYS_WRITEV, fd, iov, iovcnt);
+}
+
+/* pread, pwrite:
+ * 파일 위치(seek/tell)를 바꾸지 않고 OFFSET에서 읽고 쓴다. */
+int pread(int fd, void *buffer, unsigned size, off_t offset)
+{
+	return syscall4(SYS_PREAD, fd, buffer, size, offset);
+}
+
+int pwrite(int fd, const void *buffer, unsigned size, off_t offset)
+{
+	return syscall4(SYS_PWRITE, fd, buffer, size, offset);
+}
+
+/* copy_file_range:
+ * FD_IN의 데이터를 유저 버퍼를 거치지 않고 FD_OUT으로 LENGTH 바이트 복사한다.
+ * OFF_IN/OFF_OUT이 NULL이면 파일 위치를 쓰고, 아니면 그 오프셋을 쓰고 갱신한다.
+ * 반환값은 복사한 바이트 수이다. */
+int copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t length)
+{
+	return syscall5(SYS_COPY_FILE_RANGE, fd_in, off_in, fd_out, off_out, length);
+}
+
+/* ring_setup:
+ * 페이지 정렬된 빈 주소 RING에 제출/완료 링을 만든다. 성공하면 0을 반환한다.
+ * ring_enter:
+ * 링에 쌓인 요청을 최대 TO_SUBMIT개 제출하고, 완료가 MIN_COMPLETE개
+ * 모일 때까지 기다린다. 반환값은 제출한 요청 수이다. */
+int ring_setup(struct ring *ring)
+{
+	return syscall1(SYS_RING_SETUP, ring);
+}
+
+int ring_enter(unsigned to_submit, unsigned min_complete)
+{
+	return syscall2(SYS_RING_ENTER, to_submit, min_complete);
+}
+
+/* pipe:
+ * 파이프를 만들고 FDS[0]에 읽기 끝, FDS[1]에 쓰기 끝의 fd를 담는다.
+ * 성공하면 0, 실패하면 -1을 반환한다. */
+int pipe(int fds[2])
+{
+	return syscall1(SYS_PIPE, fds);
+}
+
+/* poll:
+ * FDS의 NFDS개 fd 가운데 하나라도 준비될 때까지 최대 TIMEOUT 밀리초
+ * 기다린다. TIMEOUT이 음수이면 무한히, 0이면 기다리지 않는다.
+ * 반환값은 revents가 0이 아닌 항목 수이며, 시간이 다 되면 0이다. */
+int poll(struct pollfd *fds, unsigned nfds, int timeout)
+{
+	return syscall3(SYS_POLL, fds, nfds, timeout);
+}
+
 // 아래부터는 일부는 프로젝트3에서, 나머지는 프로젝트 4에서 구현하게 됨.
 void *
 mmap(void *addr, size_t length, int writable, int fd, off_t offset)
@@ -246,6 +326,91 @@ void munmap(void *addr)
 	syscall1(SYS_MUNMAP, addr);
 }
 
+/* shm_map:
+ * 이름이 NAME인 공유 메모리 세그먼트의 앞 SIZE 바이트를 ADDR에 매핑한다.
+ * 세그먼트가 없으면 SIZE 크기로 새로 만든다. 성공하면 ADDR을, 실패하면
+ * MAP_FAILED를 반환한다. munmap(ADDR)로 매핑을 없앤다.
+ * shm_unlink:
+ * 세그먼트 NAME의 이름을 지운다. 이미 매핑한 프로세스는 계속 쓸 수 있고,
+ * 마지막 매핑이 사라지면 세그먼트도 사라진다. */
+void *shm_map(const char *name, size_t size, void *addr, bool writable)
+{
+	return (void *)syscall4(SYS_SHM_MAP, name, size, addr, writable);
+}
+
+bool shm_unlink(const char *name)
+{
+	return syscall1(SYS_SHM_UNLINK, name);
+}
+
+/* futex:
+ * OP이 FUTEX_WAIT이면 *UADDR이 아직 VAL일 때 잠들고, 깨어나면 0을,
+ * 값이 이미 달라 잠들지 않았으면 -1을 반환한다.
+ * OP이 FUTEX_WAKE이면 UADDR에서 잠든 스레드를 최대 VAL개 깨우고
+ * 깨운 수를 반환한다. 같은 shm 세그먼트 위의 주소는 프로세스가 달라도
+ * 같은 대기 큐를 쓴다. */
+int futex(uint32_t *uaddr, int op, uint32_t val)
+{
+	return syscall3(SYS_FUTEX, uaddr, op, val);
+}
+
+/* clone()으로 만든 스레드가 처음 실행하는 함수. FN이 돌아오면 그
+ * 스레드만 끝낸다. */
+static void
+clone_start(void (*fn)(void *), void *aux)
+{
+	fn(aux);
+	clone_exit(0);
+}
+
+/* clone:
+ * 같은 주소 공간 안에서 STACK을 스택 꼭대기로 삼아 FN(AUX)를 실행하는
+ * 스레드를 만든다. STACK 영역은 호출자가 마련해야 한다.
+ * 새 스레드의 id를, 실패하면 -1을 반환한다. */
+pid_t clone(void (*fn)(void *), void *aux, void *stack)
+{
+	return (pid_t)syscall4(SYS_CLONE, clone_start, fn, aux, stack);
+}
+
+/* clone_exit:
+ * 부른 clone 스레드만 끝내고 STATUS를 join()에 넘긴다. exit()은
+ * 프로세스의 모든 스레드를 끝낸다. */
+void clone_exit(int status)
+{
+	syscall1(SYS_CLONE_EXIT, status);
+	NOT_REACHED();
+}
+
+/* join:
+ * clone()으로 만든 스레드 TID가 끝나기를 기다려 종료 코드를 반환한다. */
+int join(pid_t tid)
+{
+	return syscall1(SYS_JOIN, tid);
+}
+
+/* clock_gettime:
+ * CLOCK 시계의 현재 시각을 TS에 채운다. CLOCK_MONOTONIC만 지원하며
+ * 틱보다 잘게 잰다. 성공하면 0을, 아니면 -1을 반환한다. */
+int clock_gettime(int clock, struct timespec *ts)
+{
+	return syscall2(SYS_CLOCK_GETTIME, clock, ts);
+}
+
+/* nanosleep:
+ * 적어도 REQ만큼 잠든다. 한 틱(10ms) 이상은 틱 단위로 재우고, 그보다
+ * 짧으면 커널 안에서 돌며 기다린다. 성공하면 0을, 아니면 -1을 반환한다. */
+int nanosleep(const struct timespec *req)
+{
+	return syscall1(SYS_NANOSLEEP, req);
+}
+
+/* getrusage:
+ * 이 프로세스가 지금까지 쓴 자원을 USAGE에 채운다. 성공하면 0을 반환한다. */
+int getrusage(struct rusage *usage)
+{
+	return syscall1(SYS_GETRUSAGE, usage);
+}
+
 bool chdir(const char *dir)
 {
 	return syscall1(SYS_CHDIR, dir);
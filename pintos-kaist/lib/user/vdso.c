@@ -0,0 +1,22 @@
+#include <vdso.h>
+
+/* 커널이 매핑해 둔 VDSO 페이지를 읽기만 하므로 시스템 콜이 없습니다. */
+static const struct vdso_data *const vdso = (const struct vdso_data *) VDSO_ADDR;
+
+/* 부팅 후 지난 타이머 틱 수를 반환합니다. */
+int64_t
+vdso_ticks (void) {
+	return vdso->ticks;
+}
+
+/* 호출한 스레드의 tid를 반환합니다. CPU가 여럿이면 -1입니다. */
+int
+vdso_gettid (void) {
+	return vdso->tid;
+}
+
+/* 시스템 load average의 100배를 반환합니다. */
+int
+vdso_load_avg (void) {
+	return vdso->load_avg;
+}
@@ -0,0 +1,53 @@
+/* Wakes several higher-priority pollers through one poll queue.
+   Each poller unregisters its waiter and scribbles over it as
+   soon as it runs, so poll_queue_wake() must not let any of them
+   run before it has finished walking the queue.  The pollers
+   must then run in priority order. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define POLLER_CNT 3
+
+static thread_func priority_poll_thread;
+static struct poll_queue queue;
+
+void
+test_priority_poll (void)
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  poll_queue_init (&queue);
+  for (i = 0; i < POLLER_CNT; i++)
+    {
+      int priority = PRI_DEFAULT + i + 1;
+      char name[16];
+      snprintf (name, sizeof name, "priority %d", priority);
+      thread_create (name, priority, priority_poll_thread, NULL);
+    }
+
+  msg ("Waking %d pollers.", POLLER_CNT);
+  poll_queue_wake (&queue);
+  msg ("Back in main thread.");
+}
+
+static void
+priority_poll_thread (void *aux UNUSED)
+{
+  struct poll_waiter waiter;
+  struct semaphore sema;
+
+  sema_init (&sema, 0);
+  poll_queue_add (&queue, &waiter, &sema);
+  sema_down (&sema);
+  poll_queue_remove (&waiter);
+  memset (&waiter, 0xcc, sizeof waiter);
+  msg ("Thread %s woke up.", thread_name ());
+}
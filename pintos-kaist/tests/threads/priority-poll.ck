@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-poll) begin
+(priority-poll) Waking 3 pollers.
+(priority-poll) Thread priority 34 woke up.
+(priority-poll) Thread priority 33 woke up.
+(priority-poll) Thread priority 32 woke up.
+(priority-poll) Back in main thread.
+(priority-poll) end
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Child process run by spawn-fd.  Expects the parent to have
+   mapped a pipe's write end to fd 2 and another pipe's read end
+   to fd 3, and nothing at fd 4.  Copies everything from fd 3 to
+   fd 2 and exits with the number of bytes copied. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-spawn";
+
+int
+main (void)
+{
+  char buf[64];
+  int total = 0;
+  int n;
+
+  if (write (4, "x", 1) != -1)
+    fail ("fd 4 is open");
+  while ((n = read (3, buf, sizeof buf)) > 0)
+    {
+      if (write (2, buf, n) != n)
+        fail ("write to fd 2 failed");
+      total += n;
+    }
+  if (n < 0)
+    fail ("read from fd 3 failed");
+  return total;
+}
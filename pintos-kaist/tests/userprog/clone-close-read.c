@@ -0,0 +1,44 @@
+/* A clone thread blocks reading a pipe while the first thread
+   closes the read end under it.  The blocked read must still
+   complete against the open pipe, and the read end must really
+   close once the reader lets go of it. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int fds[2];
+static char stack[4096] __attribute__ ((aligned (16)));
+static volatile int started;
+
+static void
+reader (void *aux UNUSED)
+{
+  char c = 0;
+  int n;
+
+  started = 1;
+  n = read (fds[0], &c, 1);
+  clone_exit (n == 1 && c == 'x' ? 0 : 1);
+}
+
+void
+test_main (void)
+{
+  struct timespec ts = {0, 50 * 1000 * 1000};
+  pid_t tid;
+
+  CHECK (pipe (fds) == 0, "pipe");
+  CHECK ((tid = clone (reader, NULL, stack + sizeof stack)) > 0, "clone");
+
+  /* Give the reader time to block inside read(). */
+  while (!started)
+    continue;
+  nanosleep (&ts);
+
+  close (fds[0]);
+  CHECK (write (fds[1], "x", 1) == 1, "write while the reader still holds the end");
+  CHECK (join (tid) == 0, "reader read the byte");
+  CHECK (write (fds[1], "x", 1) == -1, "write after the last reader is gone");
+  close (fds[1]);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clone-close-read) begin
+(clone-close-read) pipe
+(clone-close-read) clone
+(clone-close-read) write while the reader still holds the end
+(clone-close-read) reader read the byte
+(clone-close-read) write after the last reader is gone
+(clone-close-read) end
+clone-close-read: exit(0)
+EOF
+pass;
@@ -0,0 +1,31 @@
+/* A clone thread calls exit() while the first thread is blocked
+   reading an empty pipe.  The whole process must end with the
+   clone's status instead of leaving the first thread asleep. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char stack[4096] __attribute__ ((aligned (16)));
+
+static void
+killer (void *aux UNUSED)
+{
+  struct timespec ts = {0, 50 * 1000 * 1000};
+
+  /* Give the first thread time to block inside read(). */
+  nanosleep (&ts);
+  exit (57);
+}
+
+void
+test_main (void)
+{
+  int fds[2];
+  char c;
+
+  CHECK (pipe (fds) == 0, "pipe");
+  CHECK (clone (killer, NULL, stack + sizeof stack) > 0, "clone");
+  read (fds[0], &c, 1);
+  fail ("read returned to a dying process");
+}
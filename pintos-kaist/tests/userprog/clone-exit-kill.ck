@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clone-exit-kill) begin
+(clone-exit-kill) pipe
+(clone-exit-kill) clone
+clone-exit-kill: exit(57)
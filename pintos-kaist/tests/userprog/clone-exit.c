@@ -0,0 +1,44 @@
+/* The first thread returns from main while one clone thread
+   spins in user mode and another sleeps in FUTEX_WAIT on a word
+   nobody will ever wake.  exit() must stop both clones so that
+   the process ends with the first thread's status. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char stacks[2][4096] __attribute__ ((aligned (16)));
+static uint32_t word;
+static volatile int started;
+
+static void
+spinner (void *aux UNUSED)
+{
+  __atomic_fetch_add (&started, 1, __ATOMIC_SEQ_CST);
+  for (;;)
+    continue;
+}
+
+static void
+sleeper (void *aux UNUSED)
+{
+  __atomic_fetch_add (&started, 1, __ATOMIC_SEQ_CST);
+  for (;;)
+    futex (&word, FUTEX_WAIT, 0);
+}
+
+void
+test_main (void)
+{
+  struct timespec ts = {0, 50 * 1000 * 1000};
+
+  CHECK (clone (spinner, NULL, stacks[0] + sizeof stacks[0]) > 0,
+         "clone spinner");
+  CHECK (clone (sleeper, NULL, stacks[1] + sizeof stacks[1]) > 0,
+         "clone sleeper");
+
+  /* Give the sleeper time to block inside futex(). */
+  while (started < 2)
+    continue;
+  nanosleep (&ts);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clone-exit) begin
+(clone-exit) clone spinner
+(clone-exit) clone sleeper
+(clone-exit) end
+clone-exit: exit(0)
+EOF
+pass;
@@ -0,0 +1,40 @@
+/* Clone threads share the first thread's memory: each adds to
+   one counter, and join() returns each thread's exit status
+   only after it is done. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ITERS 1000
+
+static int counter;
+static char stacks[THREAD_CNT][4096] __attribute__ ((aligned (16)));
+
+static void
+add (void *aux)
+{
+  int id = (int) (intptr_t) aux;
+  int i;
+
+  for (i = 0; i < ITERS; i++)
+    __atomic_fetch_add (&counter, 1, __ATOMIC_RELAXED);
+  clone_exit (id + 10);
+}
+
+void
+test_main (void)
+{
+  pid_t tids[THREAD_CNT];
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((tids[i] = clone (add, (void *) (intptr_t) i,
+                             stacks[i] + sizeof stacks[i])) > 0,
+           "clone thread %d", i);
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK (join (tids[i]) == i + 10, "join thread %d", i);
+  CHECK (counter == THREAD_CNT * ITERS, "counter is %d", counter);
+  CHECK (join (tids[0]) == -1, "join thread 0 again");
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clone-join) begin
+(clone-join) clone thread 0
+(clone-join) clone thread 1
+(clone-join) clone thread 2
+(clone-join) clone thread 3
+(clone-join) join thread 0
+(clone-join) join thread 1
+(clone-join) join thread 2
+(clone-join) join thread 3
+(clone-join) counter is 4000
+(clone-join) join thread 0 again
+(clone-join) end
+clone-join: exit(0)
+EOF
+pass;
@@ -0,0 +1,47 @@
+/* Two clone threads and the first thread bump one counter under
+   a futex mutex.  Each thread sleeps while it holds the mutex now
+   and then, so the others spin out and sleep in FUTEX_WAIT and
+   must be woken by FUTEX_WAKE on unlock. */
+
+#include <mutex.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 2
+#define ITERS 200
+
+static struct mutex lock = MUTEX_INITIALIZER;
+static int counter;
+static char stacks[THREAD_CNT][4096] __attribute__ ((aligned (16)));
+
+static void
+bump (void *aux UNUSED)
+{
+  struct timespec ts = {0, 1000 * 1000};
+  int i;
+
+  for (i = 0; i < ITERS; i++)
+    {
+      mutex_lock (&lock);
+      if (i % 50 == 0)
+        nanosleep (&ts);
+      counter++;
+      mutex_unlock (&lock);
+    }
+}
+
+void
+test_main (void)
+{
+  pid_t tids[THREAD_CNT];
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((tids[i] = clone (bump, NULL, stacks[i] + sizeof stacks[i])) > 0,
+           "clone thread %d", i);
+  bump (NULL);
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK (join (tids[i]) == 0, "join thread %d", i);
+  CHECK (counter == (THREAD_CNT + 1) * ITERS, "counter is %d", counter);
+}
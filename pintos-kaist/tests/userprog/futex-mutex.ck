@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-mutex) begin
+(futex-mutex) clone thread 0
+(futex-mutex) clone thread 1
+(futex-mutex) join thread 0
+(futex-mutex) join thread 1
+(futex-mutex) counter is 600
+(futex-mutex) end
+futex-mutex: exit(0)
+EOF
+pass;
@@ -0,0 +1,28 @@
+/* Writes through a pipe and reads the bytes back out of the
+   other end, then closes the write end and checks that the
+   reader sees end of file instead of blocking. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  static const char msg_text[] = "pipe round trip";
+  char buf[sizeof msg_text];
+  int fds[2];
+
+  CHECK (pipe (fds) == 0, "pipe");
+  CHECK (write (fds[1], msg_text, sizeof msg_text) == sizeof msg_text,
+         "write %zu bytes", sizeof msg_text);
+  CHECK (read (fds[0], buf, sizeof buf) == sizeof buf,
+         "read %zu bytes", sizeof buf);
+  if (memcmp (buf, msg_text, sizeof buf))
+    fail ("read back different bytes");
+
+  close (fds[1]);
+  CHECK (read (fds[0], buf, sizeof buf) == 0, "read at end of file");
+  close (fds[0]);
+}
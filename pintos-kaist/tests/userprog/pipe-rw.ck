@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-rw) begin
+(pipe-rw) pipe
+(pipe-rw) write 16 bytes
+(pipe-rw) read 16 bytes
+(pipe-rw) read at end of file
+(pipe-rw) end
+pipe-rw: exit(0)
+EOF
+pass;
@@ -0,0 +1,62 @@
+/* Polls an empty pipe with a timeout of 0 and with a short
+   timeout, both of which must return 0, then blocks in poll()
+   until a clone thread writes to the pipe.  A negative fd in the
+   set is skipped every time. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char stack[4096] __attribute__ ((aligned (16)));
+static int write_fd;
+
+static void
+writer (void *aux UNUSED)
+{
+  struct timespec ts = {0, 50 * 1000 * 1000};
+
+  /* Give the first thread time to block inside poll(). */
+  nanosleep (&ts);
+  write (write_fd, "x", 1);
+  clone_exit (0);
+}
+
+void
+test_main (void)
+{
+  struct pollfd pfds[2];
+  int fds[2];
+  pid_t tid;
+  char c;
+
+  CHECK (pipe (fds) == 0, "pipe");
+  write_fd = fds[1];
+  pfds[0].fd = -1;
+  pfds[0].events = POLLIN;
+  pfds[0].revents = POLLIN;
+  pfds[1].fd = fds[0];
+  pfds[1].events = POLLIN;
+  pfds[1].revents = 0;
+
+  CHECK (poll (pfds, 2, 0) == 0, "poll with timeout 0");
+  if (pfds[0].revents != 0 || pfds[1].revents != 0)
+    fail ("revents %#x, %#x after timeout 0",
+          pfds[0].revents, pfds[1].revents);
+
+  CHECK (poll (pfds, 2, 50) == 0, "poll until timeout");
+  if (pfds[0].revents != 0 || pfds[1].revents != 0)
+    fail ("revents %#x, %#x after timeout",
+          pfds[0].revents, pfds[1].revents);
+
+  CHECK ((tid = clone (writer, NULL, stack + sizeof stack)) > 0,
+         "clone writer");
+  CHECK (poll (pfds, 2, -1) == 1, "poll until readable");
+  if (pfds[0].revents != 0 || pfds[1].revents != POLLIN)
+    fail ("revents %#x, %#x after write",
+          pfds[0].revents, pfds[1].revents);
+  CHECK (read (fds[0], &c, 1) == 1 && c == 'x', "read 1 byte");
+  CHECK (join (tid) == 0, "join writer");
+
+  close (fds[0]);
+  close (fds[1]);
+}
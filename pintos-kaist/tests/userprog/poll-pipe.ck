@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll-pipe) begin
+(poll-pipe) pipe
+(poll-pipe) poll with timeout 0
+(poll-pipe) poll until timeout
+(poll-pipe) clone writer
+(poll-pipe) poll until readable
+(poll-pipe) read 1 byte
+(poll-pipe) join writer
+(poll-pipe) end
+poll-pipe: exit(0)
+EOF
+pass;
@@ -0,0 +1,61 @@
+/* Submits ring requests whose pointers are bad: an OPEN whose
+   file name is a kernel address and a READ into a null buffer.
+   Each must fail only its own request with -1, and good requests
+   on the same ring must still work. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define RING_ADDR ((struct ring *) 0x10000000)
+
+/* Submits SQE alone and returns its result. */
+static int64_t
+submit (struct ring *r, const struct ring_sqe *sqe)
+{
+  struct ring_cqe *cqe;
+
+  r->sqes[r->sq_tail % RING_ENTRIES] = *sqe;
+  r->sq_tail++;
+  if (ring_enter (1, 1) != 1)
+    fail ("ring_enter did not take the request");
+  if (r->cq_head == r->cq_tail)
+    fail ("no completion");
+  cqe = &r->cqes[r->cq_head % RING_ENTRIES];
+  r->cq_head++;
+  if (cqe->user_data != sqe->user_data)
+    fail ("completion for the wrong request");
+  return cqe->res;
+}
+
+void
+test_main (void)
+{
+  struct ring *r = RING_ADDR;
+  char buf[16];
+  int64_t fd;
+
+  CHECK (ring_setup (r) == 0, "ring_setup");
+
+  CHECK (submit (r, &(struct ring_sqe) {.opcode = RING_OP_OPEN,
+                                        .addr = 0x8004000000,
+                                        .user_data = 1}) == -1,
+         "open with a kernel name pointer");
+
+  fd = submit (r, &(struct ring_sqe) {.opcode = RING_OP_OPEN,
+                                      .addr = (uint64_t) "sample.txt",
+                                      .user_data = 2});
+  CHECK (fd > 1, "open \"sample.txt\"");
+
+  CHECK (submit (r, &(struct ring_sqe) {.opcode = RING_OP_READ, .fd = fd,
+                                        .addr = 0, .len = sizeof buf,
+                                        .off = 0, .user_data = 3}) == -1,
+         "read into a null buffer");
+
+  CHECK (submit (r, &(struct ring_sqe) {.opcode = RING_OP_READ, .fd = fd,
+                                        .addr = (uint64_t) buf,
+                                        .len = sizeof buf, .off = 0,
+                                        .user_data = 4}) == sizeof buf,
+         "read into a good buffer");
+  close (fd);
+}
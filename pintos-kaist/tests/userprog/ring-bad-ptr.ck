@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-ptr) begin
+(ring-bad-ptr) ring_setup
+(ring-bad-ptr) open with a kernel name pointer
+(ring-bad-ptr) open "sample.txt"
+(ring-bad-ptr) read into a null buffer
+(ring-bad-ptr) read into a good buffer
+(ring-bad-ptr) end
+ring-bad-ptr: exit(0)
+EOF
+pass;
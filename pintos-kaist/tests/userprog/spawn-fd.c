@@ -0,0 +1,51 @@
+/* Spawns child-spawn with a pipe's read end at the child's fd 3
+   and another pipe's write end at its fd 2, at fd numbers that
+   differ from the parent's.  The write end of the first pipe is
+   not passed on, so the child must see end of file once the
+   parent closes it.  Also checks that spawning a missing file
+   fails and that wait() returns the spawned child's status. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  static const char msg_text[] = "through two pipes";
+  char buf[sizeof msg_text];
+  int to_child[2], from_child[2];
+  int fd_map[5];
+  int status;
+  pid_t pid;
+  int n;
+
+  CHECK (spawn ("no-such-file", NULL, 0) == PID_ERROR,
+         "spawn \"no-such-file\"");
+
+  CHECK (pipe (to_child) == 0, "pipe to child");
+  CHECK (pipe (from_child) == 0, "pipe from child");
+  fd_map[0] = 0;
+  fd_map[1] = 1;
+  fd_map[2] = from_child[1];
+  fd_map[3] = to_child[0];
+  fd_map[4] = -1;
+  CHECK ((pid = spawn ("child-spawn", fd_map, 5)) != PID_ERROR,
+         "spawn \"child-spawn\"");
+
+  /* Only the child may hold these ends now. */
+  close (to_child[0]);
+  close (from_child[1]);
+  if (write (to_child[1], msg_text, sizeof msg_text) != sizeof msg_text)
+    fail ("write to child failed");
+  close (to_child[1]);
+  n = read (from_child[0], buf, sizeof buf);
+  status = wait (pid);
+
+  CHECK (n == sizeof msg_text && !memcmp (buf, msg_text, sizeof buf),
+         "read back %d bytes", n);
+  CHECK (read (from_child[0], buf, sizeof buf) == 0, "read at end of file");
+  CHECK (status == sizeof msg_text, "wait returns %d", status);
+  close (from_child[0]);
+}
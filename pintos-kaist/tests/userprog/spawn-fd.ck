@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-fd) begin
+(spawn-fd) spawn "no-such-file"
+load: no-such-file: open failed
+no-such-file: exit(-1)
+(spawn-fd) pipe to child
+(spawn-fd) pipe from child
+(spawn-fd) spawn "child-spawn"
+child-spawn: exit(18)
+(spawn-fd) read back 18 bytes
+(spawn-fd) read at end of file
+(spawn-fd) wait returns 18
+(spawn-fd) end
+spawn-fd: exit(0)
+EOF
+pass;
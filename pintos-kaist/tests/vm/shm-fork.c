@@ -0,0 +1,104 @@
+/* A forked child maps the parent's shared memory segment by name
+   at a different address and produces numbers into a ring in it,
+   while the parent consumes them through its own mapping.  The
+   two sides sleep on futexes in the segment.  The parent removes
+   the name while both still map the segment, and mapping the
+   name again afterward must give a fresh, zeroed segment. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define NAME "shm-fork"
+#define PARENT_ADDR ((void *) 0x10000000)
+#define CHILD_ADDR ((void *) 0x20000000)
+#define SLOT_CNT 16
+#define ITEM_CNT 1000
+
+struct item_ring
+  {
+    uint32_t ready;             /* Set once the child has mapped NAME. */
+    uint32_t head;              /* Items produced. */
+    uint32_t tail;              /* Items consumed. */
+    uint32_t slots[SLOT_CNT];
+  };
+
+static uint32_t
+load (uint32_t *p)
+{
+  return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+}
+
+static void
+store (uint32_t *p, uint32_t v)
+{
+  __atomic_store_n (p, v, __ATOMIC_RELEASE);
+}
+
+static void
+produce (struct item_ring *r)
+{
+  uint32_t i, tail;
+
+  for (i = 0; i < ITEM_CNT; i++)
+    {
+      while (i - (tail = load (&r->tail)) == SLOT_CNT)
+        futex (&r->tail, FUTEX_WAIT, tail);
+      r->slots[i % SLOT_CNT] = i * 3 + 1;
+      store (&r->head, i + 1);
+      futex (&r->head, FUTEX_WAKE, 1);
+    }
+}
+
+static void
+consume (struct item_ring *r)
+{
+  uint32_t i, head;
+
+  for (i = 0; i < ITEM_CNT; i++)
+    {
+      while ((head = load (&r->head)) == i)
+        futex (&r->head, FUTEX_WAIT, head);
+      if (r->slots[i % SLOT_CNT] != i * 3 + 1)
+        fail ("item %u is %u", i, r->slots[i % SLOT_CNT]);
+      store (&r->tail, i + 1);
+      futex (&r->tail, FUTEX_WAKE, 1);
+    }
+}
+
+void
+test_main (void)
+{
+  struct item_ring *r;
+  pid_t pid;
+
+  CHECK ((r = shm_map (NAME, sizeof *r, PARENT_ADDR, true)) == PARENT_ADDR,
+         "map \"%s\"", NAME);
+  CHECK ((pid = fork ("child")) >= 0, "fork");
+  if (pid == 0)
+    {
+      struct item_ring *cr = shm_map (NAME, sizeof *cr, CHILD_ADDR, true);
+
+      if (cr != CHILD_ADDR)
+        fail ("child could not map \"%s\"", NAME);
+      store (&cr->ready, 1);
+      futex (&cr->ready, FUTEX_WAKE, 1);
+      produce (cr);
+      exit (0);
+    }
+
+  while (load (&r->ready) == 0)
+    futex (&r->ready, FUTEX_WAIT, 0);
+  CHECK (shm_unlink (NAME), "unlink \"%s\" while mapped", NAME);
+  consume (r);
+  msg ("child exit status is %d", wait (pid));
+
+  munmap (r);
+  CHECK ((r = shm_map (NAME, sizeof *r, PARENT_ADDR, true)) == PARENT_ADDR,
+         "map \"%s\" again", NAME);
+  if (r->ready != 0 || r->head != 0 || r->tail != 0)
+    fail ("new segment still holds the old contents");
+  CHECK (shm_unlink (NAME), "unlink \"%s\"", NAME);
+  munmap (r);
+}
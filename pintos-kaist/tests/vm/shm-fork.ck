@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shm-fork) begin
+(shm-fork) map "shm-fork"
+(shm-fork) fork
+(shm-fork) unlink "shm-fork" while mapped
+child: exit(0)
+(shm-fork) child exit status is 0
+(shm-fork) map "shm-fork" again
+(shm-fork) unlink "shm-fork"
+(shm-fork) end
+shm-fork: exit(0)
+EOF
+pass;
@@ -0,0 +1,119 @@
+/* Maps a shared memory segment in a parent and a forked child,
+   then has the parent touch far more anonymous memory than the
+   machine has, so that the segment's frames are swapped out from
+   under both mappings.  The parent reads the segment back, writes
+   new contents, and the child must see them through its own
+   mapping. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define NAME "shm-swap"
+#define PARENT_ADDR ((uint8_t *) 0x10000000)
+#define CHILD_ADDR ((uint8_t *) 0x20000000)
+#define PAGE_SIZE 4096
+#define SHM_PAGES 8
+#define SHM_SIZE (SHM_PAGES * PAGE_SIZE)
+#define CHUNK_SIZE (20 * 1024 * 1024)
+
+static uint8_t big_chunk[CHUNK_SIZE];
+
+/* Futex words in the last page of the segment. */
+struct sync
+  {
+    uint32_t ready;             /* Set once the child has mapped NAME. */
+    uint32_t rewritten;         /* Set once the parent wrote new contents. */
+  };
+
+static struct sync *
+sync_of (uint8_t *base)
+{
+  return (struct sync *) (base + SHM_SIZE - sizeof (struct sync));
+}
+
+/* Checks that the first byte of every page but the last in BASE
+   holds that page's number XORed with KEY. */
+static bool
+check_pattern (uint8_t *base, uint8_t key)
+{
+  size_t i;
+
+  for (i = 0; i < SHM_PAGES - 1; i++)
+    if (base[i * PAGE_SIZE] != (uint8_t) (i ^ key))
+      return false;
+  return true;
+}
+
+static void
+write_pattern (uint8_t *base, uint8_t key)
+{
+  size_t i;
+
+  for (i = 0; i < SHM_PAGES - 1; i++)
+    base[i * PAGE_SIZE] = (uint8_t) (i ^ key);
+}
+
+static void
+child (void)
+{
+  uint8_t *base = shm_map (NAME, SHM_SIZE, CHILD_ADDR, true);
+  struct sync *s;
+
+  if (base != CHILD_ADDR)
+    fail ("child could not map \"%s\"", NAME);
+  if (!check_pattern (base, 0))
+    fail ("child sees the wrong contents before the swap");
+  s = sync_of (base);
+  __atomic_store_n (&s->ready, 1, __ATOMIC_RELEASE);
+  futex (&s->ready, FUTEX_WAKE, 1);
+
+  while (__atomic_load_n (&s->rewritten, __ATOMIC_ACQUIRE) == 0)
+    futex (&s->rewritten, FUTEX_WAIT, 0);
+  if (!check_pattern (base, 0x5a))
+    fail ("child sees the wrong contents after the swap");
+  exit (0);
+}
+
+void
+test_main (void)
+{
+  uint8_t *base;
+  struct sync *s;
+  struct rusage before, after;
+  size_t i;
+  pid_t pid;
+
+  CHECK ((base = shm_map (NAME, SHM_SIZE, PARENT_ADDR, true)) == PARENT_ADDR,
+         "map \"%s\"", NAME);
+  write_pattern (base, 0);
+  CHECK ((pid = fork ("child")) >= 0, "fork");
+  if (pid == 0)
+    child ();
+
+  s = sync_of (base);
+  while (__atomic_load_n (&s->ready, __ATOMIC_ACQUIRE) == 0)
+    futex (&s->ready, FUTEX_WAIT, 0);
+
+  msg ("fill memory");
+  for (i = 0; i < CHUNK_SIZE; i += PAGE_SIZE)
+    big_chunk[i] = (uint8_t) (i / PAGE_SIZE);
+  for (i = 0; i < CHUNK_SIZE; i += PAGE_SIZE)
+    if (big_chunk[i] != (uint8_t) (i / PAGE_SIZE))
+      fail ("anonymous page %zu is inconsistent", i / PAGE_SIZE);
+
+  getrusage (&before);
+  CHECK (check_pattern (base, 0), "check contents after the swap");
+  getrusage (&after);
+  if (after.swap_ins == before.swap_ins)
+    fail ("the segment was never swapped out");
+
+  write_pattern (base, 0x5a);
+  __atomic_store_n (&s->rewritten, 1, __ATOMIC_RELEASE);
+  futex (&s->rewritten, FUTEX_WAKE, 1);
+  msg ("child exit status is %d", wait (pid));
+
+  CHECK (shm_unlink (NAME), "unlink \"%s\"", NAME);
+  munmap (base);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shm-swap) begin
+(shm-swap) map "shm-swap"
+(shm-swap) fork
+(shm-swap) fill memory
+(shm-swap) check contents after the swap
+child: exit(0)
+(shm-swap) child exit status is 0
+(shm-swap) unlink "shm-swap"
+(shm-swap) end
+shm-swap: exit(0)
+EOF
+pass;
@@ -20,6 +20,8 @@
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/rcu.h"
+#include "threads/smp.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -72,12 +74,14 @@ int main(void)
 	/* 1. BSS 영역 초기화 (.bss에 있는 전역 변수들을 0으로 설정) */
 	bss_init();
 
-	/* 2. 커맨드라인 문자열을 argv 배열로 파싱하고 옵션을 처리 */
+	/* 2. 스레드 시스템 초기화 (lock, ready list 등). printf()도
+	   this_cpu()를 읽으므로 가장 먼저 합니다 */
+	thread_init();
+
+	/* 3. 커맨드라인 문자열을 argv 배열로 파싱하고 옵션을 처리 */
 	argv = read_command_line();
 	argv = parse_options(argv);
 
-	/* 3. 스레드 시스템 초기화 (lock, ready list 등) */
-	thread_init();
 	/* 4. 콘솔 초기화 (동기화된 printf 지원용) */
 	console_init();
 
@@ -104,8 +108,10 @@ int main(void)
 
 	/* 8. 커널 스케줄러 시작 + 인터럽트 허용 */
 	thread_start();		 // 초기 thread → idle thread로 교체, 인터럽트 on
+	rcu_init();			 // call_rcu 콜백 스레드 시작
 	serial_init_queue(); // 시리얼 포트 초기화 (test용)
 	timer_calibrate();	 // 타이머 정확도 보정
+	smp_init();			 // 나머지 CPU 깨우기
 
 #ifdef FILESYS
 	/* 9. 파일 시스템 초기화 */
@@ -237,6 +243,18 @@ parse_options(char **argv)
 			user_page_limit = atoi(value);
 		else if (!strcmp(name, "-threads-tests"))
 			thread_tests = true;
+#endif
+#ifdef VM
+		else if (!strcmp(name, "-swap-disk"))
+		{
+			if (!swap_add_disk_option(value))
+				PANIC("bad -swap-disk value `%s'", value);
+		}
+		else if (!strcmp(name, "-swap-file"))
+		{
+			if (!swap_add_file_option(value))
+				PANIC("bad -swap-file value `%s'", value);
+		}
 #endif
 		else
 			PANIC("unknown option `%s' (use -h for help)", name);
@@ -346,6 +364,10 @@ usage(void)
 		   "  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 		   "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+		   "  -swap-disk=hdC:D[,PRIO]  Swap to disk hdC:D with priority PRIO.\n"
+		   "  -swap-file=NAME:PAGES[,PRIO]  Swap to a PAGES-page file NAME.\n"
 #endif
 	);
 	power_off();
@@ -3,16 +3,20 @@
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
+#include "threads/smp.h"
 #include "threads/vaddr.h"
+#include "devices/lapic.h"
 #include "devices/timer.h"
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/gdt.h"
+#include "userprog/process.h"
 #endif
 
 /* Number of x86_64 interrupts. */
@@ -99,9 +103,8 @@ static const char *intr_names[INTR_CNT];
    pre-empted.  Handlers for external interrupts also may not
    sleep, although they may invoke intr_yield_on_return() to
    request that a new process be scheduled just before the
-   interrupt returns. */
-static bool in_external_intr;   /* Are we processing an external interrupt? */
-static bool yield_on_return;    /* Should we yield on interrupt return? */
+   interrupt returns.  Both flags live in struct cpu, since every
+   CPU handles its own interrupts. */
 
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
@@ -203,6 +206,23 @@ intr_init (void) {
 	intr_names[19] = "#XF SIMD Floating-Point Exception";
 }
 
+/* Loads the IDT that intr_init() built, and this CPU's TSS, on an
+   application processor. */
+void
+intr_init_ap (void) {
+#ifdef USERPROG
+	ltr (SEL_TSS);
+#endif
+	lidt(&idt_desc);
+}
+
+/* Returns true if VEC_NO is delivered by the PICs or the local
+   APIC rather than raised by the CPU or an `int' instruction. */
+static bool
+is_external (uint64_t vec_no) {
+	return (vec_no >= 0x20 && vec_no < 0x30) || vec_no >= LAPIC_TIMER_VEC;
+}
+
 /* Registers interrupt VEC_NO to invoke HANDLER with descriptor
    privilege level DPL.  Names the interrupt NAME for debugging
    purposes.  The interrupt handler will be invoked with
@@ -227,7 +247,7 @@ register_handler (uint8_t vec_no, int dpl, enum intr_level level,
 void
 intr_register_ext (uint8_t vec_no, intr_handler_func *handler,
 		const char *name) {
-	ASSERT (vec_no >= 0x20 && vec_no <= 0x2f);
+	ASSERT (is_external (vec_no));
 	register_handler (vec_no, 0, INTR_OFF, handler, name);
 }
 
@@ -248,7 +268,7 @@ void
 intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
 		intr_handler_func *handler, const char *name)
 {
-	ASSERT (vec_no < 0x20 || vec_no > 0x2f);
+	ASSERT (!is_external (vec_no));
 	register_handler (vec_no, dpl, level, handler, name);
 }
 
@@ -256,7 +276,7 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
    and false at all other times. */
 bool
 intr_context (void) {
-	return in_external_intr;
+	return this_cpu ()->in_external_intr;
 }
 
 /* During processing of an external interrupt, directs the
@@ -266,7 +286,7 @@ intr_context (void) {
 void
 intr_yield_on_return (void) {
 	ASSERT (intr_context ());
-	yield_on_return = true;
+	this_cpu ()->yield_on_return = true;
 }
 
 /* 8259A Programmable Interrupt Controller. */
@@ -329,20 +349,40 @@ pic_end_of_interrupt (int irq) {
 	FRAME은 인터럽트와 인터럽트된 스레드의 레지스터를 설명합니다. */
 void
 intr_handler (struct intr_frame *frame) {
-	bool external;
+	bool external, locked;
 	intr_handler_func *handler;
+	enum intr_level old_level;
+
+	/* TLB를 비워 달라는 IPI는 빅 커널 락을 쥔 CPU가 보내고 기다리는
+	   중이므로 락 없이 바로 처리합니다. 스퓨리어스 인터럽트는 EOI도
+	   보내지 않습니다. */
+	if (frame->vec_no == IPI_TLB_VEC) {
+		tlb_flush_local ();
+		lapic_eoi ();
+		return;
+	}
+	if (frame->vec_no == LAPIC_SPURIOUS_VEC)
+		return;
+
+	/* 유저 모드나 idle의 hlt에서 들어왔다면 이 CPU는 빅 커널 락을
+	   쥐고 있지 않습니다. 잡았다가 돌아가기 직전에 놓습니다. */
+	old_level = intr_disable ();
+	locked = !bkl_held ();
+	if (locked)
+		bkl_acquire ();
+	intr_set_level (old_level);
 
 	/* 외부 인터럽트는 특별합니다.
 	   우리는 한 번에 하나만 처리합니다 (따라서 인터럽트는 꺼져 있어야 합니다)
 	   그리고 PIC에서 이를 확인해야 합니다 (아래 참조).
 	   외부 인터럽트 핸들러는 대기 상태가 될 수 없습니다. */
-	external = frame->vec_no >= 0x20 && frame->vec_no < 0x30;
+	external = is_external (frame->vec_no);
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
 		ASSERT (!intr_context ());
 
-		in_external_intr = true;
-		yield_on_return = false;
+		this_cpu ()->in_external_intr = true;
+		this_cpu ()->yield_on_return = false;
 	}
 
 	/* 인터럽트의 핸들러를 호출합니다. */
@@ -365,12 +405,32 @@ intr_handler (struct intr_frame *frame) {
 		ASSERT (intr_get_level () == INTR_OFF);
 		ASSERT (intr_context ());
 
-		in_external_intr = false;
-		pic_end_of_interrupt (frame->vec_no);
+		this_cpu ()->in_external_intr = false;
+		if (frame->vec_no < 0x30)
+			pic_end_of_interrupt (frame->vec_no);
+		else
+			lapic_eoi ();
 
-		if (yield_on_return)
+		if (this_cpu ()->yield_on_return)
 			thread_yield ();
 	}
+
+#ifdef USERPROG
+	/* 유저 모드에서 돌던 스레드의 그룹이 그사이 끝나기 시작했으면
+	   돌아가지 않고 끝냅니다. 빅 커널 락은 이 CPU에 남아 다음 스레드가
+	   이어 쥡니다. */
+	if ((frame->cs & 3) == 3 && process_dying ()) {
+		intr_enable ();
+		process_die ();
+	}
+#endif
+
+	/* 양보했다가 다른 CPU에서 돌아왔더라도 그 CPU도 락을 쥐고
+	   있으므로, 들어올 때 잡았다면 그대로 놓으면 됩니다. */
+	if (locked) {
+		intr_disable ();
+		bkl_release ();
+	}
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
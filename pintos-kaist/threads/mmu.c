@@ -6,6 +6,8 @@
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
+#include "threads/cpu.h"
+#include "threads/smp.h"
 #include "intrinsic.h"
 
 static uint64_t *
@@ -239,9 +241,20 @@ void pml4_destroy(uint64_t *pml4)
  * register. */
 void pml4_activate(uint64_t *pml4)
 {
+	this_cpu()->pml4 = pml4;
 	lcr3(vtop(pml4 ? pml4 : base_pml4));
 }
 
+/* PML4에서 VA의 PTE를 바꾼 뒤 부릅니다. PML4를 올려 둔 모든 CPU의
+ * TLB에서 VA를 지웁니다. */
+static void
+tlb_flush_page(uint64_t *pml4, const void *va)
+{
+	if (rcr3() == vtop(pml4))
+		invlpg((uint64_t)va);
+	tlb_shootdown(pml4);
+}
+
 /* pml4에서 사용자 가상 주소 UADDR에 해당하는 물리 주소를 조회합니다.
  * 해당 물리 주소에 대응하는 커널 가상 주소를 반환하며,
  * UADDR가 매핑되어 있지 않으면 null 포인터를 반환합니다. */
@@ -290,8 +303,7 @@ void pml4_clear_page(uint64_t *pml4, void *upage)
 	if (pte != NULL && (*pte & PTE_P) != 0)
 	{
 		*pte &= ~PTE_P;
-		if (rcr3() == vtop(pml4))
-			invlpg((uint64_t)upage);
+		tlb_flush_page(pml4, upage);
 	}
 }
 
@@ -316,8 +328,7 @@ void pml4_set_dirty(uint64_t *pml4, const void *vpage, bool dirty)
 		else
 			*pte &= ~(uint32_t)PTE_D;
 
-		if (rcr3() == vtop(pml4))
-			invlpg((uint64_t)vpage);
+		tlb_flush_page(pml4, vpage);
 	}
 }
 
@@ -342,6 +353,9 @@ void pml4_set_accessed(uint64_t *pml4, const void *vpage, bool accessed)
 		else
 			*pte &= ~(uint32_t)PTE_A;
 
+		/* accessed 비트는 교체 정책의 힌트일 뿐이라, 다른 CPU의 TLB에
+		   남은 항목이 비트를 다시 켜지 않아도 해가 없으므로 이 CPU에서만
+		   지웁니다 */
 		if (rcr3() == vtop(pml4))
 			invlpg((uint64_t)vpage);
 	}
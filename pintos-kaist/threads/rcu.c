@@ -0,0 +1,258 @@
+#include "threads/rcu.h"
+#include <debug.h>
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* 유예 기간 번호. gp_cur > gp_done이면 gp_cur번 유예 기간이 진행
+   중이고, 같으면 진행 중인 유예 기간이 없습니다. 둘 다 인터럽트를
+   끄고 바꿉니다. */
+static uint64_t gp_cur;
+static uint64_t gp_done;
+
+/* call_rcu()로 들어온 콜백. gp가 줄어들지 않는 순서로 쌓입니다. */
+static struct list pending;
+
+/* 콜백을 부르는 커널 스레드와, 그 스레드가 할 일이 없어 잠들었는지. */
+static struct thread *rcu_thread;
+static bool rcu_sleeping;
+
+static void rcu_worker(void *aux);
+static void rcu_wake_worker(void);
+
+/* 대기 목록을 만들고 콜백을 부를 커널 스레드를 띄웁니다. thread_start()
+   뒤에 불러야 합니다. */
+void rcu_init(void)
+{
+	list_init(&pending);
+	thread_create("rcu", PRI_DEFAULT, rcu_worker, NULL);
+}
+
+/* 읽기 구간을 엽니다. 겹쳐 열 수 있습니다. 구간 안에서는 잠들면
+   안 되며, 양보는 구간이 끝날 때까지 미뤄집니다. */
+void rcu_read_lock(void)
+{
+	thread_current()->rcu_nesting++;
+	barrier();
+}
+
+/* 읽기 구간을 닫습니다. 구간 안에서 미뤄 둔 양보가 있으면 지금 합니다. */
+void rcu_read_unlock(void)
+{
+	struct thread *t = thread_current();
+
+	barrier();
+	ASSERT(t->rcu_nesting > 0);
+	if (--t->rcu_nesting == 0 && t->rcu_resched && !intr_context())
+	{
+		t->rcu_resched = false;
+		thread_yield();
+	}
+}
+
+/* 지금 CPU가 읽기 구간 밖에 있음을 알립니다. schedule()과, 유저 모드에서
+   들어온 타이머 틱이 인터럽트를 끈 채로 부릅니다. 모든 CPU가 알려 오면
+   유예 기간을 끝내고 콜백 스레드를 깨웁니다. */
+void rcu_qs(void)
+{
+	struct cpu *cpu = this_cpu();
+	int i;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (gp_done == gp_cur)
+		return;
+
+	cpu->rcu_gp_seen = gp_cur;
+	for (i = 0; i < cpu_cnt; i++)
+		if (cpus[i].rcu_gp_seen != gp_cur)
+			return;
+
+	gp_done = gp_cur;
+
+	/* 진행 중에 들어와 다음 유예 기간을 기다리던 콜백이 있으면 바로
+	   시작합니다 */
+	if (!list_empty(&pending) &&
+		list_entry(list_back(&pending), struct rcu_head, elem)->gp > gp_done)
+		gp_cur++;
+
+	rcu_wake_worker();
+}
+
+/* 지금 진행 중인 읽기 구간이 모두 끝난 뒤 FUNC(HEAD)를 부릅니다. FUNC는
+   "rcu" 커널 스레드에서 불리므로 잠들 수 있습니다. 인터럽트 핸들러와
+   읽기 구간 안에서도 부를 수 있습니다. */
+void call_rcu(struct rcu_head *head, rcu_callback_func *func)
+{
+	enum intr_level old_level;
+
+	ASSERT(head != NULL && func != NULL);
+
+	old_level = intr_disable();
+	head->func = func;
+
+	/* 진행 중인 유예 기간은 이 호출 전에 시작했으므로 그다음 것을
+	   기다립니다 */
+	if (gp_done == gp_cur)
+		head->gp = ++gp_cur;
+	else
+		head->gp = gp_cur + 1;
+	list_push_back(&pending, &head->elem);
+	intr_set_level(old_level);
+}
+
+struct rcu_sync
+{
+	struct rcu_head head;
+	struct semaphore done;
+};
+
+static void
+rcu_sync_done(struct rcu_head *head)
+{
+	sema_up(&list_entry(&head->elem, struct rcu_sync, head.elem)->done);
+}
+
+/* 지금 진행 중인 읽기 구간이 모두 끝날 때까지 잠듭니다. 읽기 구간
+   안에서 부르면 안 됩니다. */
+void synchronize_rcu(void)
+{
+	struct rcu_sync sync;
+
+	ASSERT(!intr_context());
+	ASSERT(thread_current()->rcu_nesting == 0);
+
+	sema_init(&sync.done, 0);
+	call_rcu(&sync.head, rcu_sync_done);
+	sema_down(&sync.done);
+}
+
+struct rcu_free_node
+{
+	struct rcu_head head;
+	void *ptr;
+};
+
+static void
+rcu_free_done(struct rcu_head *head)
+{
+	struct rcu_free_node *node = list_entry(&head->elem, struct rcu_free_node, head.elem);
+
+	free(node->ptr);
+	free(node);
+}
+
+/* malloc()으로 받은 P를 유예 기간이 지난 뒤 해제합니다. 기록할 메모리가
+   모자라면 그 자리에서 기다렸다가 해제하므로 잠들 수 있습니다. */
+void rcu_free(void *p)
+{
+	struct rcu_free_node *node;
+
+	if (p == NULL)
+		return;
+
+	node = malloc(sizeof *node);
+	if (node == NULL)
+	{
+		synchronize_rcu();
+		free(p);
+		return;
+	}
+	node->ptr = p;
+	call_rcu(&node->head, rcu_free_done);
+}
+
+/* 유예 기간이 끝난 콜백을 꺼내 부르고, 없으면 rcu_qs()가 깨울 때까지
+   잠듭니다. */
+static void
+rcu_worker(void *aux UNUSED)
+{
+	rcu_thread = thread_current();
+
+	for (;;)
+	{
+		struct list done;
+		enum intr_level old_level;
+
+		list_init(&done);
+		old_level = intr_disable();
+		while (!list_empty(&pending) &&
+			   list_entry(list_front(&pending), struct rcu_head, elem)->gp <= gp_done)
+			list_push_back(&done, list_pop_front(&pending));
+		if (list_empty(&done))
+		{
+			rcu_sleeping = true;
+			thread_block();
+		}
+		intr_set_level(old_level);
+
+		while (!list_empty(&done))
+		{
+			struct rcu_head *head = list_entry(list_pop_front(&done), struct rcu_head, elem);
+			head->func(head);
+		}
+	}
+}
+
+/* 잠든 콜백 스레드를 레디 큐에 넣습니다. schedule() 안에서도 불리므로
+   양보하지 않습니다. */
+static void
+rcu_wake_worker(void)
+{
+	if (rcu_sleeping)
+	{
+		rcu_sleeping = false;
+		thread_unblock(rcu_thread);
+	}
+}
+
+/* LIST의 첫 원소를 읽습니다. 비어 있으면 list_end(LIST)입니다. */
+struct list_elem *
+list_begin_rcu(struct list *list)
+{
+	return rcu_dereference(list->head.next);
+}
+
+/* ELEM 다음 원소를 읽습니다. */
+struct list_elem *
+list_next_rcu(struct list_elem *elem)
+{
+	return rcu_dereference(elem->next);
+}
+
+/* ELEM을 BEFORE 바로 앞에 넣습니다. ELEM의 링크를 먼저 채운 뒤 앞
+   원소의 next로 게시하므로, 읽는 쪽은 완성된 ELEM만 봅니다. */
+void list_insert_rcu(struct list_elem *before, struct list_elem *elem)
+{
+	struct list_elem *prev = before->prev;
+
+	elem->prev = prev;
+	elem->next = before;
+	rcu_assign_pointer(prev->next, elem);
+	before->prev = elem;
+}
+
+/* ELEM을 LIST 끝에 넣습니다. */
+void list_push_back_rcu(struct list *list, struct list_elem *elem)
+{
+	list_insert_rcu(list_end(list), elem);
+}
+
+/* ELEM을 LIST 앞에 넣습니다. */
+void list_push_front_rcu(struct list *list, struct list_elem *elem)
+{
+	list_insert_rcu(list_begin(list), elem);
+}
+
+/* ELEM을 목록에서 뗍니다. ELEM의 링크는 그대로 두므로 ELEM에 서 있던
+   읽는 쪽은 계속 앞으로 나아갈 수 있습니다. */
+void list_remove_rcu(struct list_elem *elem)
+{
+	struct list_elem *prev = elem->prev;
+	struct list_elem *next = elem->next;
+
+	rcu_assign_pointer(prev->next, next);
+	next->prev = prev;
+}
@@ -0,0 +1,389 @@
+#include "threads/smp.h"
+#include <debug.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/lapic.h"
+#include "devices/timer.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/loader.h"
+#include "threads/mmu.h"
+#include "threads/pte.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+#ifdef USERPROG
+#include "userprog/gdt.h"
+#include "userprog/syscall.h"
+#include "userprog/tss.h"
+#endif
+
+/* MP floating pointer structure.  See [MP] section 4.1. */
+struct mp_fps
+{
+	char signature[4];	 /* "_MP_" */
+	uint32_t config;	 /* Physical address of the config table. */
+	uint8_t length;		 /* In 16-byte units. */
+	uint8_t spec_rev;	 /* MP spec revision. */
+	uint8_t checksum;	 /* All bytes add up to 0. */
+	uint8_t type;		 /* Default configuration, 0 if none. */
+	uint8_t features[4]; /* Feature bytes 2...5. */
+} __attribute__((packed));
+
+/* MP configuration table header.  See [MP] section 4.2. */
+struct mp_config
+{
+	char signature[4];	  /* "PCMP" */
+	uint16_t length;	  /* Base table length, header included. */
+	uint8_t spec_rev;	  /* MP spec revision. */
+	uint8_t checksum;	  /* Base table bytes add up to 0. */
+	char oem_id[8];		  /* OEM name. */
+	char product_id[12];  /* Product name. */
+	uint32_t oem_table;	  /* Physical address of OEM table. */
+	uint16_t oem_length;  /* Size of OEM table. */
+	uint16_t entry_cnt;	  /* Number of entries after the header. */
+	uint32_t lapic_addr;  /* Physical address of the local APICs. */
+	uint16_t ext_length;  /* Extended table length. */
+	uint8_t ext_checksum; /* Extended table checksum. */
+	uint8_t reserved;
+} __attribute__((packed));
+
+/* Processor entry.  See [MP] section 4.3.1.  The other entry
+   types are all 8 bytes long. */
+struct mp_processor
+{
+	uint8_t type;		  /* MP_PROCESSOR. */
+	uint8_t apic_id;	  /* Local APIC ID. */
+	uint8_t apic_version; /* Local APIC version. */
+	uint8_t flags;		  /* MP_CPU_* flags. */
+	uint8_t signature[4]; /* CPU signature. */
+	uint32_t features;	  /* CPUID feature flags. */
+	uint8_t reserved[8];
+} __attribute__((packed));
+
+#define MP_PROCESSOR 0	  /* Entry type of a processor. */
+#define MP_ENTRY_LEN 8	  /* Length of every other entry type. */
+#define MP_CPU_ENABLED 0x1 /* The processor is usable. */
+#define MP_CPU_BSP 0x2	  /* The bootstrap processor. */
+
+/* How long to wait for an AP to report in, in timer ticks.  The
+   wait must block, not spin, so that the idle thread lets go of
+   the big kernel lock the AP needs. */
+#define AP_START_TIMEOUT (TIMER_FREQ / 10)
+
+/* The big kernel lock.  The BSP holds it from boot on. */
+static struct spinlock kernel_lock = {1};
+
+/* Startup code copied to AP_START_BASE, and the 32-bit slot in it
+   that receives the physical address of the boot page table.
+   See threads/ap-start.S. */
+extern char ap_start[], ap_start_pml4[], ap_start_end[];
+extern char boot_pml4e[];
+
+/* Top of the stack the AP being started runs ap_main() on, read
+   by ap-start.S. */
+uint8_t *ap_boot_stack;
+
+/* Set by the AP being started once it has joined the scheduler. */
+static volatile bool ap_started;
+
+void ap_main (void) NO_RETURN;
+
+static struct mp_config *mp_find_config (void);
+static bool start_ap (uint8_t apic_id);
+static intr_handler_func reschedule_interrupt;
+
+/* Starts every enabled processor listed in the MP configuration
+   table.  Does nothing on a machine without one.  Must be called
+   with interrupts on, after timer_calibrate(). */
+void
+smp_init (void)
+{
+	struct mp_config *conf;
+	enum intr_level old_level;
+	uint8_t *p, *end;
+	int i;
+
+	ASSERT (intr_get_level () == INTR_ON);
+
+	conf = mp_find_config ();
+	if (conf == NULL)
+		return;
+
+	lapic_map (conf->lapic_addr);
+	old_level = intr_disable ();
+	lapic_init (true);
+	cpus[0].apic_id = lapic_id ();
+	intr_set_level (old_level);
+	lapic_calibrate ();
+	intr_register_ext (IPI_RESCHEDULE_VEC, reschedule_interrupt,
+					   "IPI Reschedule");
+
+	/* Copy the startup code below 1 MB, where an AP in real mode
+	   can reach it, and tell it which page table to enable. */
+	memcpy (ptov (AP_START_BASE), ap_start, ap_start_end - ap_start);
+	*(uint32_t *) ((uint8_t *) ptov (AP_START_BASE) + (ap_start_pml4 - ap_start)) =
+		vtop (boot_pml4e);
+
+	p = (uint8_t *) (conf + 1);
+	end = (uint8_t *) conf + conf->length;
+	for (i = 0; i < conf->entry_cnt && p < end; i++)
+	{
+		if (*p == MP_PROCESSOR)
+		{
+			struct mp_processor *proc = (struct mp_processor *) p;
+
+			if ((proc->flags & MP_CPU_ENABLED) && !(proc->flags & MP_CPU_BSP) &&
+				proc->apic_id != cpus[0].apic_id && !start_ap (proc->apic_id))
+				break;
+			p += sizeof *proc;
+		}
+		else
+			p += MP_ENTRY_LEN;
+	}
+
+	if (cpu_cnt > 1)
+		printf ("%d CPUs online.\n", cpu_cnt);
+}
+
+/* Starts the AP whose local APIC ID is APIC_ID as cpus[cpu_cnt]
+   and waits for it to join the scheduler.  Returns false if it
+   could not be started. */
+static bool
+start_ap (uint8_t apic_id)
+{
+	struct cpu *cpu;
+	struct thread *idle;
+	int t;
+
+	if (cpu_cnt >= NCPU_MAX)
+	{
+		printf ("smp: only %d CPUs supported\n", NCPU_MAX);
+		return false;
+	}
+
+	cpu = &cpus[cpu_cnt];
+	cpu->apic_id = apic_id;
+	idle = thread_create_idle (cpu);
+	if (idle == NULL)
+		return false;
+
+	ap_boot_stack = (uint8_t *) idle + PGSIZE;
+	ap_started = false;
+	lapic_start_ap (apic_id, AP_START_BASE);
+	for (t = 0; t < AP_START_TIMEOUT && !ap_started; t++)
+		timer_sleep (1);
+
+	/* A late AP would still run on IDLE's page, so it is never
+	   freed. */
+	if (!ap_started)
+	{
+		printf ("smp: CPU %d did not start\n", apic_id);
+		return false;
+	}
+	return true;
+}
+
+/* C entry point of an AP, called by ap-start.S on the stack of
+   the idle thread start_ap() made for it, with interrupts off and
+   the kernel page table active. */
+void
+ap_main (void)
+{
+	struct cpu *cpu = this_cpu ();
+
+#ifdef USERPROG
+	tss_init ();
+	gdt_init ();
+#endif
+	intr_init_ap ();
+	lapic_init (false);
+#ifdef USERPROG
+	syscall_init_cpu ();
+#endif
+
+	/* Counting ourselves under the lock means no CPU looks at
+	   cpus[] while we are only half there. */
+	bkl_acquire ();
+	ASSERT (cpu->id == cpu_cnt);
+	cpu_cnt++;
+	ap_started = true;
+
+	thread_start_ap ();
+	NOT_REACHED ();
+}
+
+/* Acquires the big kernel lock for this CPU.  Interrupts must be
+   off.  While waiting, answers TLB flush requests itself, because
+   the holder may be waiting for us and the IPI cannot get in. */
+void
+bkl_acquire (void)
+{
+	struct cpu *cpu = this_cpu ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (!cpu->bkl_held);
+
+	while (__atomic_exchange_n (&kernel_lock.locked, 1, __ATOMIC_ACQUIRE))
+		while (kernel_lock.locked)
+		{
+			if (cpu->tlb_flush)
+				tlb_flush_local ();
+			asm volatile ("pause");
+		}
+	cpu->bkl_held = true;
+}
+
+/* Releases the big kernel lock, which this CPU must hold.
+   Interrupts must be off. */
+void
+bkl_release (void)
+{
+	struct cpu *cpu = this_cpu ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (cpu->bkl_held);
+
+	cpu->bkl_held = false;
+	spin_unlock (&kernel_lock);
+}
+
+/* Returns true if this CPU holds the big kernel lock. */
+bool
+bkl_held (void)
+{
+	return this_cpu ()->bkl_held;
+}
+
+/* Asks CPU to look at its ready queue. */
+void
+smp_send_reschedule (struct cpu *cpu)
+{
+	ASSERT (cpu != this_cpu ());
+	lapic_send_ipi (cpu->apic_id, IPI_RESCHEDULE_VEC);
+}
+
+/* Flushes the TLBs of the other CPUs that have PML4 loaded and
+   waits until they have.  The caller must hold the big kernel
+   lock and have flushed its own TLB already. */
+void
+tlb_shootdown (uint64_t *pml4)
+{
+	struct cpu *self;
+	enum intr_level old_level;
+	int i;
+
+	if (cpu_cnt == 1)
+		return;
+
+	old_level = intr_disable ();
+	self = this_cpu ();
+	ASSERT (self->bkl_held);
+
+	for (i = 0; i < cpu_cnt; i++)
+		if (&cpus[i] != self && cpus[i].pml4 == pml4)
+		{
+			cpus[i].tlb_flush = true;
+			lapic_send_ipi (cpus[i].apic_id, IPI_TLB_VEC);
+		}
+	for (i = 0; i < cpu_cnt; i++)
+		while (cpus[i].tlb_flush)
+			asm volatile ("pause");
+
+	intr_set_level (old_level);
+}
+
+/* Flushes this CPU's TLB and acknowledges the request that asked
+   for it.  Interrupts must be off. */
+void
+tlb_flush_local (void)
+{
+	lcr3 (rcr3 ());
+	this_cpu ()->tlb_flush = false;
+}
+
+/* Looks for the MP floating pointer structure in physical
+   [PA, PA + SIZE) and returns it, or a null pointer. */
+static struct mp_fps *
+mp_search (uint64_t pa, size_t size)
+{
+	uint8_t *p = ptov (pa);
+	uint8_t *end = p + size;
+
+	for (; p + sizeof (struct mp_fps) <= end; p += 16)
+	{
+		uint8_t sum = 0;
+		size_t i;
+
+		if (memcmp (p, "_MP_", 4))
+			continue;
+		for (i = 0; i < sizeof (struct mp_fps); i++)
+			sum += p[i];
+		if (sum == 0)
+			return (struct mp_fps *) p;
+	}
+	return NULL;
+}
+
+/* Maps physical [PA, PA + SIZE) read-only at ptov(PA) where it is
+   not mapped yet.  The BIOS may put its tables in reserved memory
+   above what paging_init() mapped.  Returns false on failure. */
+static bool
+mp_map (uint64_t pa, size_t size)
+{
+	uint64_t page;
+
+	for (page = pa & ~PGMASK; page < pa + size; page += PGSIZE)
+	{
+		uint64_t *pte = pml4e_walk (base_pml4, (uint64_t) ptov (page), 1);
+
+		if (pte == NULL)
+			return false;
+		if (!(*pte & PTE_P))
+			*pte = page | PTE_P;
+	}
+	return true;
+}
+
+/* Returns the MP configuration table, or a null pointer if there
+   is none.  The floating pointer is in the first KB of the EBDA or
+   in the BIOS ROM; the BDA word that locates the EBDA lies in the
+   initial thread's page, so the usual 0x9fc00 is assumed.  See
+   [MP] section 4. */
+static struct mp_config *
+mp_find_config (void)
+{
+	struct mp_fps *fps;
+	struct mp_config *conf;
+	uint8_t sum = 0;
+	int i;
+
+	fps = mp_search (0x9fc00, 0x400);
+	if (fps == NULL)
+		fps = mp_search (0xf0000, 0x10000);
+	if (fps == NULL || fps->config == 0)
+		return NULL;
+
+	if (!mp_map (fps->config, sizeof *conf))
+		return NULL;
+	conf = ptov (fps->config);
+	if (memcmp (conf->signature, "PCMP", 4) || !mp_map (fps->config, conf->length))
+		return NULL;
+	for (i = 0; i < conf->length; i++)
+		sum += ((uint8_t *) conf)[i];
+	return sum == 0 ? conf : NULL;
+}
+
+/* Another CPU put a thread on our ready queue.  The idle thread
+   always gives way; anything else only to a higher priority. */
+static void
+reschedule_interrupt (struct intr_frame *f UNUSED)
+{
+	if (thread_current () == this_cpu ()->idle)
+		intr_yield_on_return ();
+	else
+		compare_cur_next_priority ();
+}
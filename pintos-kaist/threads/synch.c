@@ -32,30 +32,108 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
-static bool compare_priority(const struct list_elem *a, const struct list_elem *b, void *aux);
-static bool compare_priority_for_donate(const struct list_elem *a, const struct list_elem *b, void *aux);
-static bool compare_priority_for_cond(const struct list_elem *a,
-									  const struct list_elem *b,
-									  void *aux UNUSED);
-static donation *create_donation(struct thread *thread, struct lock *lock);
-static void remove_donation_for_lock(struct lock *);
-static void recalc_priority();
+static bool waiter_less(const struct heap_elem *a, const struct heap_elem *b, void *aux);
+static bool donor_less(const struct heap_elem *a, const struct heap_elem *b, void *aux);
+static void lock_drop(struct lock *);
+static void donate_priority(struct lock *);
+static void rwlock_donate(struct rwlock *, int priority);
+static void lock_refresh_priority(struct lock *);
+static void lock_take(struct lock *);
 
 int idx = 0;
 
-static bool compare_priority(const struct list_elem *a, const struct list_elem *b, void *aux)
+/* Initializes wait queue Q as empty. */
+void wait_queue_init(struct wait_queue *q)
 {
-	struct thread *t1 = list_entry(a, struct thread, elem);
-	struct thread *t2 = list_entry(b, struct thread, elem);
+	ASSERT(q != NULL);
 
-	return t1->priority > t2->priority;
+	heap_init(&q->waiters, waiter_less, NULL);
+	q->seq = 0;
 }
 
-static bool compare_priority_for_donate(const struct list_elem *a, const struct list_elem *b, void *aux)
+/* Adds T to Q.  T must block right after, with interrupts still
+   off, and stays in Q until wait_queue_pop() hands it out. */
+void wait_queue_push(struct wait_queue *q, struct thread *t)
 {
-	donation *t1 = list_entry(a, donation, elem);
-	donation *t2 = list_entry(b, donation, elem);
-	return t1->priority > t2->priority;
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(t->wait_queue == NULL);
+
+	t->wait_seq = q->seq++;
+	t->wait_queue = q;
+	heap_push(&q->waiters, &t->wait_elem);
+}
+
+/* Removes and returns the highest-priority thread in Q, the one
+   that waited longest among equals.  Q must not be empty. */
+struct thread *
+wait_queue_pop(struct wait_queue *q)
+{
+	struct thread *t;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	t = heap_entry(heap_pop(&q->waiters), struct thread, wait_elem);
+	t->wait_queue = NULL;
+	return t;
+}
+
+/* Returns true if no thread waits in Q. */
+bool wait_queue_empty(const struct wait_queue *q)
+{
+	return heap_empty(&q->waiters);
+}
+
+/* Repositions T in the wait queue it sleeps in, if any, after its
+   priority changed. */
+void wait_queue_update(struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (t->wait_queue != NULL)
+		heap_update(&t->wait_queue->waiters, &t->wait_elem);
+}
+
+/* Orders waiters by priority, then by arrival. */
+static bool waiter_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	struct thread *t1 = heap_entry(a, struct thread, wait_elem);
+	struct thread *t2 = heap_entry(b, struct thread, wait_elem);
+
+	if (t1->priority != t2->priority)
+		return t1->priority < t2->priority;
+	return t1->wait_seq > t2->wait_seq;
+}
+
+/* Orders a lock's donors by priority. */
+static bool donor_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	return heap_entry(a, struct thread, donor_elem)->priority <
+		   heap_entry(b, struct thread, donor_elem)->priority;
+}
+
+/* Initializes spinlock L as unlocked. */
+void spin_init(struct spinlock *l)
+{
+	l->locked = 0;
+}
+
+/* Acquires L, spinning while another CPU holds it.  Interrupts
+   must be off so that the holder cannot be preempted on this CPU;
+   it is not recursive. */
+void spin_lock(struct spinlock *l)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	while (__atomic_exchange_n(&l->locked, 1, __ATOMIC_ACQUIRE))
+		while (l->locked)
+			asm volatile("pause");
+}
+
+/* Releases L, which the caller must hold. */
+void spin_unlock(struct spinlock *l)
+{
+	ASSERT(l->locked);
+	__atomic_store_n(&l->locked, 0, __ATOMIC_RELEASE);
 }
 
 /* 세마포어 SEMA를 VALUE로 초기화합니다. 세마포어는 다음과 같은 두 가지 원자적 연산을 통해 조작되는
@@ -68,8 +146,9 @@ void sema_init(struct semaphore *sema, unsigned value)
 {
 	ASSERT(sema != NULL);
 
+	spin_init(&sema->lock);
 	sema->value = value;
-	list_init(&sema->waiters);
+	wait_queue_init(&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore. SEMA의 값이 양수가 될 때까지 기다린 후
@@ -87,12 +166,18 @@ void sema_down(struct semaphore *sema)
 	ASSERT(!intr_context());
 
 	old_level = intr_disable();
+	spin_lock(&sema->lock);
 	while (sema->value == 0)
 	{
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, compare_priority, NULL);
+		wait_queue_push(&sema->waiters, thread_current());
+		/* 인터럽트는 꺼 둔 채로 놓으므로 이 CPU에서는 잠들기 전에
+		   sema_up()이 끼어들지 못합니다 */
+		spin_unlock(&sema->lock);
 		thread_block();
+		spin_lock(&sema->lock);
 	}
 	sema->value--;
+	spin_unlock(&sema->lock);
 	intr_set_level(old_level);
 }
 
@@ -108,6 +193,7 @@ bool sema_try_down(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
+	spin_lock(&sema->lock);
 	if (sema->value > 0)
 	{
 		sema->value--;
@@ -115,6 +201,7 @@ bool sema_try_down(struct semaphore *sema)
 	}
 	else
 		success = false;
+	spin_unlock(&sema->lock);
 	intr_set_level(old_level);
 
 	return success;
@@ -131,17 +218,28 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
-	{
-		list_sort(&sema->waiters, compare_priority, NULL);		  // 먼저 정렬 -> 굳이 해야하나 싶다
-		thread_unblock(list_entry(list_pop_front(&sema->waiters), // 쓰레드 웨이트 리스트에 있는 쓰레드 하나 깨움
-								  struct thread, elem));
-	}
-	sema->value++;
+	sema_wake(sema);
 	compare_cur_next_priority(); // 깨어난 쓰레드가 우선순위가 더 높다면 양보
 	intr_set_level(old_level);
 }
 
+/* SEMA의 값을 올리고 가장 우선순위가 높은 대기 스레드를 깨우지만
+	양보하지는 않습니다. 인터럽트가 꺼진 상태에서 불러야 합니다. */
+void sema_wake(struct semaphore *sema)
+{
+	struct thread *waiter = NULL;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	spin_lock(&sema->lock);
+	if (!wait_queue_empty(&sema->waiters))
+		waiter = wait_queue_pop(&sema->waiters);
+	sema->value++;
+	spin_unlock(&sema->lock);
+	if (waiter != NULL)
+		thread_unblock(waiter); // 쓰레드 웨이트 리스트에 있는 쓰레드 하나 깨움
+}
+
 static void sema_test_helper(void *sema_);
 
 /* Self-test for semaphores that makes control "ping-pong"
@@ -193,6 +291,8 @@ void lock_init(struct lock *lock)
 
 	lock->holder = NULL;
 	sema_init(&lock->semaphore, 1); // 바이너리 세마포어
+	heap_init(&lock->donors, donor_less, NULL);
+	lock->hold.priority = PRI_MIN;
 }
 
 /* LOCK을 획득하며, 필요하다면 사용할 수 있을 때까지 대기 상태로 들어갑니다.
@@ -208,55 +308,90 @@ void lock_acquire(struct lock *lock)
 	ASSERT(!lock_held_by_current_thread(lock));
 
 	struct thread *cur = thread_current(); // 현재 쓰레드
-	struct lock *pending = NULL;
+	enum intr_level old_level;
 
-	if (lock->holder)
+	/* 홀더가 있으면 donors에 들어가 홀더부터 줄줄이 우선순위를 기부합니다.
+	   mlfqs에서는 기부하지 않습니다. */
+	old_level = intr_disable();
+	if (lock->holder != NULL && !thread_mlfqs)
 	{
-		cur->pending_lock = lock;	 // 현재 쓰레드의 대기 락 설정
-		pending = cur->pending_lock; // 대기하는 락
-		ASSERT(cur->pending_lock != NULL);
+		cur->pending_lock = lock;
+		heap_push(&lock->donors, &cur->donor_elem);
+		donate_priority(lock);
 	}
-	ASSERT(lock != NULL);
+	intr_set_level(old_level);
 
-	while (pending != NULL) // 재귀적으로 가자
+	sema_down(&lock->semaphore); // 락을 잡으려고 시도하고, 이미 잡혀있다면 대기함
+
+	old_level = intr_disable();
+	if (cur->pending_lock != NULL)
 	{
-		struct thread *holder = pending->holder;						// 대기하는 락의 홀더
-		if (holder == NULL || thread_get_priority() < holder->priority) // 홀더의 우선순위가 자신보다 크다면 기부 안해도 됨
-		{
-			break;
-		}
+		heap_remove(&lock->donors, &cur->donor_elem);
+		cur->pending_lock = NULL;
+	}
+	lock_take(lock); // 현재 스레드가 락을 잡음
+	intr_set_level(old_level);
+}
 
-		donation *donate = create_donation(cur, pending);
+/* LOCK의 donors가 바뀐 뒤 부릅니다. 홀더에서 시작해 홀더가 기다리는
+   락의 홀더로 거슬러 올라가며, 우선순위가 더 바뀌지 않을 때까지 기부를
+   전합니다. 단계마다 힙 연산만 하므로 O(log n)입니다. */
+static void donate_priority(struct lock *lock)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
 
-		if (holder->priority < thread_get_priority()) // 홀더의 우선순위 갱신
-		{
-			holder->priority = thread_get_priority();
-		}
+	while (lock != NULL && lock->holder != NULL)
+	{
+		struct thread *holder = lock->holder;
 
-		list_insert_ordered(&holder->donations, &donate->elem, compare_priority_for_donate, NULL);
-		if (holder->pending_lock != NULL)
-		{
-			list_sort(&holder->pending_lock->semaphore.waiters, compare_priority, NULL);
-		}
+		lock_refresh_priority(lock);
+		if (!thread_refresh_priority(holder))
+			break;
+
+		/* 홀더가 읽는 쪽이 빠지기를 기다리는 쓰기 쪽이면 읽는 쪽들에게 전합니다 */
+		if (holder->draining_rw != NULL)
+			rwlock_donate(holder->draining_rw, holder->priority);
 
-		pending = holder->pending_lock; // 홀더가 대기하는 다른 락 확인
+		/* 홀더의 우선순위가 올랐으니 홀더가 기다리는 락의 donors에서도
+		   자리를 다시 잡습니다 */
+		lock = holder->pending_lock;
+		if (lock != NULL)
+			heap_update(&lock->donors, &holder->donor_elem);
 	}
+}
 
-	sema_down(&lock->semaphore); // 락을 잡으려고 시도하고, 이미 잡혀있다면 대기함
-	cur->pending_lock = NULL;
-	lock->holder = thread_current(); // 현재 스레드가 락을 잡음
+/* LOCK->hold.priority를 donors의 가장 높은 우선순위로 맞추고, 잡혀
+   있다면 홀더의 held_locks에서 자리를 다시 잡습니다. */
+static void lock_refresh_priority(struct lock *lock)
+{
+	struct heap_elem *top = heap_top(&lock->donors);
+	int priority = top != NULL ? heap_entry(top, struct thread, donor_elem)->priority
+							   : PRI_MIN;
+
+	if (priority == lock->hold.priority)
+		return;
+	lock->hold.priority = priority;
+	if (lock->holder != NULL)
+		heap_update(&lock->holder->held_locks, &lock->hold.elem);
 }
 
-static donation *create_donation(struct thread *thread, struct lock *lock)
+/* 현재 스레드를 LOCK의 홀더로 만듭니다. 아직 기다리는 스레드가 있으면
+   그 우선순위를 바로 기부받습니다. mlfqs에서는 우선순위를 스케줄러가
+   정하므로 held_locks에 넣지 않습니다. 인터럽트가 꺼진 상태에서 불러야
+   합니다. */
+static void lock_take(struct lock *lock)
 {
-	struct lock *pending_lock = thread->pending_lock;
-	donation *donate = malloc(sizeof(donation)); // 기부자 목록도 유지해야함 !!
-	thread->pending_lock = pending_lock;
-	donate->priority = thread_get_priority(); // 기부받은 우선순위 저장 -> 복구를 위해서
-	donate->donor = thread;					  // 기부자 저장
-	donate->lock = lock;					  // 락 저장
-	ASSERT(donate != NULL);
-	return donate;
+	struct thread *cur = thread_current();
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	lock->holder = cur;
+	if (thread_mlfqs)
+		return;
+	lock->hold.priority = PRI_MIN;
+	heap_push(&cur->held_locks, &lock->hold.elem);
+	lock_refresh_priority(lock);
+	thread_refresh_priority(cur);
 }
 
 /* LOCK을 획득하려 시도하며, 성공하면 true를 반환하고 실패하면 false를 반환합니다.
@@ -273,8 +408,12 @@ bool lock_try_acquire(struct lock *lock)
 	/* 현재 락을 누군가가 갖고 있다면 false, 아니라면 true */
 	success = sema_try_down(&lock->semaphore);
 	if (success)
+	{
 		/* 현재 락의 홀더는 실행 쓰레드가 됨 */
-		lock->holder = thread_current();
+		enum intr_level old_level = intr_disable();
+		lock_take(lock);
+		intr_set_level(old_level);
+	}
 	return success;
 }
 
@@ -289,60 +428,197 @@ void lock_release(struct lock *lock)
 	ASSERT(lock_held_by_current_thread(lock));
 	ASSERT(lock->holder != NULL);
 
-	remove_donation_for_lock(lock);
+	enum intr_level old_level = intr_disable();
+	lock_drop(lock);
+	compare_cur_next_priority();
+	intr_set_level(old_level);
+}
 
-	recalc_priority();
+/* 이 락으로 받던 기부를 내려놓고 LOCK을 풀지만 양보하지는 않습니다.
+	인터럽트가 꺼진 상태에서 불러야 합니다. */
+static void lock_drop(struct lock *lock)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
 
+	if (!thread_mlfqs)
+		heap_remove(&lock->holder->held_locks, &lock->hold.elem);
 	lock->holder = NULL;
-	sema_up(&lock->semaphore);
-	compare_cur_next_priority();
+	if (!thread_mlfqs)
+		thread_refresh_priority(thread_current());
+	sema_wake(&lock->semaphore);
 }
 
-static void remove_donation_for_lock(struct lock *lock)
+/* 현재 스레드가 LOCK을 보유하고 있으면 true를 반환하고,
+	그렇지 않으면 false를 반환합니다.
+	(다른 스레드가 락을 보유하고 있는지 테스트하는 것은 경쟁 상태를 초래할 수 있습니다.) */
+bool lock_held_by_current_thread(const struct lock *lock)
+{
+	ASSERT(lock != NULL);
+
+	return lock->holder == thread_current();
+}
+
+/* Initializes RW as unlocked. */
+void rwlock_init(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	spin_init(&rw->guard);
+	lock_init(&rw->writer);
+	sema_init(&rw->drained, 0);
+	rw->readers = 0;
+	rw->draining = false;
+	list_init(&rw->holds);
+}
+
+/* Returns the current thread's hold on RW, or a free one if RW is
+   NULL. */
+static struct rw_hold *
+rw_hold_find(struct rwlock *rw)
 {
-	struct list_elem *e;
 	struct thread *cur = thread_current();
 
-	for (e = list_begin(&cur->donations); e != list_end(&cur->donations); e = list_next(e))
+	for (int i = 0; i < RW_HOLD_MAX; i++)
+		if (cur->rw_holds[i].rwlock == rw)
+			return &cur->rw_holds[i];
+	return NULL;
+}
+
+/* 쓰기 쪽이 RW의 읽는 쪽이 빠지기를 기다리는 동안 그 우선순위
+   PRIORITY를 읽는 쪽 모두에게 기부합니다. 읽는 쪽이 다른 락을 기다리고
+   있으면 그 홀더로도 이어서 전합니다. 인터럽트가 꺼진 상태에서 불러야
+   합니다. */
+static void rwlock_donate(struct rwlock *rw, int priority)
+{
+	struct list_elem *e;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	spin_lock(&rw->guard);
+	for (e = list_begin(&rw->holds); e != list_end(&rw->holds); e = list_next(e))
 	{
-		donation *d = list_entry(e, donation, elem);
-		if (d->lock == lock)
+		struct rw_hold *h = list_entry(e, struct rw_hold, elem);
+		struct thread *reader = h->reader;
+
+		if (h->hold.priority == priority)
+			continue;
+		h->hold.priority = priority;
+		heap_update(&reader->held_locks, &h->hold.elem);
+		if (thread_refresh_priority(reader) && reader->pending_lock != NULL)
 		{
-			list_remove(&d->elem);
+			heap_update(&reader->pending_lock->donors, &reader->donor_elem);
+			donate_priority(reader->pending_lock);
 		}
 	}
+	spin_unlock(&rw->guard);
 }
 
-static void recalc_priority()
+/* Acquires RW for reading, sleeping while a writer holds it or
+   waits for it. */
+void rwlock_read_acquire(struct rwlock *rw)
 {
-	struct thread *cur = thread_current();
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
 
-	cur->priority = cur->original_priority;
-	if (list_empty(&cur->donations))
-		return;
+	/* 쓰기 쪽이 잡고 있거나 기다리는 중이면 여기서 기다리며 기부합니다 */
+	lock_acquire(&rw->writer);
+	enum intr_level old_level = intr_disable();
+	struct rw_hold *h = rw_hold_find(NULL);
+	ASSERT(h != NULL);
+	h->rwlock = rw;
+	h->reader = thread_current();
+
+	/* WRITER를 쥐고 있으니 지금 기다리는 쓰기 쪽은 없습니다 */
+	h->hold.priority = PRI_MIN;
+	if (!thread_mlfqs)
+		heap_push(&h->reader->held_locks, &h->hold.elem);
+
+	spin_lock(&rw->guard);
+	rw->readers++;
+	list_push_back(&rw->holds, &h->elem);
+	spin_unlock(&rw->guard);
+	intr_set_level(old_level);
+	lock_release(&rw->writer);
+}
+
+/* Releases RW held for reading. */
+void rwlock_read_release(struct rwlock *rw)
+{
+	enum intr_level old_level;
+	struct rw_hold *h;
+	bool wake = false;
 
-	list_sort(&cur->donations, compare_priority_for_donate, NULL);
-	int front_priority = list_entry(list_front(&cur->donations), donation, elem)->priority;
-	if (cur->priority < front_priority)
-		cur->priority = front_priority;
+	ASSERT(rw != NULL);
+
+	old_level = intr_disable();
+	h = rw_hold_find(rw);
+	ASSERT(h != NULL);
+
+	spin_lock(&rw->guard);
+	ASSERT(rw->readers > 0);
+	list_remove(&h->elem);
+	if (--rw->readers == 0 && rw->draining)
+	{
+		rw->draining = false;
+		wake = true;
+	}
+	spin_unlock(&rw->guard);
+
+	/* 쓰기 쪽에게 받던 기부를 내려놓습니다 */
+	if (!thread_mlfqs)
+	{
+		heap_remove(&h->reader->held_locks, &h->hold.elem);
+		thread_refresh_priority(h->reader);
+	}
+	h->rwlock = NULL;
+
+	if (wake)
+		sema_up(&rw->drained);
+	compare_cur_next_priority();
+	intr_set_level(old_level);
 }
 
-/* 현재 스레드가 LOCK을 보유하고 있으면 true를 반환하고,
-	그렇지 않으면 false를 반환합니다.
-	(다른 스레드가 락을 보유하고 있는지 테스트하는 것은 경쟁 상태를 초래할 수 있습니다.) */
-bool lock_held_by_current_thread(const struct lock *lock)
+/* Acquires RW for writing, sleeping until the writer before it is
+   done and every reader inside has left. */
+void rwlock_write_acquire(struct rwlock *rw)
 {
-	ASSERT(lock != NULL);
+	enum intr_level old_level;
 
-	return lock->holder == thread_current();
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+
+	lock_acquire(&rw->writer);
+
+	old_level = intr_disable();
+	spin_lock(&rw->guard);
+	if (rw->readers > 0)
+	{
+		struct thread *cur = thread_current();
+
+		rw->draining = true;
+		spin_unlock(&rw->guard);
+
+		/* 기다리는 동안 자기 우선순위를 읽는 쪽들에게 기부하고, 그동안
+		   자기가 받는 기부도 draining_rw를 따라 읽는 쪽들에게 전해집니다 */
+		cur->draining_rw = rw;
+		if (!thread_mlfqs)
+			rwlock_donate(rw, cur->priority);
+		sema_down(&rw->drained);
+		cur->draining_rw = NULL;
+	}
+	else
+		spin_unlock(&rw->guard);
+	intr_set_level(old_level);
 }
 
-/* One semaphore in a list. */
-struct semaphore_elem
+/* Releases RW held for writing. */
+void rwlock_write_release(struct rwlock *rw)
 {
-	struct list_elem elem;		/* List element. */
-	struct semaphore semaphore; /* This semaphore. */
-};
+	ASSERT(rw != NULL);
+	ASSERT(rw->readers == 0);
+
+	lock_release(&rw->writer);
+}
 
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
@@ -351,7 +627,7 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	wait_queue_init(&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -376,41 +652,23 @@ void cond_init(struct condition *cond)
    we need to sleep. */
 void cond_wait(struct condition *cond, struct lock *lock)
 {
-	struct semaphore_elem waiter;
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	sema_init(&waiter.semaphore, 0);
-	/* wait 리스트에 쓰레드 우선순위 순으로 저장 */
-	list_insert_ordered(&cond->waiters, &waiter.elem, compare_priority_for_cond, NULL);
-	lock_release(lock);
-	sema_down(&waiter.semaphore);
+	/* 큐에 들어간 뒤 잠들 때까지 양보하지 않아야 signal이 아직 돌고 있는
+	   스레드를 깨우지 않습니다 */
+	old_level = intr_disable();
+	wait_queue_push(&cond->waiters, thread_current());
+	lock_drop(lock);
+	thread_block();
+	intr_set_level(old_level);
 	lock_acquire(lock);
 }
 
-static bool compare_priority_for_cond(const struct list_elem *a,
-									  const struct list_elem *b,
-									  void *aux UNUSED)
-{
-	struct semaphore_elem *sema_a = list_entry(a, struct semaphore_elem, elem);
-	struct semaphore_elem *sema_b = list_entry(b, struct semaphore_elem, elem);
-
-	if (list_empty(&sema_a->semaphore.waiters))
-		return false; // b가 더 높음
-	if (list_empty(&sema_b->semaphore.waiters))
-		return true; // a가 더 높음
-
-	struct thread *t1 = list_entry(list_front(&sema_a->semaphore.waiters),
-								   struct thread, elem);
-	struct thread *t2 = list_entry(list_front(&sema_b->semaphore.waiters),
-								   struct thread, elem);
-
-	return t1->priority > t2->priority;
-}
-
 /* If any threads are waiting on COND (protected by LOCK), then
    this function signals one of them to wake up from its wait.
    LOCK must be held before calling this function.
@@ -425,13 +683,13 @@ void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
+	enum intr_level old_level = intr_disable();
+	if (!wait_queue_empty(&cond->waiters))
 	{
-		list_sort(&cond->waiters, compare_priority_for_cond, NULL);
-		sema_up(&list_entry(list_pop_front(&cond->waiters),
-							struct semaphore_elem, elem)
-					 ->semaphore);
+		thread_unblock(wait_queue_pop(&cond->waiters));
+		compare_cur_next_priority();
 	}
+	intr_set_level(old_level);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -444,7 +702,64 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 {
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
+	ASSERT(!intr_context());
+	ASSERT(lock_held_by_current_thread(lock));
+
+	/* 우선순위 순으로 한 번에 모두 깨우고 양보는 끝에 한 번만 봅니다 */
+	enum intr_level old_level = intr_disable();
+	while (!wait_queue_empty(&cond->waiters))
+		thread_unblock(wait_queue_pop(&cond->waiters));
+	compare_cur_next_priority();
+	intr_set_level(old_level);
+}
+
+/* Initializes poll queue Q. */
+void poll_queue_init(struct poll_queue *q)
+{
+	ASSERT(q != NULL);
+
+	list_init(&q->waiters);
+}
 
-	while (!list_empty(&cond->waiters))
-		cond_signal(cond, lock);
+/* Registers W on Q so that SEMA is upped whenever Q is woken. */
+void poll_queue_add(struct poll_queue *q, struct poll_waiter *w,
+					struct semaphore *sema)
+{
+	enum intr_level old_level;
+
+	ASSERT(q != NULL && w != NULL && sema != NULL);
+
+	old_level = intr_disable();
+	w->sema = sema;
+	list_push_back(&q->waiters, &w->elem);
+	intr_set_level(old_level);
+}
+
+/* Unregisters W, if it is registered. */
+void poll_queue_remove(struct poll_waiter *w)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (w->sema != NULL)
+	{
+		list_remove(&w->elem);
+		w->sema = NULL;
+	}
+	intr_set_level(old_level);
+}
+
+/* Ups the semaphore of every waiter registered on Q.  Waiters stay
+   registered.  May be called from an interrupt handler.
+
+   A woken poller unregisters and frees its waiters as soon as it
+   runs, so nothing may yield until the walk is done. */
+void poll_queue_wake(struct poll_queue *q)
+{
+	enum intr_level old_level = intr_disable();
+	struct list_elem *e;
+
+	for (e = list_begin(&q->waiters); e != list_end(&q->waiters); e = list_next(e))
+		sema_wake(list_entry(e, struct poll_waiter, elem)->sema);
+	compare_cur_next_priority();
+	intr_set_level(old_level);
 }
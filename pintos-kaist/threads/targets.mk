@@ -3,6 +3,9 @@ threads_SRC += threads/thread.c		# Thread management core.
 threads_SRC += threads/interrupt.c	# Interrupt core.
 threads_SRC += threads/intr-stubs.S	# Interrupt stubs.
 threads_SRC += threads/synch.c		# Synchronization.
+threads_SRC += threads/rcu.c		# Read-copy-update.
+threads_SRC += threads/smp.c		# Multiprocessor startup and big kernel lock.
+threads_SRC += threads/ap-start.S	# Application processor startup code.
 threads_SRC += threads/palloc.c		# Page allocator.
 threads_SRC += threads/malloc.c		# Subpage allocator.
 threads_SRC += threads/start.S		# Startup code.
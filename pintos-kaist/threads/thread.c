@@ -4,12 +4,16 @@
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
+#include "threads/rcu.h"
+#include "threads/smp.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -25,12 +29,16 @@
    Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* CPU별 상태. BSP는 cpus[0]이고 AP는 smp_init()이 차례로 채웁니다
+   (threads/cpu.h, threads/smp.c).
+   THREAD_READY 상태인 스레드는 각 CPU의 레디 큐(struct run_queue)에
+   들어 있습니다. 깨어난 스레드는 마지막으로 돈 CPU로, 새 스레드는
+   가장 한가한 CPU로 갑니다. 큐가 빈 CPU는 가장 바쁜 CPU에서 훔쳐 오고,
+   BALANCE_INTERVAL 틱마다 큐 길이 차가 2 이상이면 하나를 당겨 옵니다. */
+struct cpu cpus[NCPU_MAX];
+int cpu_cnt = 1;
 
-/* Idle thread. */
-static struct thread *idle_thread;
+#define BALANCE_INTERVAL 20 /* 부하 분산 주기 (틱) */
 
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
@@ -41,14 +49,8 @@ static struct lock tid_lock;
 /* Thread destruction requests */
 static struct list destruction_req;
 
-/* Statistics. */
-static long long idle_ticks;   /* # of timer ticks spent idle. */
-static long long kernel_ticks; /* # of timer ticks in kernel threads. */
-static long long user_ticks;   /* # of timer ticks in user programs. */
-
 /* Scheduling. */
-#define TIME_SLICE 4		  /* # of timer ticks to give each thread. */
-static unsigned thread_ticks; /* # of timer ticks since last yield. */
+#define TIME_SLICE 4 /* # of timer ticks to give each thread. */
 
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
@@ -56,19 +58,39 @@ static unsigned thread_ticks; /* # of timer ticks since last yield. */
 bool thread_mlfqs;
 static struct list all_list;
 
+/* MLFQS: 마지막으로 우선순위를 계산한 뒤 recent_cpu가 바뀐 스레드들.
+   1초마다의 전체 재계산 사이에는 실행된 스레드의 recent_cpu만 바뀌므로
+   4틱마다 이 목록에 있는 스레드만 다시 계산하면 됩니다. */
+static struct list mlfqs_dirty_list;
+
 static void kernel_thread(thread_func *, void *aux);
 
 static void idle(void *aux UNUSED);
+static void idle_loop(void) NO_RETURN;
 static struct thread *next_thread_to_run(void);
 static void init_thread(struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
 static bool compare_priority(const struct list_elem *a, const struct list_elem *b, void *aux);
+static bool held_lock_less(const struct heap_elem *a, const struct heap_elem *b, void *aux);
+static void rq_init(struct run_queue *);
+static void rq_link(struct run_queue *, struct thread *);
+static void rq_push(struct cpu *, struct thread *);
+static struct cpu *rq_lock_thread(struct thread *);
+static struct thread *rq_pop(struct cpu *);
+static int rq_max_priority(struct cpu *);
+static int rq_len(struct cpu *);
+static struct cpu *least_loaded_cpu(void);
+static struct cpu *busiest_cpu(void);
+static void balance_load(void);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
 
+/* T가 어느 CPU의 idle 스레드인지. idle 스레드는 자기 CPU를 떠나지 않습니다. */
+#define is_idle(t) ((t) == (t)->cpu->idle)
+
 /* Returns the running thread.
  * Read the CPU's stack pointer `rsp', and then round that
  * down to the start of a page.  Since `struct thread' is
@@ -112,14 +134,25 @@ void thread_init(void)
 
 	/* Init the globla thread context */
 	lock_init(&tid_lock);
-	list_init(&ready_list);
+	for (int i = 0; i < NCPU_MAX; i++)
+	{
+		cpus[i].id = i;
+		rq_init(&cpus[i].rq);
+	}
 	list_init(&destruction_req);
 	list_init(&all_list);
+	list_init(&mlfqs_dirty_list);
 
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread();
 	init_thread(initial_thread, "main", PRI_DEFAULT);
 	initial_thread->status = THREAD_RUNNING;
+
+	/* this_cpu()는 실행 중인 스레드의 cpu를 읽으므로 tid를 받기 전에
+	   채웁니다. BSP는 빅 커널 락을 쥔 채 부팅합니다 (threads/smp.c). */
+	initial_thread->cpu = &cpus[0];
+	cpus[0].curr = initial_thread;
+	cpus[0].bkl_held = true;
 	initial_thread->tid = allocate_tid();
 }
 
@@ -141,35 +174,74 @@ void thread_start(void)
 
 /* Called by the timer interrupt handler at each timer tick.
    Thus, this function runs in an external interrupt context. */
-void thread_tick(void)
+void thread_tick(bool user)
 {
 	struct thread *t = thread_current();
 
+	struct cpu *cpu = this_cpu();
+
+	cpu->ticks++;
+
 	/* Update statistics. */
-	if (t == idle_thread)
-		idle_ticks++;
+	if (t == cpu->idle)
+		cpu->idle_ticks++;
 #ifdef USERPROG
 	else if (t->pml4 != NULL)
-		user_ticks++;
+		cpu->user_ticks++;
 #endif
 	else
-		kernel_ticks++;
+		cpu->kernel_ticks++;
+
+	/* 프로세스별 사용량 */
+	/* 유저 모드에 있던 스레드는 읽기 구간 밖입니다 */
+	if (user)
+		rcu_qs();
+
+	if (t != cpu->idle)
+	{
+		struct thread_usage *usage = thread_usage();
+		if (user)
+			usage->user_ticks++;
+		else
+			usage->kernel_ticks++;
+	}
 
 	// 매 timer tick마다 MLFQS 업데이트 트리거
 	if (thread_mlfqs)
 	{
 		mlfqs_on_tick(); // running thread의 recent_cpu++, 주기적 갱신 처리
 	}
+	if (cpu_cnt > 1 && cpu->ticks % BALANCE_INTERVAL == 0)
+		balance_load();
+
 	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	if (++cpu->thread_ticks >= TIME_SLICE)
 		intr_yield_on_return();
 }
 
+/* tickless idle로 건너뛴 틱을 타이머 인터럽트가 몰아서 셀 때 부릅니다.
+   그 틱 동안은 idle 스레드가 돌았습니다. */
+void thread_idle_tick(void)
+{
+	this_cpu()->idle_ticks++;
+}
+
 /* Prints thread statistics. */
 void thread_print_stats(void)
 {
+	long long idle_ticks = 0, kernel_ticks = 0, user_ticks = 0;
+
+	for (int i = 0; i < cpu_cnt; i++)
+	{
+		idle_ticks += cpus[i].idle_ticks;
+		kernel_ticks += cpus[i].kernel_ticks;
+		user_ticks += cpus[i].user_ticks;
+	}
 	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 		   idle_ticks, kernel_ticks, user_ticks);
+	for (int i = 0; i < cpu_cnt; i++)
+		printf("CPU %d: %lld idle ticks, %lld steals, %lld migrations\n",
+			   i, cpus[i].idle_ticks, cpus[i].steals, cpus[i].migrations);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -203,6 +275,7 @@ tid_t thread_create(const char *name, int priority,
 
 	/* Initialize thread. */
 	init_thread(t, name, priority);
+	t->cpu = least_loaded_cpu();
 
 	// 2. 고급 스케줄러가 켜져 있다면:
 
@@ -239,11 +312,20 @@ tid_t thread_create(const char *name, int priority,
 	return tid;
 }
 
-/* 인자로 받은 스레드의 recent_cpu를 수정하는 함수입니다.
-모든 스레드 업데이트에서 사용하기 위해 인자를 void를 thread로 수정했습니다 */
+/* 실행 중인 스레드의 recent_cpu를 1 올리고, 다음 우선순위 계산 대상으로
+표시합니다. 매 틱 호출됩니다 */
 void update_recent_cpu(void)
 {
-	thread_current()->recent_cpu = add_fp_int(thread_current()->recent_cpu, 1);
+	struct thread *cur = thread_current();
+
+	if (cur == this_cpu()->idle)
+		return;
+	cur->recent_cpu = add_fp_int(cur->recent_cpu, 1);
+	if (!cur->mlfqs_dirty)
+	{
+		cur->mlfqs_dirty = true;
+		list_push_back(&mlfqs_dirty_list, &cur->dirty_elem);
+	}
 }
 
 /* load_avg를 계산하는 함수입니다. mlfqs_on_tick에서 1초마다 호출되어야 합니다
@@ -252,9 +334,13 @@ load_avg = (59/60) * load_avg + (1/60) * ready_threads_size
 */
 void update_load_avg(void)
 {
-	int ready_threads = list_size(&ready_list);
-	if (thread_current() != idle_thread)
-		ready_threads++;
+	int ready_threads = 0;
+	for (int i = 0; i < cpu_cnt; i++)
+	{
+		ready_threads += rq_len(&cpus[i]);
+		if (cpus[i].curr != cpus[i].idle)
+			ready_threads++;
+	}
 
 	fixed_t term1 = div_fp_int(mul_fp_int(load_avg, 59), 60); // (59 * load_avg) / 60
 	fixed_t term2 = mul_fp_int(div_fp_int(int_to_fp(1), 60), ready_threads);
@@ -266,7 +352,7 @@ void update_load_avg(void)
 모든 스레드 업데이트에서 사용하기위해 인자를 void 에서 thread로 수정했습니다 */
 void update_priority(struct thread *thread) // 4틱마다 계산
 {
-	if (thread == idle_thread)
+	if (is_idle(thread))
 		return;
 
 	int new_priority = PRI_MAX - fp_to_int_round(div_fp_int(thread->recent_cpu, 4)) - (thread->nice * 2);
@@ -277,47 +363,47 @@ void update_priority(struct thread *thread) // 4틱마다 계산
 	if (new_priority < PRI_MIN)
 		new_priority = PRI_MIN;
 
-	thread->priority = new_priority;
+	thread_change_priority(thread, new_priority);
 }
 
-/* 모든 스레드의 CPU 점유율을 계산하는 함수입니다.
-mlfqs_on_tick에서 사용되어야 합니다 */
+/* 1초마다 모든 스레드의 recent_cpu를
+recent_cpu = (2 * load_avg) / (2 * load_avg + 1) * recent_cpu + nice
+로 다시 계산합니다. 모든 스레드의 recent_cpu가 바뀌므로 우선순위도 함께
+다시 계산하고 바뀐 스레드 목록을 비웁니다 */
 void update_recent_cpu_all(void)
 {
-	/* TODO :
-	recent_cpu = (2 * load_avg) / (2 * load_avg + 1) * recent_cpu + nice
-	와 같은 계산식을 사용하여 CPU 점유율을 다시 계산해야 합니다
-	*/
 	struct list_elem *e;
+	fixed_t coeff = div_fp(
+		mul_fp_int(load_avg, 2),
+		add_fp_int(mul_fp_int(load_avg, 2), 1));
+
 	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
 	{
 		struct thread *entry = list_entry(e, struct thread, all_elem);
-		if (entry->status == THREAD_DYING || entry == idle_thread)
+		if (is_idle(entry))
 			continue;
-		fixed_t coeff = div_fp(
-			mul_fp_int(load_avg, 2),
-			add_fp_int(mul_fp_int(load_avg, 2), 1));
-
 		entry->recent_cpu = add_fp(
 			mul_fp(coeff, entry->recent_cpu),
 			int_to_fp(entry->nice));
+		update_priority(entry);
 	}
+
+	while (!list_empty(&mlfqs_dirty_list))
+		list_entry(list_pop_front(&mlfqs_dirty_list), struct thread, dirty_elem)->mlfqs_dirty = false;
 }
 
-/* 모든 스레드의 우선순위를 계산하는 함수입니다.
-mlfqs_on_tick에서 사용되어야 합니다 */
-void update_all_priority(void)
+/* 마지막 계산 뒤 recent_cpu가 바뀐 스레드들의 우선순위만 다시
+계산합니다. 4틱마다 호출되며, 그 사이 실행된 스레드 수만큼만 일합니다.
+레디 큐에 있는 스레드는 thread_change_priority()가 새 큐로 옮깁니다 */
+void update_changed_priority(void)
 {
-	// TODO : 모든 리스트 순회하며 update_priority 호출
-	struct list_elem *e;
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+	while (!list_empty(&mlfqs_dirty_list))
 	{
-		struct thread *entry = list_entry(e, struct thread, all_elem);
-		if (entry->status == THREAD_DYING || entry == idle_thread)
-			continue;
-		update_priority(entry);
+		struct thread *t = list_entry(list_pop_front(&mlfqs_dirty_list),
+									  struct thread, dirty_elem);
+		t->mlfqs_dirty = false;
+		update_priority(t);
 	}
-	compare_cur_next_priority();
 }
 
 /* Puts the current thread to sleep.  It will not be scheduled
@@ -351,12 +437,241 @@ void thread_unblock(struct thread *t)
 	old_level = intr_disable(); // 인터럽트 끄기 -> 레이스 컨디션 방지
 	ASSERT(t->status == THREAD_BLOCKED);
 
-	list_insert_ordered(&ready_list, &t->elem, compare_priority, NULL); // 우선순위 순으로 레디 큐에 저장
+	rq_push(t->cpu, t); // 마지막으로 돈 CPU의 레디 큐에 우선순위에 맞게 저장
 	t->status = THREAD_READY;
 
+	/* 다른 CPU의 큐에 넣었는데 그 CPU가 놀고 있거나 더 낮은 우선순위를
+	   돌리고 있으면 깨워서 다시 고르게 합니다 */
+	if (t->cpu != this_cpu() &&
+		(t->cpu->curr == t->cpu->idle || t->cpu->curr->priority < t->priority))
+		smp_send_reschedule(t->cpu);
+
 	intr_set_level(old_level); // 인터럽트 다시 켜기
 }
 
+static void
+rq_init(struct run_queue *rq)
+{
+	spin_init(&rq->lock);
+	for (int p = PRI_MIN; p <= PRI_MAX; p++)
+		list_init(&rq->queues[p]);
+	rq->bitmap = 0;
+	rq->cnt = 0;
+}
+
+/* RQ에서 T를 뺍니다. RQ의 락을 쥐고 있어야 합니다. */
+static void
+rq_unlink(struct run_queue *rq, struct thread *t)
+{
+	list_remove(&t->elem);
+	if (list_empty(&rq->queues[t->priority]))
+		rq->bitmap &= ~(1ULL << t->priority);
+	rq->cnt--;
+}
+
+/* T를 RQ에서 자기 우선순위 큐의 맨 뒤에 넣습니다. RQ의 락을 쥐고
+   있어야 합니다. */
+static void
+rq_link(struct run_queue *rq, struct thread *t)
+{
+	list_push_back(&rq->queues[t->priority], &t->elem);
+	rq->bitmap |= 1ULL << t->priority;
+	rq->cnt++;
+}
+
+/* T를 CPU의 레디 큐에 넣습니다. 인터럽트가 꺼진 상태여야 합니다. */
+static void
+rq_push(struct cpu *cpu, struct thread *t)
+{
+	struct run_queue *rq = &cpu->rq;
+
+	spin_lock(&rq->lock);
+	rq_link(rq, t);
+	t->cpu = cpu;
+	spin_unlock(&rq->lock);
+}
+
+/* 레디 큐에 있는 T가 속한 CPU의 큐 락을 잡고 그 CPU를 반환합니다.
+   락을 기다리는 사이에 다른 CPU가 T를 훔쳐 갈 수 있으므로 락을 잡은
+   뒤 t->cpu를 다시 보고, 바뀌었으면 새 CPU에서 다시 시도합니다.
+   인터럽트가 꺼진 상태여야 합니다. */
+static struct cpu *
+rq_lock_thread(struct thread *t)
+{
+	for (;;)
+	{
+		struct cpu *cpu = t->cpu;
+
+		spin_lock(&cpu->rq.lock);
+		if (t->cpu == cpu)
+			return cpu;
+		spin_unlock(&cpu->rq.lock);
+	}
+}
+
+/* CPU의 레디 큐에서 우선순위가 가장 높은 스레드를 꺼냅니다. 비어
+   있으면 NULL을 반환합니다. 인터럽트가 꺼진 상태여야 합니다. */
+static struct thread *
+rq_pop(struct cpu *cpu)
+{
+	struct run_queue *rq = &cpu->rq;
+	struct thread *t = NULL;
+	int p;
+
+	spin_lock(&rq->lock);
+	p = rq_max_priority(cpu);
+	if (p >= 0)
+	{
+		t = list_entry(list_front(&rq->queues[p]), struct thread, elem);
+		rq_unlink(rq, t);
+	}
+	spin_unlock(&rq->lock);
+	return t;
+}
+
+/* CPU의 레디 큐에 있는 스레드 중 가장 높은 우선순위를, 비어 있으면
+   -1을 반환합니다. */
+static int
+rq_max_priority(struct cpu *cpu)
+{
+	uint64_t bitmap = cpu->rq.bitmap;
+
+	if (bitmap == 0)
+		return -1;
+	return 63 - __builtin_clzll(bitmap);
+}
+
+/* CPU의 레디 큐에 있는 스레드 수. 큐 락을 잡고 읽습니다. */
+static int
+rq_len(struct cpu *cpu)
+{
+	int cnt;
+
+	spin_lock(&cpu->rq.lock);
+	cnt = cpu->rq.cnt;
+	spin_unlock(&cpu->rq.lock);
+	return cnt;
+}
+
+/* 레디 큐가 가장 짧은 CPU */
+static struct cpu *
+least_loaded_cpu(void)
+{
+	struct cpu *best = &cpus[0];
+	int best_len = rq_len(best);
+
+	for (int i = 1; i < cpu_cnt; i++)
+	{
+		int len = rq_len(&cpus[i]);
+
+		if (len < best_len)
+		{
+			best = &cpus[i];
+			best_len = len;
+		}
+	}
+	return best;
+}
+
+/* 현재 CPU를 뺀 나머지 중 레디 큐가 가장 긴 CPU. 없으면 NULL */
+static struct cpu *
+busiest_cpu(void)
+{
+	struct cpu *self = this_cpu(), *best = NULL;
+	int best_len = 0;
+
+	for (int i = 0; i < cpu_cnt; i++)
+	{
+		int len;
+
+		if (&cpus[i] == self)
+			continue;
+		len = rq_len(&cpus[i]);
+		if (len > best_len)
+		{
+			best = &cpus[i];
+			best_len = len;
+		}
+	}
+	return best;
+}
+
+/* 타이머 틱에서 주기적으로 불립니다. 가장 바쁜 CPU의 큐가 이 CPU보다
+   2 이상 길면 하나를 이 CPU로 옮겨 옵니다. */
+static void
+balance_load(void)
+{
+	struct cpu *self = this_cpu();
+	struct cpu *victim = busiest_cpu();
+	struct thread *t;
+
+	if (victim == NULL || rq_len(victim) < rq_len(self) + 2)
+		return;
+	t = rq_pop(victim);
+	if (t != NULL)
+	{
+		rq_push(self, t);
+		self->migrations++;
+	}
+}
+
+/* T의 우선순위를 PRIORITY로 바꿉니다. T가 레디 큐에 있으면 새 우선순위의
+   큐 맨 뒤로 옮기고, wait_queue에서 잠들어 있으면 그 안에서 자리를 다시
+   잡습니다. 양보는 하지 않으므로 필요하면 호출자가
+   compare_cur_next_priority()를 부릅니다. */
+void thread_change_priority(struct thread *t, int priority)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (t->status == THREAD_READY && t->priority != priority)
+	{
+		/* 빼고 다시 넣는 사이에 다른 CPU가 T를 가져가지 못하도록 같은
+		   락 안에서 옮깁니다 */
+		struct cpu *cpu = rq_lock_thread(t);
+
+		rq_unlink(&cpu->rq, t);
+		t->priority = priority;
+		rq_link(&cpu->rq, t);
+		spin_unlock(&cpu->rq.lock);
+	}
+	else if (t->priority != priority)
+	{
+		t->priority = priority;
+		wait_queue_update(t);
+	}
+	intr_set_level(old_level);
+}
+
+/* T의 우선순위를 원래 우선순위와, 잡고 있는 락들이 기부받은 우선순위
+   중 큰 값으로 다시 맞춥니다. 바뀌었으면 true를 반환합니다. 인터럽트가
+   꺼진 상태에서 불러야 합니다. */
+bool thread_refresh_priority(struct thread *t)
+{
+	struct heap_elem *top = heap_top(&t->held_locks);
+	int priority = t->original_priority;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (top != NULL)
+	{
+		int donated = heap_entry(top, struct hold, elem)->priority;
+		if (donated > priority)
+			priority = donated;
+	}
+
+	if (priority == t->priority)
+		return false;
+	thread_change_priority(t, priority);
+	return true;
+}
+
+/* held_locks 힙의 비교 함수. 기부받은 우선순위가 큰 락이 위로 옵니다. */
+static bool held_lock_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	return heap_entry(a, struct hold, elem)->priority <
+		   heap_entry(b, struct hold, elem)->priority;
+}
+
 static bool compare_priority(const struct list_elem *a, const struct list_elem *b, void *aux)
 {
 	struct thread *t1 = list_entry(a, struct thread, elem);
@@ -427,6 +742,11 @@ void thread_exit(void)
 	/* Just set our status to dying and schedule another process.
 	   We will be destroyed during the call to schedule_tail(). */
 	intr_disable();
+	/* 페이지가 해제된 뒤 MLFQS가 이 스레드를 보지 않도록 목록에서 뺍니다 */
+	struct thread *cur = thread_current();
+	list_remove(&cur->all_elem);
+	if (cur->mlfqs_dirty)
+		list_remove(&cur->dirty_elem);
 	do_schedule(THREAD_DYING);
 	NOT_REACHED();
 }
@@ -439,13 +759,20 @@ void thread_yield(void)
 	struct thread *curr = thread_current();
 	enum intr_level old_level;
 	// dprintf("현재 실행 쓰레드 : %s\n", thread_name());
-	// dprintf("현재 레디 리스트 사이즈 : %d\n", list_size(&ready_list));
 
 	ASSERT(!intr_context());
 
+	/* RCU 읽기 구간 안에서 문맥을 바꾸면 유예 기간이 끝나 버리므로 구간이
+	   끝날 때까지 미룹니다 */
+	if (curr->rcu_nesting > 0)
+	{
+		curr->rcu_resched = true;
+		return;
+	}
+
 	old_level = intr_disable();
-	if (curr != idle_thread)
-		list_insert_ordered(&ready_list, &curr->elem, compare_priority, NULL);
+	if (curr != this_cpu()->idle)
+		rq_push(this_cpu(), curr);
 	do_schedule(THREAD_READY);
 	intr_set_level(old_level);
 }
@@ -458,35 +785,17 @@ void thread_set_priority(int new_priority)
 		return;
 
 	// (기존 donation 처리 등은 기본 스케줄러일 때만 유효)
-	struct thread *cur = thread_current();
+	enum intr_level old_level = intr_disable();
 	thread_current()->original_priority = new_priority;
-
-	if (list_empty(&cur->donations))
-	{
-		cur->priority = new_priority;
-	}
-	else
-	{
-		int first_priority = list_entry(list_front(&cur->donations), donation, elem)->priority;
-		if (first_priority > new_priority)
-			cur->priority = first_priority;
-		else
-			cur->priority = new_priority;
-	}
+	thread_refresh_priority(thread_current());
+	intr_set_level(old_level);
 
 	compare_cur_next_priority();
 }
 
 void compare_cur_next_priority(void)
 {
-	if (list_empty(&ready_list))
-	{
-		return;
-	}
-
-	list_sort(&ready_list, compare_priority, NULL);
-	struct thread *next = list_entry(list_front(&ready_list), struct thread, elem);
-	if (next->priority > thread_current()->priority)
+	if (rq_max_priority(this_cpu()) > thread_current()->priority)
 	{
 		if (intr_context())
 			intr_yield_on_return();
@@ -510,7 +819,7 @@ void thread_set_nice(int nice UNUSED)
 	// nice값이 바뀌었으니 priority도 다시 계산함
 	update_priority(cur);
 
-	// 만약 ready_list에 더 높은 priority가 있으면 양보
+	// 만약 레디 큐에 더 높은 priority가 있으면 양보
 	compare_cur_next_priority();
 }
 
@@ -520,6 +829,16 @@ int thread_get_nice(void)
 	return thread_current()->nice;
 }
 
+/* 현재 스레드가 속한 프로세스의 자원 사용량을 반환합니다. */
+struct thread_usage *thread_usage(void)
+{
+	struct thread *t = thread_current();
+#ifdef USERPROG
+	t = thread_leader(t);
+#endif
+	return &t->usage;
+}
+
 /* Returns 100 times the system load average. */
 int thread_get_load_avg(void)
 {
@@ -546,8 +865,45 @@ idle(void *idle_started_ UNUSED)
 {
 	struct semaphore *idle_started = idle_started_;
 
-	idle_thread = thread_current();
+	this_cpu()->idle = thread_current();
 	sema_up(idle_started);
+	idle_loop();
+}
+
+/* AP인 CPU의 idle 스레드를 만들어 반환합니다. smp_init()이 AP를
+   깨우기 전에 부르며, AP는 이 스레드의 스택에서 ap_main()을
+   시작합니다. 메모리가 모자라면 NULL을 반환합니다. */
+struct thread *
+thread_create_idle(struct cpu *cpu)
+{
+	struct thread *t = palloc_get_page(PAL_ZERO);
+
+	if (t == NULL)
+		return NULL;
+	init_thread(t, "idle", PRI_MIN);
+	t->status = THREAD_RUNNING;
+	t->cpu = cpu;
+	t->tid = allocate_tid();
+	cpu->idle = cpu->curr = t;
+	return t;
+}
+
+/* ap_main()이 빅 커널 락을 쥔 채로 부릅니다. 이 AP의 idle 스레드가
+   되어 스케줄링에 참여합니다. */
+void thread_start_ap(void)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(thread_current() == this_cpu()->idle);
+
+	idle_loop();
+}
+
+/* idle 스레드의 본체. 빅 커널 락은 hlt로 쉬는 동안만 놓습니다. */
+static void
+idle_loop(void)
+{
+	/* tickless idle은 PIT를 쓰는 BSP만 합니다 */
+	bool bsp = this_cpu() == &cpus[0];
 
 	for (;;)
 	{
@@ -567,7 +923,14 @@ idle(void *idle_started_ UNUSED)
 
 		   See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
 		   7.11.1 "HLT Instruction". */
+		if (bsp)
+			timer_idle_enter();
+		bkl_release();
 		asm volatile("sti; hlt" : : : "memory");
+		intr_disable();
+		bkl_acquire();
+		if (bsp)
+			timer_idle_exit();
 	}
 }
 
@@ -599,7 +962,7 @@ init_thread(struct thread *t, const char *name, int priority)
 	t->original_priority = priority;
 	t->pending_lock = NULL;
 	t->magic = THREAD_MAGIC;
-	t->user_rsp = NULL;
+	t->cpu = this_cpu();
 
 	if (thread_mlfqs)
 	{
@@ -618,10 +981,18 @@ init_thread(struct thread *t, const char *name, int priority)
 	}
 
 	list_init(&t->children_list);
-	list_init(&t->donations);
+	heap_init(&t->held_locks, held_lock_less, NULL);
+	/* 타이머 인터럽트가 all_list를 훑으므로 인터럽트를 끄고 넣습니다 */
+	enum intr_level old_level = intr_disable();
 	list_push_back(&all_list, &t->all_elem);
+	intr_set_level(old_level);
 	sema_init(&t->wait_sema, 0);
 	sema_init(&t->free_sema, 0);
+#ifdef USERPROG
+	lock_init(&t->clone_lock);
+	cond_init(&t->clone_done);
+	list_init(&t->clones);
+#endif
 }
 
 /* Chooses and returns the next thread to be scheduled.  Should
@@ -632,15 +1003,36 @@ init_thread(struct thread *t, const char *name, int priority)
 static struct thread *
 next_thread_to_run(void)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
-	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+	struct cpu *cpu = this_cpu();
+	struct thread *next = rq_pop(cpu);
+
+	/* 내 큐가 비었으면 가장 바쁜 CPU에서 하나 훔쳐 옵니다 */
+	if (next == NULL)
+	{
+		struct cpu *victim = busiest_cpu();
+
+		if (victim != NULL && (next = rq_pop(victim)) != NULL)
+		{
+			cpu->steals++;
+			cpu->migrations++;
+		}
+	}
+	if (next == NULL)
+		return cpu->idle;
+	next->cpu = cpu;
+	return next;
 }
 
 /* Use iretq to launch the thread */
 void do_iret(struct intr_frame *tf)
 {
+	/* 유저 모드로 내려가면 빅 커널 락을 놓습니다 */
+	if ((tf->cs & 3) == 3)
+	{
+		intr_disable();
+		bkl_release();
+	}
+
 	__asm __volatile(
 		"movq %0, %%rsp\n"
 		"movq 0(%%rsp),%%r15\n"
@@ -758,16 +1150,22 @@ static void
 schedule(void)
 {
 	struct thread *curr = running_thread();
-	struct thread *next = next_thread_to_run();
+	struct thread *next;
+
+	/* 문맥 전환은 RCU quiescent state입니다. 읽기 구간 안에서는 잠들 수 없습니다 */
+	ASSERT(curr->rcu_nesting == 0);
+	rcu_qs();
+	next = next_thread_to_run();
 
 	ASSERT(intr_get_level() == INTR_OFF);
 	ASSERT(curr->status != THREAD_RUNNING);
 	ASSERT(is_thread(next));
 	/* Mark us as running. */
 	next->status = THREAD_RUNNING;
+	next->cpu->curr = next;
 
 	/* Start new time slice. */
-	thread_ticks = 0;
+	next->cpu->thread_ticks = 0;
 
 #ifdef USERPROG
 	/* Activate the new address space. */
@@ -804,4 +1202,4 @@ allocate_tid(void)
 	lock_release(&tid_lock);
 
 	return tid;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -11,6 +11,19 @@ static long long page_fault_cnt;
 
 static void kill(struct intr_frame *);
 static void page_fault(struct intr_frame *);
+static bool fixup_exception(struct intr_frame *);
+
+/* 예외 테이블 엔트리. INSN에서 폴트가 나면 FIXUP에서 실행을 재개합니다.
+   엔트리는 usercopy.S 등에서 __ex_table 섹션에 등록합니다. */
+struct exception_table_entry
+{
+	uint64_t insn;
+	uint64_t fixup;
+};
+
+/* kernel.lds.S가 제공하는 __ex_table 섹션의 시작과 끝 */
+extern const struct exception_table_entry __start_ex_table[];
+extern const struct exception_table_entry __stop_ex_table[];
 
 /* 사용자 프로그램에 의해 발생할 수 있는 인터럽트에 대한 핸들러를 등록합니다.
 
@@ -133,9 +146,6 @@ kill(struct intr_frame *f)
 static void
 page_fault(struct intr_frame *f)
 {
-	if (f->cs == SEL_UCSEG) {
-		thread_current()->user_rsp = f->rsp;
-	}
 	bool not_present; /* True: not-present page, false: writing r/o page. */
 	bool write;		  /* True: access was write, false: access was read. */
 	bool user;		  /* True: access by user, false: access by kernel. */
@@ -157,12 +167,19 @@ page_fault(struct intr_frame *f)
 	write = (f->error_code & PF_W) != 0;
 	user = (f->error_code & PF_U) != 0;
 
+	thread_usage()->page_faults++;
+
 #ifdef VM
 	/* For project 3 and later. */
 	if (vm_try_handle_fault(f, fault_addr, user, write, not_present))
 		return;
 #endif
 
+	/* copy_from_user() 등 유저 메모리 접근 루틴에서 난 폴트라면
+	   예외 테이블의 복구 지점으로 돌아가 호출자에게 실패를 알립니다. */
+	if (!user && fixup_exception(f))
+		return;
+
 	/* Count page faults. */
 	page_fault_cnt++;
 
@@ -174,3 +191,19 @@ page_fault(struct intr_frame *f)
 		   user ? "user" : "kernel");
 	kill(f);
 }
+
+/* F의 rip가 예외 테이블에 등록된 명령어라면 rip를 복구 주소로 옮기고
+   true를 반환합니다. 테이블은 몇 개의 엔트리뿐이므로 선형 탐색합니다. */
+static bool
+fixup_exception(struct intr_frame *f)
+{
+	const struct exception_table_entry *e;
+
+	for (e = __start_ex_table; e < __stop_ex_table; e++)
+		if (e->insn == f->rip)
+		{
+			f->rip = e->fixup;
+			return true;
+		}
+	return false;
+}
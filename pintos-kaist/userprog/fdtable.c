@@ -0,0 +1,282 @@
+#include "userprog/fdtable.h"
+#include <debug.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/rcu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "userprog/pipe.h"
+#include "userprog/process.h"
+
+/* 프로세스별 파일 디스크립터 테이블.
+ *
+ * fd_table은 필요할 때 두 배씩 늘어나며(최대 MAX_FD), 사용 중인 fd는
+ * fd_map 비트맵에 표시합니다. 가장 낮은 빈 fd는 비트맵을 64비트 워드
+ * 단위로 훑어 찾고, fork/exit은 켜진 비트만 따라가므로 열린 fd 수에
+ * 비례하는 시간이 듭니다.
+ *
+ * clone()으로 만든 스레드는 프로세스 첫 스레드(leader)의 테이블을 함께
+ * 쓰므로, 아래 함수들은 넘겨받은 스레드 대신 그 leader의 테이블을 다루고
+ * leader의 fd_lock 아래에서 바꿉니다.
+ *
+ * 테이블의 각 자리는 파일의 참조를 하나씩 쥡니다. fdt_get()은 읽기 구간
+ * 안에서 참조를 하나 더 잡아 돌려주므로, 그사이 다른 스레드가 그 fd를
+ * 닫아도 파일은 fdt_put()으로 마지막 참조가 놓일 때 닫힙니다. 콘솔
+ * 표식(STDIN, STDOUT)은 참조를 세지 않습니다.
+ *
+ * fdt_get()은 락 없이 RCU 읽기 구간에서 읽습니다. 테이블을 늘릴 때는 새
+ * 테이블을 게시한 뒤 fd_cap을 올리고, 옛 테이블은 유예 기간이 지난 뒤
+ * 해제합니다. 닫힌 파일의 구조체도 같은 식으로 유예 기간 뒤에 해제하므로,
+ * 읽기 구간에서 본 파일은 참조가 0이 되었더라도 읽을 수 있습니다. */
+
+/* 처음 잡는 슬롯 수. 비트맵 워드 하나에 맞춥니다. */
+#define FDT_INIT_CAP 64
+
+#define FDT_WORD_BITS 64
+#define FDT_WORDS(CAP) ((CAP) / FDT_WORD_BITS)
+
+/* 빈 테이블을 만듭니다. 메모리가 부족하면 false를 반환합니다. */
+bool fdt_init(struct thread *t)
+{
+	t->fd_table = calloc(FDT_INIT_CAP, sizeof *t->fd_table);
+	t->fd_map = calloc(FDT_WORDS(FDT_INIT_CAP), sizeof *t->fd_map);
+	if (t->fd_table == NULL || t->fd_map == NULL)
+	{
+		fdt_destroy(t);
+		return false;
+	}
+	t->fd_cap = FDT_INIT_CAP;
+	lock_init(&t->fd_lock);
+	return true;
+}
+
+/* 테이블 메모리를 해제합니다. 열린 파일은 호출자가 먼저 닫아야 합니다. */
+void fdt_destroy(struct thread *t)
+{
+	free(t->fd_table);
+	free(t->fd_map);
+	t->fd_table = NULL;
+	t->fd_map = NULL;
+	t->fd_cap = 0;
+}
+
+/* FILE이 참조를 세는 파일 객체면 true. NULL과 콘솔 표식은 false. */
+static bool
+is_counted(struct file *file)
+{
+	return file != NULL && file != (struct file *)STDIN && file != (struct file *)STDOUT;
+}
+
+/* FD에 대응하는 파일을 참조를 하나 잡아 반환합니다. 다 쓰면 fdt_put()으로
+ * 놓아야 합니다. 범위를 벗어나거나 비어 있으면 NULL. */
+struct file *
+fdt_get(struct thread *t, int fd)
+{
+	struct file *file = NULL;
+
+	t = thread_leader(t);
+	rcu_read_lock();
+	/* fd_cap을 먼저 읽으므로 그만큼은 담는 테이블이 보입니다 */
+	int cap = __atomic_load_n(&t->fd_cap, __ATOMIC_ACQUIRE);
+	struct file **table = rcu_dereference(t->fd_table);
+	if (fd >= 0 && fd < cap)
+		file = rcu_dereference(table[fd]);
+	/* 다른 스레드가 방금 자리를 비우고 마지막 참조까지 놓았으면 이미 닫힌
+	   fd로 봅니다 */
+	if (is_counted(file) && !file_ref_tryget(file))
+		file = NULL;
+	rcu_read_unlock();
+	return file;
+}
+
+static void
+fdt_free_file(struct rcu_head *head)
+{
+	free(list_entry(&head->elem, struct file, rcu.elem));
+}
+
+/* fdt_get()이나 fdt_clear()로 받은 FILE의 참조를 놓습니다. 마지막
+ * 참조였으면 파일을 닫습니다. NULL과 콘솔 표식은 무시합니다.
+ * 파일을 닫을 때 filesys_lock을 쓰기로 잡으므로 쥐지 않은 채 불러야
+ * 합니다. */
+void fdt_put(struct file *file)
+{
+	if (!is_counted(file) || !file_ref_drop(file))
+		return;
+
+	/* 닫는 일은 지금 하고, 구조체는 읽기 구간에서 이 파일을 본 fdt_get()이
+	   모두 빠져나간 뒤 해제합니다 */
+	if (file_is_pipe(file))
+		pipe_release(file);
+	else
+	{
+		/* inode_close()는 open_inodes와 free map을 고치므로 file_close()처럼
+		   배타적으로 닫습니다 */
+		rwlock_write_acquire(&filesys_lock);
+		file_release(file);
+		rwlock_write_release(&filesys_lock);
+	}
+	call_rcu(&file->rcu, fdt_free_file);
+}
+
+/* FD가 들어갈 수 있도록 테이블을 늘립니다. */
+static bool
+fdt_grow(struct thread *t, int fd)
+{
+	int cap = t->fd_cap;
+	struct file **table;
+	uint64_t *map;
+
+	if (fd < cap)
+		return true;
+	if (fd >= MAX_FD)
+		return false;
+	while (cap <= fd)
+		cap *= 2;
+	if (cap > MAX_FD)
+		cap = MAX_FD;
+
+	table = calloc(cap, sizeof *table);
+	map = calloc(FDT_WORDS(cap), sizeof *map);
+	if (table == NULL || map == NULL)
+	{
+		free(table);
+		free(map);
+		return false;
+	}
+	memcpy(table, t->fd_table, t->fd_cap * sizeof *table);
+	memcpy(map, t->fd_map, FDT_WORDS(t->fd_cap) * sizeof *map);
+	free(t->fd_map);
+	t->fd_map = map;
+
+	/* 새 테이블을 게시한 뒤에 옛 테이블을 넘겨야, 그 뒤에 시작한 fdt_get()이
+	   옛 테이블을 보지 않습니다 */
+	struct file **old = t->fd_table;
+	rcu_assign_pointer(t->fd_table, table);
+	__atomic_store_n(&t->fd_cap, cap, __ATOMIC_RELEASE);
+	rcu_free(old);
+	return true;
+}
+
+/* FILE을 FD 자리에 넣습니다. 호출자가 쥔 FILE의 참조 하나를 자리가
+ * 넘겨받습니다. fd_lock을 쥔 채로 불러야 합니다. */
+static bool
+fdt_install_locked(struct thread *t, int fd, struct file *file)
+{
+	if (fd < 0 || !fdt_grow(t, fd))
+		return false;
+	ASSERT(t->fd_table[fd] == NULL);
+	rcu_assign_pointer(t->fd_table[fd], file);
+	t->fd_map[fd / FDT_WORD_BITS] |= 1ULL << (fd % FDT_WORD_BITS);
+	return true;
+}
+
+/* FILE을 가장 낮은 빈 fd에 넣고 그 fd를 반환합니다. 실패하면 -1이며
+ * FILE의 참조는 호출자에게 남습니다. */
+int fdt_alloc(struct thread *t, struct file *file)
+{
+	int words, fd;
+
+	ASSERT(file != NULL);
+
+	t = thread_leader(t);
+	lock_acquire(&t->fd_lock);
+	words = FDT_WORDS(t->fd_cap);
+	fd = t->fd_cap;
+	for (int w = 0; w < words; w++)
+		if (~t->fd_map[w] != 0)
+		{
+			fd = w * FDT_WORD_BITS + __builtin_ctzll(~t->fd_map[w]);
+			break;
+		}
+	if (!fdt_install_locked(t, fd, file))
+		fd = -1;
+	lock_release(&t->fd_lock);
+	return fd;
+}
+
+/* FILE을 FD 자리에 넣습니다. FD 자리는 비어 있어야 합니다. 성공하면
+ * 호출자가 쥔 FILE의 참조를 자리가 넘겨받습니다. */
+bool fdt_install(struct thread *t, int fd, struct file *file)
+{
+	bool ok;
+
+	ASSERT(file != NULL);
+
+	t = thread_leader(t);
+	lock_acquire(&t->fd_lock);
+	ok = fdt_install_locked(t, fd, file);
+	lock_release(&t->fd_lock);
+	return ok;
+}
+
+/* FILE을 FD 자리에 넣고, 자리에 있던 파일을 그 참조와 함께 *OLD에
+ * 돌려줍니다(비어 있었으면 NULL). 비우기와 넣기가 fd_lock 한 번 안에서
+ * 일어나므로 그사이 다른 스레드가 FD를 차지할 수 없습니다. 성공하면
+ * 호출자가 쥔 FILE의 참조를 자리가 넘겨받습니다. */
+bool fdt_replace(struct thread *t, int fd, struct file *file, struct file **old)
+{
+	bool ok;
+
+	ASSERT(file != NULL);
+
+	*old = NULL;
+	t = thread_leader(t);
+	lock_acquire(&t->fd_lock);
+	ok = fd >= 0 && fdt_grow(t, fd);
+	if (ok)
+	{
+		*old = t->fd_table[fd];
+		rcu_assign_pointer(t->fd_table[fd], file);
+		t->fd_map[fd / FDT_WORD_BITS] |= 1ULL << (fd % FDT_WORD_BITS);
+	}
+	lock_release(&t->fd_lock);
+	return ok;
+}
+
+/* FD 자리를 비우고 거기 있던 파일을 그 자리가 쥐던 참조와 함께
+ * 반환합니다. 호출자가 fdt_put()으로 놓아야 합니다. 비어 있었으면
+ * NULL을 반환하므로, 두 스레드가 같은 fd를 동시에 닫아도 참조를 받는
+ * 쪽은 하나뿐입니다. */
+struct file *
+fdt_clear(struct thread *t, int fd)
+{
+	struct file *file = NULL;
+
+	t = thread_leader(t);
+	lock_acquire(&t->fd_lock);
+	if (fd >= 0 && fd < t->fd_cap)
+	{
+		file = t->fd_table[fd];
+		t->fd_table[fd] = NULL;
+		t->fd_map[fd / FDT_WORD_BITS] &= ~(1ULL << (fd % FDT_WORD_BITS));
+	}
+	lock_release(&t->fd_lock);
+	return file;
+}
+
+/* FD 이상인 열린 fd 중 가장 작은 것을 반환합니다. 없으면 -1. */
+int fdt_next(struct thread *t, int fd)
+{
+	int next = -1;
+
+	if (fd < 0)
+		fd = 0;
+	t = thread_leader(t);
+	lock_acquire(&t->fd_lock);
+	while (fd < t->fd_cap)
+	{
+		int w = fd / FDT_WORD_BITS;
+		uint64_t bits = t->fd_map[w] & (~0ULL << (fd % FDT_WORD_BITS));
+
+		if (bits != 0)
+		{
+			next = w * FDT_WORD_BITS + __builtin_ctzll(bits);
+			break;
+		}
+		fd = (w + 1) * FDT_WORD_BITS;
+	}
+	lock_release(&t->fd_lock);
+	return next;
+}
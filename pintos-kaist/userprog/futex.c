@@ -0,0 +1,161 @@
+#include "userprog/futex.h"
+#include <hash.h>
+#include <list.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "userprog/usercopy.h"
+#ifdef VM
+#include "vm/vm.h"
+#endif
+
+/* 퓨텍스.
+ *
+ * 유저 주소 하나를 키로 하는 대기 큐입니다. 경합이 없을 때 유저
+ * 프로그램은 원자 연산만으로 락을 잡고, 경합이 있을 때만 futex_wait()로
+ * 들어와 잠듭니다.
+ *
+ * 키는 보통 (pml4, 가상 주소)라서 같은 주소 공간을 쓰는 스레드끼리만
+ * 만납니다. 공유 메모리(shm) 페이지 위의 주소는 (세그먼트, 세그먼트 안
+ * 오프셋)을 키로 삼아서, 서로 다른 주소에 매핑한 프로세스끼리도 같은
+ * 큐에서 만납니다.
+ *
+ * 대기 큐는 키의 해시로 고른 버킷에 섞여 들어갑니다. 버킷 락을 쥔 채로
+ * 값을 확인하고 큐에 들어가므로, 값을 바꾼 뒤 futex_wake()를 부르는
+ * 쪽과 엇갈려도 깨우기를 놓치지 않습니다. */
+
+#define FUTEX_BUCKETS 64
+
+struct futex_key
+{
+	const void *space;	/* pml4 또는 shm 세그먼트 */
+	uintptr_t ofs;		/* space 안에서의 주소 */
+};
+
+/* futex_wait()로 잠든 스레드. 잠든 스레드의 스택에 있습니다. */
+struct futex_waiter
+{
+	struct futex_key key;
+	struct semaphore sema;
+	struct list_elem elem;	/* futex_bucket의 waiters 원소 */
+	bool queued;			/* 아직 waiters에 있으면 true */
+};
+
+struct futex_bucket
+{
+	struct lock lock;
+	struct list waiters;	/* 이 버킷에 해시된 모든 키의 대기자 */
+};
+
+static struct futex_bucket buckets[FUTEX_BUCKETS];
+
+void
+futex_init (void) {
+	for (int i = 0; i < FUTEX_BUCKETS; i++) {
+		lock_init (&buckets[i].lock);
+		list_init (&buckets[i].waiters);
+	}
+}
+
+/* UADDR의 키를 *KEY에 채웁니다. 정렬되지 않았거나 유저 주소가 아니면
+ * false를 반환합니다. */
+static bool
+futex_get_key (uint32_t *uaddr, struct futex_key *key) {
+	struct thread *cur = thread_current ();
+
+	if ((uintptr_t) uaddr % sizeof *uaddr != 0 || !is_user_vaddr (uaddr))
+		return false;
+#ifdef VM
+	struct page *page = spt_find_page (current_spt (), uaddr);
+	if (page != NULL && page_get_type (page) == VM_SHM) {
+		key->space = page->shm.seg;
+		key->ofs = page->shm.idx * PGSIZE + pg_ofs (uaddr);
+		return true;
+	}
+#endif
+	key->space = cur->pml4;
+	key->ofs = (uintptr_t) uaddr;
+	return true;
+}
+
+static struct futex_bucket *
+futex_bucket (const struct futex_key *key) {
+	return &buckets[hash_bytes (key, sizeof *key) % FUTEX_BUCKETS];
+}
+
+static bool
+futex_key_equal (const struct futex_key *a, const struct futex_key *b) {
+	return a->space == b->space && a->ofs == b->ofs;
+}
+
+/* *UADDR이 아직 VAL이면 futex_wake()가 깨울 때까지 잠듭니다.
+ * 깨어나면 0을, 값이 이미 바뀌어 잠들지 않았거나 스레드 그룹이 끝나서
+ * 깨어났으면 -1을 반환합니다. */
+int
+futex_wait (uint32_t *uaddr, uint32_t val) {
+	struct futex_waiter w;
+	struct futex_bucket *b;
+	uint32_t cur;
+
+	if (!futex_get_key (uaddr, &w.key))
+		return -1;
+	b = futex_bucket (&w.key);
+
+	lock_acquire (&b->lock);
+	if (!copy_from_user (&cur, uaddr, sizeof cur)) {
+		lock_release (&b->lock);
+		sys_exit (-1);
+	}
+	if (cur != val) {
+		lock_release (&b->lock);
+		return -1;
+	}
+	sema_init (&w.sema, 0);
+	w.queued = true;
+	list_push_back (&b->waiters, &w.elem);
+	lock_release (&b->lock);
+
+	if (process_sleep (&w.sema))
+		return 0;
+
+	/* futex_wake()가 빼 가지 않았으면 W가 스택에서 사라지기 전에
+	 * 직접 뺍니다 */
+	lock_acquire (&b->lock);
+	if (w.queued)
+		list_remove (&w.elem);
+	lock_release (&b->lock);
+	return -1;
+}
+
+/* UADDR에서 잠든 스레드를 먼저 잠든 순서대로 최대 CNT개 깨우고,
+ * 깨운 수를 반환합니다. */
+int
+futex_wake (uint32_t *uaddr, int cnt) {
+	struct futex_key key;
+	struct futex_bucket *b;
+	struct list_elem *e;
+	int woken = 0;
+
+	if (!futex_get_key (uaddr, &key))
+		return -1;
+	b = futex_bucket (&key);
+
+	lock_acquire (&b->lock);
+	for (e = list_begin (&b->waiters); e != list_end (&b->waiters) && woken < cnt;) {
+		struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+
+		if (!futex_key_equal (&w->key, &key)) {
+			e = list_next (e);
+			continue;
+		}
+		/* 큐에서 먼저 빼야 합니다. sema_up 뒤에는 W가 사라질 수 있습니다. */
+		e = list_remove (e);
+		w->queued = false;
+		sema_up (&w->sema);
+		woken++;
+	}
+	lock_release (&b->lock);
+	return woken;
+}
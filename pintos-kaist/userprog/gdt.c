@@ -1,6 +1,8 @@
 #include "userprog/gdt.h"
 #include <debug.h>
+#include <string.h>
 #include "userprog/tss.h"
+#include "threads/cpu.h"
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -19,7 +21,10 @@
  * types of segments are of interest: code, data, and TSS or
  * Task-State Segment descriptors.  The former two types are
  * exactly what they sound like.  The TSS is used primarily for
- * stack switching on interrupts. */
+ * stack switching on interrupts.
+ *
+ * Every CPU has its own TSS, so every CPU gets its own copy of
+ * the GDT below, differing only in the TSS descriptor. */
 
 struct segment_desc {
 	unsigned lim_15_0 : 16;
@@ -72,19 +77,25 @@ static struct segment_desc gdt[SEL_CNT] = {
 	[7] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
 };
 
-struct desc_ptr gdt_ds = {
-	.size = sizeof(gdt) - 1,
-	.address = (uint64_t) gdt
-};
+/* Per-CPU copies of GDT. */
+static struct segment_desc cpu_gdt[NCPU_MAX][SEL_CNT];
 
-/* Sets up a proper GDT.  The bootstrap loader's GDT didn't
-   include user-mode selectors or a TSS, but we need both now. */
+/* Sets up a proper GDT for this CPU.  The bootstrap loader's GDT
+   didn't include user-mode selectors or a TSS, but we need both
+   now.  Call after tss_init(). */
 void
 gdt_init (void) {
 	/* Initialize GDT. */
+	struct segment_desc *my_gdt = cpu_gdt[this_cpu ()->id];
 	struct segment_descriptor64 *tss_desc =
-		(struct segment_descriptor64 *) &gdt[SEL_TSS >> 3];
+		(struct segment_descriptor64 *) &my_gdt[SEL_TSS >> 3];
 	struct task_state *tss = tss_get ();
+	struct desc_ptr gdt_ds = {
+		.size = sizeof gdt - 1,
+		.address = (uint64_t) my_gdt
+	};
+
+	memcpy (my_gdt, gdt, sizeof gdt);
 
 	*tss_desc = (struct segment_descriptor64) {
 		.lim_15_0 = (uint64_t) (sizeof (struct task_state)) & 0xffff,
@@ -0,0 +1,310 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/process.h"
+#include "lib/user/syscall.h"
+
+/* 파이프.
+ *
+ * 데이터는 한 페이지짜리 링 버퍼에 담깁니다. head는 읽는 쪽만, tail은
+ * 쓰는 쪽만 바꾸므로 읽는 쪽과 쓰는 쪽은 락 없이 동시에 진행합니다.
+ * 같은 쪽 끝을 여러 프로세스가 나눠 가진 경우(fork 뒤)에만 끝마다
+ * 하나씩 있는 락에서 서로 기다립니다.
+ *
+ * 버퍼가 비었거나 가득 차서 잠들 때는 *_waiting을 먼저 세우고 상태를
+ * 다시 확인한 뒤 세마포어에서 잠듭니다. 상대편은 인덱스를 옮긴 다음
+ * *_waiting을 확인하므로 깨우기를 놓치지 않습니다. */
+
+#define PIPE_SIZE PGSIZE
+
+struct pipe
+{
+	uint8_t *buf;			   /* PIPE_SIZE 바이트 링 버퍼 */
+	uint32_t head;			   /* 다음에 읽을 위치, 읽는 쪽만 바꿈 */
+	uint32_t tail;			   /* 다음에 쓸 위치, 쓰는 쪽만 바꿈 */
+	int readers;			   /* 열린 읽기 끝 수 */
+	int writers;			   /* 열린 쓰기 끝 수 */
+	bool reader_waiting;	   /* 읽는 쪽이 not_empty에서 잠들려 함 */
+	bool writer_waiting;	   /* 쓰는 쪽이 not_full에서 잠들려 함 */
+	struct semaphore not_empty;
+	struct semaphore not_full;
+	struct lock read_lock;	   /* 읽는 쪽끼리 직렬화 */
+	struct lock write_lock;	   /* 쓰는 쪽끼리 직렬화 */
+	struct poll_queue pollers; /* poll()로 이 파이프를 기다리는 스레드 */
+};
+
+#define full_barrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* PIPE의 한쪽 끝을 나타내는 struct file을 만듭니다. */
+static struct file *
+pipe_end_open(struct pipe *pipe, bool writer)
+{
+	struct file *end = calloc(1, sizeof *end);
+
+	if (end == NULL)
+		return NULL;
+	end->pipe = pipe;
+	end->pipe_writer = writer;
+	end->ref_cnt = 1;
+	return end;
+}
+
+/* 새 파이프를 만들고 읽기 끝과 쓰기 끝을 돌려줍니다. */
+bool pipe_create(struct file **read_end, struct file **write_end)
+{
+	struct pipe *pipe = malloc(sizeof *pipe);
+
+	if (pipe == NULL)
+		return false;
+	pipe->buf = palloc_get_page(0);
+	if (pipe->buf == NULL)
+	{
+		free(pipe);
+		return false;
+	}
+	pipe->head = pipe->tail = 0;
+	pipe->readers = pipe->writers = 1;
+	pipe->reader_waiting = pipe->writer_waiting = false;
+	sema_init(&pipe->not_empty, 0);
+	sema_init(&pipe->not_full, 0);
+	lock_init(&pipe->read_lock);
+	lock_init(&pipe->write_lock);
+	poll_queue_init(&pipe->pollers);
+
+	*read_end = pipe_end_open(pipe, false);
+	*write_end = pipe_end_open(pipe, true);
+	if (*read_end == NULL || *write_end == NULL)
+	{
+		free(*read_end);
+		free(*write_end);
+		palloc_free_page(pipe->buf);
+		free(pipe);
+		return false;
+	}
+	return true;
+}
+
+/* 상대편이 잠들려 하고 있으면 깨웁니다. */
+static void
+wake(bool *waiting, struct semaphore *sema)
+{
+	full_barrier();
+	if (*waiting)
+	{
+		*waiting = false;
+		sema_up(sema);
+	}
+}
+
+/* END와 같은 쪽을 가리키는 새 끝을 만듭니다. fork가 사용합니다. */
+struct file *
+pipe_duplicate(struct file *end)
+{
+	struct pipe *pipe = end->pipe;
+	struct file *dup = pipe_end_open(pipe, end->pipe_writer);
+	enum intr_level old_level;
+
+	if (dup == NULL)
+		return NULL;
+	old_level = intr_disable();
+	if (end->pipe_writer)
+		pipe->writers++;
+	else
+		pipe->readers++;
+	intr_set_level(old_level);
+	return dup;
+}
+
+/* END를 닫고 END도 해제합니다. */
+void pipe_close(struct file *end)
+{
+	pipe_release(end);
+	free(end);
+}
+
+/* END를 닫습니다. 마지막 쓰기 끝이면 읽는 쪽이 EOF를, 마지막 읽기
+ * 끝이면 쓰는 쪽이 실패를 보도록 깨우고, 양쪽이 다 닫히면 파이프를
+ * 해제합니다. END 자체는 해제하지 않습니다. */
+void pipe_release(struct file *end)
+{
+	struct pipe *pipe = end->pipe;
+	enum intr_level old_level;
+	bool last;
+
+	/* 깨우기까지 인터럽트를 끈 채로 해서, 그 사이에 상대편이 마지막
+	 * 끝을 닫고 파이프를 해제하는 일이 없도록 합니다. */
+	old_level = intr_disable();
+	if (end->pipe_writer)
+	{
+		if (--pipe->writers == 0)
+			wake(&pipe->reader_waiting, &pipe->not_empty);
+	}
+	else
+	{
+		if (--pipe->readers == 0)
+			wake(&pipe->writer_waiting, &pipe->not_full);
+	}
+	poll_queue_wake(&pipe->pollers);
+	last = pipe->readers == 0 && pipe->writers == 0;
+	intr_set_level(old_level);
+
+	if (last)
+	{
+		palloc_free_page(pipe->buf);
+		free(pipe);
+	}
+}
+
+/* 최대 SIZE 바이트를 읽습니다. 버퍼가 비어 있으면 데이터가 들어오거나
+ * 쓰기 끝이 모두 닫힐 때까지 기다립니다. 읽은 바이트 수를 반환하며,
+ * 0이면 EOF입니다. */
+int pipe_read(struct file *end, void *buf_, size_t size)
+{
+	struct pipe *pipe = end->pipe;
+	uint8_t *buf = buf_;
+	size_t done = 0;
+
+	if (end->pipe_writer)
+		return -1;
+	if (size == 0)
+		return 0;
+
+	lock_acquire(&pipe->read_lock);
+	for (;;)
+	{
+		uint32_t avail = __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE) - pipe->head;
+
+		if (avail > 0)
+		{
+			while (done < size && avail > 0)
+			{
+				uint32_t ofs = pipe->head % PIPE_SIZE;
+				size_t n = PIPE_SIZE - ofs;
+
+				if (n > avail)
+					n = avail;
+				if (n > size - done)
+					n = size - done;
+				memcpy(buf + done, pipe->buf + ofs, n);
+				__atomic_store_n(&pipe->head, pipe->head + n, __ATOMIC_RELEASE);
+				done += n;
+				avail -= n;
+			}
+			break;
+		}
+		if (pipe->writers == 0)
+			break;
+
+		pipe->reader_waiting = true;
+		full_barrier();
+		if (pipe->tail != pipe->head || pipe->writers == 0)
+		{
+			pipe->reader_waiting = false;
+			continue;
+		}
+		/* 스레드 그룹이 끝나는 중이면 읽은 데까지만 돌려줍니다 */
+		if (!process_sleep(&pipe->not_empty))
+		{
+			pipe->reader_waiting = false;
+			break;
+		}
+	}
+	lock_release(&pipe->read_lock);
+
+	if (done > 0)
+	{
+		wake(&pipe->writer_waiting, &pipe->not_full);
+		poll_queue_wake(&pipe->pollers);
+	}
+	return done;
+}
+
+/* SIZE 바이트를 모두 쓸 때까지 기다리며 씁니다. 도중에 읽기 끝이 모두
+ * 닫히면 그때까지 쓴 바이트 수를, 하나도 못 썼으면 -1을 반환합니다. */
+int pipe_write(struct file *end, const void *buf_, size_t size)
+{
+	struct pipe *pipe = end->pipe;
+	const uint8_t *buf = buf_;
+	size_t done = 0;
+
+	if (!end->pipe_writer)
+		return -1;
+
+	lock_acquire(&pipe->write_lock);
+	while (done < size && pipe->readers > 0)
+	{
+		uint32_t space = PIPE_SIZE - (pipe->tail - __atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE));
+
+		if (space > 0)
+		{
+			uint32_t ofs = pipe->tail % PIPE_SIZE;
+			size_t n = PIPE_SIZE - ofs;
+
+			if (n > space)
+				n = space;
+			if (n > size - done)
+				n = size - done;
+			memcpy(pipe->buf + ofs, buf + done, n);
+			__atomic_store_n(&pipe->tail, pipe->tail + n, __ATOMIC_RELEASE);
+			done += n;
+			wake(&pipe->reader_waiting, &pipe->not_empty);
+			poll_queue_wake(&pipe->pollers);
+			continue;
+		}
+
+		pipe->writer_waiting = true;
+		full_barrier();
+		if (pipe->tail - pipe->head < PIPE_SIZE || pipe->readers == 0)
+		{
+			pipe->writer_waiting = false;
+			continue;
+		}
+		if (!process_sleep(&pipe->not_full))
+		{
+			pipe->writer_waiting = false;
+			break;
+		}
+	}
+	lock_release(&pipe->write_lock);
+
+	if (done == 0 && size > 0)
+		return -1;
+	return done;
+}
+
+/* END가 지금 막힘 없이 할 수 있는 일을 POLL* 비트로 돌려줍니다. */
+short pipe_poll(struct file *end)
+{
+	struct pipe *pipe = end->pipe;
+	uint32_t used = __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE);
+	short revents = 0;
+
+	if (end->pipe_writer)
+	{
+		if (pipe->readers == 0)
+			revents |= POLLERR;
+		else if (used < PIPE_SIZE)
+			revents |= POLLOUT;
+	}
+	else
+	{
+		if (used > 0)
+			revents |= POLLIN;
+		if (pipe->writers == 0)
+			revents |= POLLHUP;
+	}
+	return revents;
+}
+
+/* END의 상태가 바뀔 때 깨워지는 큐를 돌려줍니다. */
+struct poll_queue *
+pipe_poll_queue(struct file *end)
+{
+	return &end->pipe->pollers;
+}
@@ -7,6 +7,11 @@
 #include <string.h>
 #include "userprog/gdt.h"
 #include "userprog/tss.h"
+#include "userprog/uring.h"
+#include "userprog/vdso.h"
+#include "userprog/fdtable.h"
+#include "userprog/pipe.h"
+#include "userprog/syscall.h"
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
@@ -30,6 +35,12 @@ static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
 static void __do_fork(void *);
+static void __do_spawn(void *);
+static void __do_clone(void *);
+static void release_children(struct thread *);
+static bool process_load(void *f_name, struct intr_frame *if_);
+static struct file *duplicate_fd_object(struct file *file);
+static void close_fd_object(struct file *file);
 static int parse_args(char *, char *[]);
 static bool setup_stack(struct intr_frame *if_);
 static struct thread *get_my_child(tid_t tid);
@@ -38,14 +49,10 @@ static struct thread *get_my_child(tid_t tid);
 static void process_init(void)
 {
 	struct thread *current = thread_current();
-	// current->fd_table = calloc(MAX_FD, sizeof(struct file *));
-	current->fd_table = palloc_get_multiple(PAL_ZERO, FDT_PAGES);
-	current->fd_idx = 2;
-	current->fd_table[0] = STDIN;
-	current->fd_table[1] = STDOUT;
-	current->stdin_count = 1;
-	current->stdout_count = 1;
-	ASSERT(current->fd_table != NULL);
+	bool ok = fdt_init(current);
+	ASSERT(ok);
+	fdt_install(current, 0, (struct file *)STDIN);
+	fdt_install(current, 1, (struct file *)STDOUT);
 	sema_init(&current->fork_sema, 0);
 }
 
@@ -95,6 +102,183 @@ initd(void *f_name)
 	NOT_REACHED();
 }
 
+/* spawn()이 자식에게 넘기는 정보. 부모는 자식이 로드를 마칠 때까지
+ * 기다리므로 부모 스택에 둡니다. */
+struct spawn_info
+{
+	struct thread *parent;
+	char *cmd_line;	   /* palloc 페이지, 자식이 해제 */
+	const int *fd_map; /* 자식 fd i = 부모 fd fd_map[i], 음수면 비움 */
+	int nfds;		   /* fd_map 길이, fd_map이 NULL이면 무시 */
+};
+
+/* CMD_LINE을 실행하는 자식 프로세스를 바로 만듭니다. fork() 직후
+ * exec()하는 것과 같지만 부모의 주소 공간과 fd 테이블을 복제했다가
+ * 버리는 일이 없습니다. 자식은 FD_MAP이 가리키는 부모의 fd만 물려받고,
+ * FD_MAP이 NULL이면 콘솔 fd 0, 1만 가집니다. CMD_LINE은 palloc 페이지로,
+ * 이 함수가 소유권을 가져갑니다.
+ * 자식이 로드까지 마친 뒤 tid를, 실패하면 TID_ERROR를 반환합니다. */
+tid_t process_spawn(char *cmd_line, const int *fd_map, int nfds)
+{
+	struct thread *parent = thread_current();
+	struct spawn_info info = {parent, cmd_line, fd_map, nfds};
+	char name[sizeof parent->name];
+	char *save_ptr;
+	tid_t tid;
+
+	strlcpy(name, cmd_line, sizeof name);
+	strtok_r(name, " ", &save_ptr);
+
+	tid = thread_create(name, PRI_DEFAULT, __do_spawn, &info);
+	if (tid == TID_ERROR)
+	{
+		palloc_free_page(cmd_line);
+		return TID_ERROR;
+	}
+
+	sema_down(&parent->fork_sema);
+	if (get_my_child(tid)->exit_status == TID_ERROR)
+		return TID_ERROR;
+	return tid;
+}
+
+/* spawn()으로 만든 자식의 스레드 함수. 부모가 fork_sema에서 기다리는
+ * 동안 필요한 fd만 복제하고 실행 파일을 로드한 뒤 부모를 깨웁니다. */
+static void
+__do_spawn(void *aux)
+{
+	struct spawn_info *info = aux;
+	struct thread *parent = info->parent;
+	struct thread *current = thread_current();
+	struct intr_frame if_;
+	bool succ = true;
+
+#ifdef VM
+	supplemental_page_table_init(&current->spt);
+#endif
+	process_init();
+
+	if (info->fd_map != NULL)
+	{
+		fdt_clear(current, 0);
+		fdt_clear(current, 1);
+		for (int fd = 0; fd < info->nfds && succ; fd++)
+		{
+			struct file *parent_file = fdt_get(parent, info->fd_map[fd]);
+			struct file *file;
+
+			if (parent_file == NULL)
+				continue;
+			file = duplicate_fd_object(parent_file);
+			fdt_put(parent_file);
+			if (file == NULL || !fdt_install(current, fd, file))
+			{
+				close_fd_object(file);
+				succ = false;
+			}
+		}
+	}
+
+	if (succ)
+		succ = process_load(info->cmd_line, &if_);
+	else
+		palloc_free_page(info->cmd_line);
+
+	/* 부모가 깨어나 읽기 전에 실패를 기록해 둡니다. */
+	if (!succ)
+		current->exit_status = TID_ERROR;
+	sema_up(&parent->fork_sema);
+	if (succ)
+		do_iret(&if_);
+	sys_exit(TID_ERROR);
+}
+
+/* clone()이 새 스레드에게 넘기는 정보 */
+struct clone_info
+{
+	struct thread *leader;
+	struct intr_frame if_; /* 새 스레드가 유저 모드로 들어갈 때의 레지스터 */
+};
+
+/* 현재 프로세스 안에 유저 스레드를 하나 더 만듭니다. 새 스레드는 같은
+ * pml4, SPT, fd 테이블을 쓰며, 스택 STACK 위에서 ENTRY(ARG0, ARG1)로
+ * 시작합니다. 나머지 레지스터는 IF_에서 물려받습니다.
+ * 새 스레드의 tid를, 실패하면 TID_ERROR를 반환합니다. */
+tid_t process_clone(struct intr_frame *if_, void *entry, uint64_t arg0,
+					uint64_t arg1, void *stack)
+{
+	struct thread *cur = thread_current();
+	struct thread *leader = thread_leader(cur);
+	struct clone_info *info = malloc(sizeof *info);
+	tid_t tid;
+
+	if (info == NULL)
+		return TID_ERROR;
+	info->leader = leader;
+	memcpy(&info->if_, if_, sizeof info->if_);
+	info->if_.rip = (uintptr_t)entry;
+	info->if_.R.rdi = arg0;
+	info->if_.R.rsi = arg1;
+	/* 함수에 call로 들어간 것처럼 rsp + 8이 16바이트 정렬되게 합니다 */
+	info->if_.rsp = ((uintptr_t)stack & ~(uintptr_t)0xf) - 8;
+
+	/* leader가 exit에서 이 스레드를 기다리도록 먼저 셉니다 */
+	lock_acquire(&leader->clone_lock);
+	leader->clone_cnt++;
+	lock_release(&leader->clone_lock);
+
+	tid = thread_create(cur->name, PRI_DEFAULT, __do_clone, info);
+	if (tid == TID_ERROR)
+	{
+		free(info);
+		lock_acquire(&leader->clone_lock);
+		if (--leader->clone_cnt == 0)
+			cond_signal(&leader->clone_done, &leader->clone_lock);
+		lock_release(&leader->clone_lock);
+	}
+	return tid;
+}
+
+/* clone()으로 만든 스레드의 스레드 함수. leader의 pml4로 전환한 뒤
+ * 유저 모드로 들어갑니다. */
+static void
+__do_clone(void *aux)
+{
+	struct clone_info *info = aux;
+	struct thread *current = thread_current();
+	struct intr_frame if_;
+
+	memcpy(&if_, &info->if_, sizeof if_);
+	current->leader = info->leader;
+	current->pml4 = info->leader->pml4;
+	free(info);
+
+	/* process_kill_group()이 찾을 수 있도록 그룹에 올립니다 */
+	enum intr_level old_level = intr_disable();
+	list_push_back(&current->leader->clones, &current->clone_elem);
+	intr_set_level(old_level);
+
+	sema_init(&current->fork_sema, 0);
+	process_activate(current);
+
+	/* 만들어지는 사이에 그룹이 끝나기 시작했으면 유저 모드로 가지 않습니다 */
+	if (process_dying())
+		process_die();
+	do_iret(&if_);
+	NOT_REACHED();
+}
+
+/* clone()으로 만든 자식 스레드 TID가 끝나기를 기다려 종료 코드를
+ * 반환합니다. 그런 자식이 없으면 -1을 반환합니다. */
+int process_join(tid_t tid)
+{
+	struct thread *child = get_my_child(tid);
+
+	if (child == NULL || child->leader == NULL)
+		return -1;
+	return process_wait(tid);
+}
+
 /* 현재 프로세스를 `name`이라는 이름으로 복제합니다.
  * 새 프로세스의 스레드 ID를 반환하거나, 생성할 수 없으면 TID_ERROR를 반환합니다. */
 
@@ -135,7 +319,7 @@ duplicate_pte(uint64_t *pte, void *va, void *aux)
 	bool writable;
 
 	/* 1. TODO: parent_page가 커널 페이지이면 즉시 반환해야 합니다. */
-	if (is_kernel_vaddr(va))
+	if (is_kernel_vaddr(va) || is_vdso_page(va))
 		return true;
 
 	/* 2. 부모의 page map level 4에서 VA를 해석합니다. */
@@ -166,6 +350,28 @@ duplicate_pte(uint64_t *pte, void *va, void *aux)
 }
 #endif
 
+/* 부모의 fd 객체 FILE을 자식이 가질 수 있도록 복제합니다. 콘솔 표식은
+ * 그대로 돌려주고, 메모리가 부족하면 NULL을 반환합니다. */
+static struct file *
+duplicate_fd_object(struct file *file)
+{
+	if (file_is_pipe(file))
+		return pipe_duplicate(file);
+	if (file == (struct file *)STDIN || file == (struct file *)STDOUT)
+		return file;
+	return file_duplicate(file);
+}
+
+/* duplicate_fd_object()가 만든 FILE을 닫습니다. NULL과 콘솔 표식은 무시합니다. */
+static void
+close_fd_object(struct file *file)
+{
+	if (file_is_pipe(file))
+		pipe_close(file);
+	else if (file != NULL && file != (struct file *)STDIN && file != (struct file *)STDOUT)
+		file_close(file);
+}
+
 /* 부모의 실행 컨텍스트를 복사하는 스레드 함수입니다.
  * 힌트) parent->tf는 프로세스의 사용자 영역 컨텍스트를 저장하지 않습니다.
  *       즉, 이 함수에는 process_fork의 두 번째 인자인 if_를 넘겨야 합니다. */
@@ -175,6 +381,7 @@ __do_fork(void *aux)
 	struct fork_info *info = aux;
 	struct intr_frame if_;
 	struct thread *parent = info->parent;
+	struct thread *proc = thread_leader(parent); /* 주소 공간과 fd 테이블의 주인 */
 	struct thread *current = thread_current();
 	/* TODO: somehow pass the parent_if. (i.e. process_fork()'s if_) */
 	struct intr_frame *parent_if = &info->parent_if;
@@ -185,13 +392,13 @@ __do_fork(void *aux)
 
 	/* 2. 페이지 테이블 복제 */
 	current->pml4 = pml4_create();
-	if (current->pml4 == NULL)
+	if (current->pml4 == NULL || !vdso_map(current->pml4))
 		goto error;
 
 	process_activate(current);
 #ifdef VM
 	supplemental_page_table_init(&current->spt);
-	if (!supplemental_page_table_copy(&current->spt, &parent->spt))
+	if (!supplemental_page_table_copy(&current->spt, &proc->spt))
 		goto error;
 #else
 	if (parent->pml4 == NULL)
@@ -204,29 +411,25 @@ __do_fork(void *aux)
 	/* TODO: 이 아래에 코드를 작성해야 합니다.
 	 * TODO: 힌트) 파일 객체를 복제하려면 include/filesys/file.h의 `file_duplicate`를 사용하세요.
 	 * TODO:       이 함수가 부모의 자원을 성공적으로 복제할 때까지 부모는 fork()에서 반환되면 안 됩니다. */
-	/* 부모의 fd_table을 순회하며 복사 */
-	if (parent->fd_idx == MAX_FD)
-		goto error;
-
-	for (int fd = 0; fd < MAX_FD; fd++)
+	/* 부모의 fd_table에서 열린 fd만 따라가며 복사 */
+	fdt_clear(current, 0);
+	fdt_clear(current, 1);
+	for (int fd = fdt_next(parent, 0); fd >= 0; fd = fdt_next(parent, fd + 1))
 	{
-		if (fd <= 1)
-			current->fd_table[fd] = parent->fd_table[fd];
-		else
+		struct file *parent_file = fdt_get(parent, fd);
+		struct file *file;
+
+		/* 훑는 사이 clone 스레드가 닫은 fd는 건너뜁니다 */
+		if (parent_file == NULL)
+			continue;
+		file = duplicate_fd_object(parent_file);
+		fdt_put(parent_file);
+		if (file == NULL || !fdt_install(current, fd, file))
 		{
-			if (parent->fd_table[fd] != NULL)
-			{
-				if (parent->fd_table[fd] == STDIN || parent->fd_table[fd] == STDOUT)
-					current->fd_table[fd] = parent->fd_table[fd];
-				else
-					current->fd_table[fd] = file_duplicate(parent->fd_table[fd]);
-			}
+			close_fd_object(file);
+			goto error;
 		}
 	}
-	current->fd_idx = parent->fd_idx;
-	/* extra2 */
-	current->stdin_count = parent->stdin_count;
-	current->stdout_count = parent->stdout_count;
 
 	if_.R.rax = 0;
 
@@ -242,19 +445,34 @@ error:
 /* 현재 실행 컨텍스트를 f_name으로 전환합니다.
  * 실패 시 -1을 반환합니다. */
 int process_exec(void *f_name)
+{
+	/* intr_frame을 thread 구조체 안의 것을 사용할 수 없습니다.
+	 * 이는 현재 스레드가 재스케줄될 때,
+	 * 그 실행 정보를 해당 멤버에 저장하기 때문입니다. */
+	struct intr_frame _if;
+
+	if (!process_load(f_name, &_if))
+		return -1;
+
+	// hex_dump(_if.rsp, _if.rsp, USER_STACK - (uint64_t)_if.rsp, true);
+	/* 프로세스를 전환합니다. */
+	do_iret(&_if);
+	NOT_REACHED();
+}
+
+/* 현재 컨텍스트를 버리고 f_name을 로드해 _if에 진입 상태를 채웁니다.
+ * f_name 페이지는 해제합니다. exec()과 spawn()이 함께 씁니다. */
+static bool
+process_load(void *f_name, struct intr_frame *_if)
 {
 	char *file_name = f_name;
 	char cp_file_name[MAX_BUF];
 	memcpy(cp_file_name, file_name, strlen(file_name) + 1);
 	bool success;
 
-	/* intr_frame을 thread 구조체 안의 것을 사용할 수 없습니다.
-	 * 이는 현재 스레드가 재스케줄될 때,
-	 * 그 실행 정보를 해당 멤버에 저장하기 때문입니다. */
-	struct intr_frame _if;
-	_if.ds = _if.es = _if.ss = SEL_UDSEG;
-	_if.cs = SEL_UCSEG;
-	_if.eflags = FLAG_IF | FLAG_MBS;
+	_if->ds = _if->es = _if->ss = SEL_UDSEG;
+	_if->cs = SEL_UCSEG;
+	_if->eflags = FLAG_IF | FLAG_MBS;
 
 	/* 현재 컨텍스트를 제거합니다. */
 	process_cleanup();
@@ -263,24 +481,20 @@ int process_exec(void *f_name)
 	
 	/* 그리고 이진 파일을 로드합니다. */
 	ASSERT(cp_file_name != NULL);
-	success = load(cp_file_name, &_if);
+	success = load(cp_file_name, _if);
 
 	palloc_free_page(file_name);
 	if (!success)
-		return -1;
+		return false;
 
-	lock_acquire(&filesys_lock);
+	rwlock_write_acquire(&filesys_lock);
 	struct file* test =filesys_open(cp_file_name);
 	thread_current()->running_file = test;
-	lock_release(&filesys_lock);
+	rwlock_write_release(&filesys_lock);
 
 	if (thread_current()->running_file != NULL)
 		file_deny_write(thread_current()->running_file);
-
-	// hex_dump(_if.rsp, _if.rsp, USER_STACK - (uint64_t)_if.rsp, true);
-	/* 프로세스를 전환합니다. */
-	do_iret(&_if);
-	NOT_REACHED();
+	return true;
 }
 
 static int parse_args(char *target, char *argv[])
@@ -348,6 +562,39 @@ void process_exit(void)
 {
 	struct thread *curr = thread_current();
 
+	/* clone 스레드는 자기 몫만 정리합니다. 공유 자원은 leader가
+	 * 마지막에 정리합니다. */
+	if (curr->leader != NULL)
+	{
+		struct thread *leader = curr->leader;
+
+		uring_destroy();
+		release_children(curr);
+		curr->pml4 = NULL;
+		pml4_activate(NULL);
+
+		enum intr_level old_level = intr_disable();
+		list_remove(&curr->clone_elem);
+		intr_set_level(old_level);
+
+		lock_acquire(&leader->clone_lock);
+		if (--leader->clone_cnt == 0)
+			cond_signal(&leader->clone_done, &leader->clone_lock);
+		lock_release(&leader->clone_lock);
+
+		sema_up(&curr->wait_sema);
+		sema_down(&curr->free_sema);
+		return;
+	}
+
+	/* 주소 공간을 함께 쓰는 clone 스레드를 모두 끝내고 기다립니다.
+	 * sys_exit()을 거치지 않고 끝나는 경우에도 그룹을 끝냅니다 */
+	process_kill_group(curr, curr->exit_status);
+	lock_acquire(&curr->clone_lock);
+	while (curr->clone_cnt > 0)
+		cond_wait(&curr->clone_done, &curr->clone_lock);
+	lock_release(&curr->clone_lock);
+
 	/* TODO: 여기에 코드를 작성하세요.
 	 * TODO: 프로세스 종료 메시지를 구현하세요 (project2/process_termination.html 참고).
 	 * TODO: 우리는 이곳에 프로세스 자원 정리를 구현하는 것을 추천합니다. */
@@ -355,17 +602,10 @@ void process_exit(void)
 
 	if (curr->fd_table != NULL)
 	{
-		for (int i = 0; i < MAX_FD; i++)
-		{
-			if (curr->fd_table[i] != NULL)
-			{
-				sys_close(i);
-				curr->fd_table[i] = NULL;
-			}
-		}
+		for (int fd = fdt_next(curr, 0); fd >= 0; fd = fdt_next(curr, fd + 1))
+			sys_close(fd);
 	}
-
-	palloc_free_multiple(curr->fd_table, FDT_PAGES);
+	fdt_destroy(curr);
 	if (curr->running_file != NULL)
 	{
 		file_allow_write(curr->running_file);
@@ -373,16 +613,93 @@ void process_exit(void)
 	}
 
 	process_cleanup();
+	release_children(curr);
 	sema_up(&curr->wait_sema);
 	sema_down(&curr->free_sema);
 }
 
+/* LEADER의 스레드 그룹을 끝내기 시작합니다. 처음 부른 쪽의 STATUS가
+ * 프로세스의 종료 코드가 됩니다. 그룹의 다른 스레드 중 잠들어 있는
+ * 스레드는 깨우고, 모든 스레드는 유저 모드로 돌아가기 전에
+ * process_dying()을 보고 끝납니다. */
+void process_kill_group(struct thread *leader, int status)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level = intr_disable();
+	struct list_elem *e;
+
+	ASSERT(leader->leader == NULL);
+
+	if (!leader->group_dying)
+	{
+		leader->group_dying = true;
+		leader->group_status = status;
+		if (leader != cur && leader->kill_sema != NULL)
+			sema_wake(leader->kill_sema);
+		for (e = list_begin(&leader->clones); e != list_end(&leader->clones); e = list_next(e))
+		{
+			struct thread *t = list_entry(e, struct thread, clone_elem);
+
+			if (t != cur && t->kill_sema != NULL)
+				sema_wake(t->kill_sema);
+		}
+		compare_cur_next_priority();
+	}
+	intr_set_level(old_level);
+}
+
+/* 현재 스레드가 속한 그룹이 끝나는 중이면 true. */
+bool process_dying(void)
+{
+	return thread_leader(thread_current())->group_dying;
+}
+
+/* 끝나는 중인 그룹의 스레드로서 현재 스레드를 끝냅니다. */
+void process_die(void)
+{
+	ASSERT(process_dying());
+	sys_exit(thread_leader(thread_current())->group_status);
+}
+
+/* SEMA에서 잠듭니다. 잠든 사이에 그룹이 끝나기 시작하면 깨어납니다.
+ * 그룹이 끝나는 중이라 잠들지 않았거나 그 때문에 깨어났으면 false를
+ * 반환하며, 그때는 SEMA를 기다리던 일을 호출자가 정리해야 합니다. */
+bool process_sleep(struct semaphore *sema)
+{
+	struct thread *cur = thread_current();
+
+	/* kill_sema를 먼저 걸고 나서 봐야, 보고 잠들기 전에 그룹이 끝나기
+	 * 시작해도 process_kill_group()이 SEMA를 올려 줍니다 */
+	cur->kill_sema = sema;
+	barrier();
+	if (!process_dying())
+		sema_down(sema);
+	cur->kill_sema = NULL;
+	return !process_dying();
+}
+
+/* T가 기다리지 않은 자식들을 놓아 줍니다. 이미 끝난 자식은 free_sema에서
+ * 풀려나 사라지고, 아직 도는 자식은 끝날 때 기다리지 않습니다. */
+static void
+release_children(struct thread *t)
+{
+	while (!list_empty(&t->children_list))
+	{
+		struct thread *child = list_entry(list_pop_front(&t->children_list),
+										  struct thread, child_elem);
+		sema_up(&child->free_sema);
+	}
+}
+
 /* 현재 프로세스의 자원을 해제합니다. */
 static void
 process_cleanup(void)
 {
 	struct thread *curr = thread_current();
 
+	/* 링 페이지는 아래에서 주소 공간과 함께 사라집니다. */
+	uring_destroy();
+
 #ifdef VM
 	supplemental_page_table_kill(&curr->spt);
 #endif
@@ -401,6 +718,8 @@ process_cleanup(void)
 		 * 그렇지 않으면 현재 활성 페이지 디렉터리가 제거된 것(혹은 초기화된 것)이 될 수 있습니다. */
 		curr->pml4 = NULL;
 		pml4_activate(NULL);
+		/* VDSO 페이지는 모든 프로세스가 같이 쓰므로 해제되면 안 됩니다 */
+		vdso_unmap(pml4);
 		pml4_destroy(pml4);
 	}
 }
@@ -414,6 +733,8 @@ void process_activate(struct thread *next)
 
 	/* 인터럽트 처리를 위해 스레드의 커널 스택을 설정합니다. */
 	tss_update(next);
+
+	vdso_switch(next);
 }
 
 /* ELF 실행 파일을 로드합니다.
@@ -495,14 +816,14 @@ load(const char *file_name, struct intr_frame *if_)
 
 	/* 페이지 디렉터리를 할당하고 활성화합니다. */
 	t->pml4 = pml4_create();
-	if (t->pml4 == NULL)
+	if (t->pml4 == NULL || !vdso_map(t->pml4))
 		goto done;
 	process_activate(thread_current());
 
 	/* 실행 파일을 엽니다. */
-	lock_acquire(&filesys_lock);
+	rwlock_write_acquire(&filesys_lock);
 	file = filesys_open(file_name);
-	lock_release(&filesys_lock);
+	rwlock_write_release(&filesys_lock);
 
 	if (file == NULL)
 	{
@@ -794,7 +1115,10 @@ lazy_load_segment(struct page *page, void *aux)
     page_read_bytes = page_read_bytes < file_remaining ? page_read_bytes : file_remaining;
     size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
-    int bytes_read = file_read_at(file, kva, page_read_bytes, ofs);    if (bytes_read == (int)page_read_bytes) {
+    rwlock_read_acquire(&filesys_lock);
+    int bytes_read = file_read_at(file, kva, page_read_bytes, ofs);
+    rwlock_read_release(&filesys_lock);
+    if (bytes_read == (int)page_read_bytes) {
         memset(kva + page_read_bytes, 0, page_zero_bytes);
         return true;
     } else if (bytes_read >= 0) {
@@ -878,4 +1202,4 @@ setup_stack(struct intr_frame *if_)
 
 	return true;
 }
-#endif /* VM */
\ No newline at end of file
+#endif /* VM */
\ No newline at end of file
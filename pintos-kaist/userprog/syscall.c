@@ -1,6 +1,7 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
 #include <syscall-nr.h>
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/loader.h"
@@ -15,25 +16,53 @@
 #include "threads/synch.h"
 #include "lib/user/syscall.h"
 #include "vm/vm.h"
+#include "userprog/usercopy.h"
+#include "userprog/uring.h"
+#include "userprog/fdtable.h"
+#include "userprog/pipe.h"
+#include "userprog/futex.h"
+#include "userprog/vdso.h"
+#include "devices/input.h"
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include <round.h>
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
 static int sys_write(int fd, const void *buffer, unsigned size);
 void sys_exit(int);
+void sys_clone_exit(int);
 static void sys_halt();
 bool sys_create(const char *file, unsigned initial_size);
 bool sys_remove(const char *file);
 int sys_open(const char *file);
+int sys_exec(char *file_name);
+tid_t sys_spawn(const char *cmd_line, const int *fd_map, int nfds);
+void sys_close(int fd);
 int sys_filesize(int fd);
 int sys_read(int fd, void *buffer, unsigned srize);
-int find_unused_fd(const char *file);
+int find_unused_fd(struct file *file);
 void sys_seek(int fd, unsigned position);
 unsigned sys_tell(int fd);
-void check_buffer(const void *buffer, unsigned size, bool write);
 int sys_wait(tid_t pid);
 int sys_dup2(int oldfd, int newfd);
 void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void sys_munmap(void *addr);
+static bool get_user_string(char *kbuf, const char *ustr, size_t size);
+static void *mmap_file(void *addr, size_t length, int writable, struct file *file, off_t offset);
+int sys_syscall_stats(struct syscall_stat *buf, int cnt);
+int sys_readv(int fd, const struct iovec *iov, int iovcnt);
+int sys_writev(int fd, const struct iovec *iov, int iovcnt);
+int sys_pread(int fd, void *buffer, unsigned size, off_t offset);
+int sys_pwrite(int fd, const void *buffer, unsigned size, off_t offset);
+int sys_copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len);
+int sys_pipe(int *fds);
+int sys_poll(struct pollfd *ufds, unsigned nfds, int timeout);
+void *sys_shm_map(const char *name, size_t size, void *addr, int writable);
+bool sys_shm_unlink(const char *name);
+int sys_clock_gettime(int clock, struct timespec *ts);
+int sys_nanosleep(const struct timespec *req);
+int sys_getrusage(struct rusage *usage);
 
 /* 시스템 콜.
  *
@@ -47,8 +76,26 @@ void sys_munmap(void *addr);
 #define MSR_STAR 0xc0000081			/* Segment selector msr */
 #define MSR_LSTAR 0xc0000082		/* Long mode SYSCALL target */
 #define MSR_SYSCALL_MASK 0xc0000084 /* Mask for the eflags */
+#define MSR_KERNEL_GS_BASE 0xc0000102 /* swapgs로 GS 베이스와 맞바꿀 값 */
+
+/* 파일 이름을 복사해 올 커널 버퍼 크기.
+ * 파일 시스템이 허용하는 이름(NAME_MAX = 14)보다 조금 크게 잡아서
+ * 너무 긴 이름은 복사 단계에서 바로 걸러냅니다. */
+#define FILE_NAME_BUF 16
 
 void syscall_init(void)
+{
+	syscall_init_cpu();
+
+	rwlock_init(&filesys_lock);
+	uring_init();
+	futex_init();
+	vdso_init();
+}
+
+/* 이 CPU에서 syscall 명령이 syscall_entry로 들어오도록 MSR을 씁니다.
+   MSR은 CPU마다 따로 있으므로 AP도 각자 부릅니다. */
+void syscall_init_cpu(void)
 {
 	write_msr(MSR_STAR, ((uint64_t)SEL_UCSEG - 0x10) << 48 |
 							((uint64_t)SEL_KCSEG) << 32);
@@ -64,135 +111,356 @@ void syscall_init(void)
 	write_msr(MSR_SYSCALL_MASK,
 			  FLAG_IF | FLAG_TF | FLAG_DF | FLAG_IOPL | FLAG_AC | FLAG_NT);
 
-	lock_init(&filesys_lock);
+	/* syscall_entry는 swapgs로 이 CPU의 struct cpu를 찾습니다 */
+	write_msr(MSR_KERNEL_GS_BASE, (uint64_t)this_cpu());
 }
 
-/* The main system call interface */
-void syscall_handler(struct intr_frame *f UNUSED)
+/* 시스템 콜 핸들러. ARGV에는 테이블에 적힌 개수만큼의 인자만 채워집니다. */
+typedef uint64_t syscall_func(struct intr_frame *f, const uint64_t *argv);
+
+/* 시스템 콜 테이블 엔트리 */
+struct syscall_desc
 {
+	syscall_func *func; /* NULL이면 지원하지 않는 시스템 콜 */
+	int argc;			/* 레지스터에서 가져올 인자 수 */
+	bool has_ret;		/* false면 rax를 건드리지 않음 */
+};
 
-	uint64_t syscall_num = f->R.rax;
-	uint64_t arg1 = f->R.rdi;
-	uint64_t arg2 = f->R.rsi;
-	uint64_t arg3 = f->R.rdx;
-	uint64_t arg4 = f->R.r10;
-	uint64_t arg5 = f->R.r8;
-	uint64_t arg6 = f->R.r9;
-	if (f->cs == SEL_UCSEG)
-        thread_current()->user_rsp = f->rsp;
-	// syscall_handler 내부
-	switch (syscall_num)
-	{
-	case SYS_HALT:
-		sys_halt();
-		break;
-	case SYS_EXIT:
-		sys_exit(arg1);
-		break;
-	case SYS_FORK:
-		f->R.rax = process_fork((const char *)arg1, f);
-		break;
-	case SYS_EXEC:
-		f->R.rax = sys_exec((void *)arg1);
-		break;
-	case SYS_WAIT:
-		f->R.rax = sys_wait((tid_t)arg1);
-		break;
-	case SYS_CREATE:
-		f->R.rax = sys_create(arg1, arg2);
-		break;
-	case SYS_REMOVE:
-		f->R.rax = sys_remove(arg1);
-		break;
-	case SYS_OPEN:
-		f->R.rax = sys_open(arg1);
-		break;
-	case SYS_FILESIZE:
-		f->R.rax = sys_filesize(arg1);
-		break;
-	case SYS_READ:
-		f->R.rax = sys_read(arg1, arg2, arg3);
-		break;
-	case SYS_WRITE:
-		f->R.rax = sys_write(arg1, arg2, arg3);
-		break;
-	case SYS_SEEK:
-		sys_seek(arg1, arg2);
-		break;
-	case SYS_TELL:
-		f->R.rax = sys_tell(arg1);
-		break;
-	case SYS_CLOSE:
-		sys_close(arg1);
-		break;
-	case SYS_DUP2:
-		f->R.rax = sys_dup2(arg1, arg2);
-		break;
-	case SYS_MMAP:
-		f->R.rax = sys_mmap(arg1, arg2, arg3, arg4, arg5);
-		break;
-	case SYS_MUNMAP:
-		sys_munmap(arg1);
-		break;
+static uint64_t sc_halt(struct intr_frame *f UNUSED, const uint64_t *argv UNUSED)
+{
+	sys_halt();
+	NOT_REACHED();
+}
+
+static uint64_t sc_exit(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	sys_exit((int)argv[0]);
+	NOT_REACHED();
+}
+
+static uint64_t sc_fork(struct intr_frame *f, const uint64_t *argv)
+{
+	char name[sizeof thread_current()->name];
+
+	/* 스레드 이름은 16바이트로 잘리므로 넘치는 이름도 허용합니다. */
+	get_user_string(name, (const char *)argv[0], sizeof name);
+	name[sizeof name - 1] = '\0';
+	return process_fork(name, f);
+}
+
+static uint64_t sc_exec(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_exec((char *)argv[0]);
+}
+
+static uint64_t sc_spawn(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_spawn((const char *)argv[0], (const int *)argv[1], (int)argv[2]);
+}
+
+static uint64_t sc_wait(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_wait((tid_t)argv[0]);
+}
+
+static uint64_t sc_create(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_create((const char *)argv[0], (unsigned)argv[1]);
+}
+
+static uint64_t sc_remove(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_remove((const char *)argv[0]);
+}
+
+static uint64_t sc_open(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_open((const char *)argv[0]);
+}
+
+static uint64_t sc_filesize(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_filesize((int)argv[0]);
+}
+
+static uint64_t sc_read(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_read((int)argv[0], (void *)argv[1], (unsigned)argv[2]);
+}
+
+static uint64_t sc_write(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_write((int)argv[0], (const void *)argv[1], (unsigned)argv[2]);
+}
+
+static uint64_t sc_seek(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	sys_seek((int)argv[0], (unsigned)argv[1]);
+	return 0;
+}
+
+static uint64_t sc_tell(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_tell((int)argv[0]);
+}
+
+static uint64_t sc_close(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	sys_close((int)argv[0]);
+	return 0;
+}
+
+static uint64_t sc_dup2(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_dup2((int)argv[0], (int)argv[1]);
+}
+
+static uint64_t sc_mmap(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return (uint64_t)sys_mmap((void *)argv[0], (size_t)argv[1], (int)argv[2],
+							  (int)argv[3], (off_t)argv[4]);
+}
+
+static uint64_t sc_munmap(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	sys_munmap((void *)argv[0]);
+	return 0;
+}
+
+static uint64_t sc_readv(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_readv((int)argv[0], (const struct iovec *)argv[1], (int)argv[2]);
+}
+
+static uint64_t sc_writev(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_writev((int)argv[0], (const struct iovec *)argv[1], (int)argv[2]);
+}
+
+static uint64_t sc_pread(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_pread((int)argv[0], (void *)argv[1], (unsigned)argv[2], (off_t)argv[3]);
+}
+
+static uint64_t sc_pwrite(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_pwrite((int)argv[0], (const void *)argv[1], (unsigned)argv[2], (off_t)argv[3]);
+}
+
+static uint64_t sc_copy_file_range(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_copy_file_range((int)argv[0], (off_t *)argv[1], (int)argv[2],
+							   (off_t *)argv[3], (size_t)argv[4]);
+}
+
+static uint64_t sc_ring_setup(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return uring_setup((struct ring *)argv[0]);
+}
+
+static uint64_t sc_ring_enter(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return uring_enter((unsigned)argv[0], (unsigned)argv[1]);
+}
+
+static uint64_t sc_pipe(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_pipe((int *)argv[0]);
+}
+
+static uint64_t sc_poll(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_poll((struct pollfd *)argv[0], (unsigned)argv[1], (int)argv[2]);
+}
+
+static uint64_t sc_shm_map(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return (uint64_t)sys_shm_map((const char *)argv[0], (size_t)argv[1],
+								 (void *)argv[2], (int)argv[3]);
+}
+
+static uint64_t sc_shm_unlink(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_shm_unlink((const char *)argv[0]);
+}
+
+static uint64_t sc_futex(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	uint32_t *uaddr = (uint32_t *)argv[0];
+
+	switch ((int)argv[1])
+	{
+	case FUTEX_WAIT:
+		return futex_wait(uaddr, (uint32_t)argv[2]);
+	case FUTEX_WAKE:
+		return futex_wake(uaddr, (int)argv[2]);
 	default:
-		thread_exit();
-		break;
+		return -1;
 	}
 }
 
-// 주소값이 유저 영역(0x8048000~0xc0000000)에서 사용하는 주소값인지 확인하는 함수
-// 또는 매핑된 주소인지 확인
-void check_address(const uint64_t *addr)
+static uint64_t sc_clone(struct intr_frame *f, const uint64_t *argv)
 {
-	struct thread *cur = thread_current();
+	return process_clone(f, (void *)argv[0], argv[1], argv[2], (void *)argv[3]);
+}
 
-	if (addr == NULL || !is_user_vaddr(addr))
-		sys_exit(-1);
+static uint64_t sc_join(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return process_join((tid_t)argv[0]);
+}
 
-	struct apge *page= pml4_get_page(cur->pml4, addr);
-	 
-	if(page ==NULL){
-		if (!vm_try_handle_fault(NULL, addr, true, write, true))
-				sys_exit(-1);
-	}
-	
+static uint64_t sc_clone_exit(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	sys_clone_exit((int)argv[0]);
+	NOT_REACHED();
 }
 
-void check_buffer(const void *buffer, unsigned size, bool write)
+static uint64_t sc_clock_gettime(struct intr_frame *f UNUSED, const uint64_t *argv)
 {
-	/*read는 커널이 유저 버퍼에 데이터를 쓴다->버퍼가 쓰기 가능한 페이지여야 한다.
-	write는 커널이 유저 버퍼에서 데이터를 읽는다->버퍼의 writable 검사 필요하지 않음.
-	여기서 인자 write가 1이면 sys_write에서 넘어온 것->검사 필요하지 않음.
-*/
-	uint8_t *start = (uint8_t *)pg_round_down(buffer);
-	uint8_t *end = (uint8_t *)pg_round_down(buffer + size - 1);
-	struct thread *cur = thread_current();
+	return sys_clock_gettime((int)argv[0], (struct timespec *)argv[1]);
+}
 
-	for (uint8_t *addr = start; addr <= end; addr += PGSIZE)
-	{
-		if (!is_user_vaddr(addr))
-			sys_exit(-1);
+static uint64_t sc_nanosleep(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_nanosleep((const struct timespec *)argv[0]);
+}
 
-		struct page *page = pml4_get_page(cur->pml4, addr);
-		
-		if (page == NULL)
-		{
-			if (!vm_try_handle_fault(NULL, addr, true, write, true))
-				sys_exit(-1);
-		}else{
-			if(!write){
-				//이미 매핑되어 있다면	
-				uint64_t *pte = pml4e_walk(cur->pml4, (uint64_t)addr, false);
-				struct page *cur_page = spt_find_page(&cur->spt, addr);
-				bool page_writable = cur_page->writable;
-				if (pte == NULL || (!is_writable(pte) && !page_writable))
-				{
-					sys_exit(-1); // 쓰기 권한이 없으면 종료
-				}
-			}
-		}
+static uint64_t sc_getrusage(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_getrusage((struct rusage *)argv[0]);
+}
+
+static uint64_t sc_syscall_stats(struct intr_frame *f UNUSED, const uint64_t *argv)
+{
+	return sys_syscall_stats((struct syscall_stat *)argv[0], (int)argv[1]);
+}
+
+/* 시스템 콜 번호로 인덱싱하는 디스패치 테이블 */
+static const struct syscall_desc syscall_table[] = {
+	[SYS_HALT] = {sc_halt, 0, false},
+	[SYS_EXIT] = {sc_exit, 1, false},
+	[SYS_FORK] = {sc_fork, 1, true},
+	[SYS_EXEC] = {sc_exec, 1, true},
+	[SYS_WAIT] = {sc_wait, 1, true},
+	[SYS_CREATE] = {sc_create, 2, true},
+	[SYS_REMOVE] = {sc_remove, 1, true},
+	[SYS_OPEN] = {sc_open, 1, true},
+	[SYS_FILESIZE] = {sc_filesize, 1, true},
+	[SYS_READ] = {sc_read, 3, true},
+	[SYS_WRITE] = {sc_write, 3, true},
+	[SYS_SEEK] = {sc_seek, 2, false},
+	[SYS_TELL] = {sc_tell, 1, true},
+	[SYS_CLOSE] = {sc_close, 1, false},
+	[SYS_MMAP] = {sc_mmap, 5, true},
+	[SYS_MUNMAP] = {sc_munmap, 1, false},
+	[SYS_DUP2] = {sc_dup2, 2, true},
+	[SYS_SYSCALL_STATS] = {sc_syscall_stats, 2, true},
+	[SYS_READV] = {sc_readv, 3, true},
+	[SYS_WRITEV] = {sc_writev, 3, true},
+	[SYS_PREAD] = {sc_pread, 4, true},
+	[SYS_PWRITE] = {sc_pwrite, 4, true},
+	[SYS_COPY_FILE_RANGE] = {sc_copy_file_range, 5, true},
+	[SYS_RING_SETUP] = {sc_ring_setup, 1, true},
+	[SYS_RING_ENTER] = {sc_ring_enter, 2, true},
+	[SYS_PIPE] = {sc_pipe, 1, true},
+	[SYS_POLL] = {sc_poll, 3, true},
+	[SYS_SPAWN] = {sc_spawn, 3, true},
+	[SYS_SHM_MAP] = {sc_shm_map, 4, true},
+	[SYS_SHM_UNLINK] = {sc_shm_unlink, 1, true},
+	[SYS_FUTEX] = {sc_futex, 3, true},
+	[SYS_CLONE] = {sc_clone, 4, true},
+	[SYS_JOIN] = {sc_join, 1, true},
+	[SYS_CLOCK_GETTIME] = {sc_clock_gettime, 2, true},
+	[SYS_NANOSLEEP] = {sc_nanosleep, 1, true},
+	[SYS_GETRUSAGE] = {sc_getrusage, 1, true},
+	[SYS_CLONE_EXIT] = {sc_clone_exit, 1, false},
+};
+
+#define SYSCALL_CNT (sizeof syscall_table / sizeof syscall_table[0])
+
+/* 시스템 콜별 호출 횟수와 누적 사이클. exit/exec처럼 돌아오지 않는
+ * 시스템 콜은 횟수만 올라갑니다. */
+static struct syscall_stat syscall_stat_table[SYSCALL_CNT];
+
+/* The main system call interface */
+void syscall_handler(struct intr_frame *f)
+{
+	uint64_t syscall_num = f->R.rax;
+	const struct syscall_desc *desc;
+	struct syscall_stat *stat;
+	uint64_t argv[6];
+	uint64_t start, ret;
+
+	if (syscall_num >= SYSCALL_CNT || syscall_table[syscall_num].func == NULL)
+		thread_exit();
+	desc = &syscall_table[syscall_num];
+
+	/* 필요한 인자 레지스터만 복사합니다. */
+	switch (desc->argc)
+	{
+	case 6:
+		argv[5] = f->R.r9;
+		/* fall through */
+	case 5:
+		argv[4] = f->R.r8;
+		/* fall through */
+	case 4:
+		argv[3] = f->R.r10;
+		/* fall through */
+	case 3:
+		argv[2] = f->R.rdx;
+		/* fall through */
+	case 2:
+		argv[1] = f->R.rsi;
+		/* fall through */
+	case 1:
+		argv[0] = f->R.rdi;
+		/* fall through */
+	default:
+		break;
 	}
+
+	stat = &syscall_stat_table[syscall_num];
+	stat->count++;
+	start = rdtsc();
+	ret = desc->func(f, argv);
+	stat->cycles += rdtsc() - start;
+	if (desc->has_ret)
+		f->R.rax = ret;
+
+	/* 그사이 다른 스레드가 exit했으면 유저 모드로 돌아가지 않습니다 */
+	if (process_dying())
+		process_die();
+}
+
+/* 시스템 콜 통계를 유저 버퍼 BUF에 최대 CNT개 복사합니다.
+ * BUF[i]는 시스템 콜 번호 i의 통계이며, 커널이 아는 시스템 콜 수를
+ * 반환합니다. */
+int sys_syscall_stats(struct syscall_stat *buf, int cnt)
+{
+	size_t n;
+
+	if (cnt < 0)
+		return -1;
+	n = (size_t)cnt < SYSCALL_CNT ? (size_t)cnt : SYSCALL_CNT;
+	if (!copy_to_user(buf, syscall_stat_table, n * sizeof *buf))
+		sys_exit(-1);
+	return SYSCALL_CNT;
 }
+
+/* 유저 문자열 USTR을 커널 버퍼 KBUF(SIZE 바이트)로 복사합니다.
+ * 잘못된 주소면 프로세스를 종료하고, SIZE 안에 널 문자가 없으면
+ * false를 반환합니다. */
+static bool
+get_user_string(char *kbuf, const char *ustr, size_t size)
+{
+	int64_t len = strncpy_from_user(kbuf, ustr, size);
+
+	if (len < 0)
+		sys_exit(-1);
+	return (size_t)len < size;
+}
+
 /* addr은 mmap으로 할당받은 시작주소 */
 void sys_munmap(void *addr)
 {
@@ -203,7 +471,13 @@ void sys_munmap(void *addr)
 	 */
 
 	struct thread *thread = thread_current(); 
-	struct page * page=spt_find_page(&thread->spt, addr);
+	struct page * page=spt_find_page(current_spt(), addr);
+
+	if (page != NULL && page_get_type(page) == VM_SHM)
+	{
+		shm_unmap(addr);
+		return;
+	}
 
 	struct file_info *aux = (struct file_info *)page->file.aux;
 	size_t target_length = aux->mmap_length;
@@ -223,17 +497,31 @@ void sys_munmap(void *addr)
 */
 void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 {
-	// addr NULL, 페이지 정렬, 0주소 금지
-    if (addr == NULL || !is_user_vaddr(addr) || (uint64_t)addr == 0 || (uint64_t)addr % PGSIZE != 0)
-        return MAP_FAILED;
+    struct file *file;
+    void *ret;
 
     // fd가 0, 1(콘솔)이거나 음수거나 MAX_FD 넘어가면 실패
     if (fd == 0 || fd == 1 || fd < 0 || fd >= MAX_FD)
         return MAP_FAILED;
 
-    // 파일 포인터 확인
-    struct file *file = thread_current()->fd_table[fd];
-    if (file == NULL || file->inode == NULL)
+    /* 매핑을 만드는 동안 참조를 쥐어 둡니다. 매핑된 페이지는 do_mmap()이
+     * 다시 연 파일을 씁니다. */
+    file = fdt_get(thread_current(), fd);
+    ret = mmap_file(addr, length, writable, file, offset);
+    fdt_put(file);
+    return ret;
+}
+
+/* sys_mmap()의 본체. FILE은 FD에서 꺼낸 파일 객체입니다. */
+static void *
+mmap_file(void *addr, size_t length, int writable, struct file *file, off_t offset)
+{
+	// addr NULL, 페이지 정렬, 0주소 금지
+    if (addr == NULL || !is_user_vaddr(addr) || (uint64_t)addr == 0 || (uint64_t)addr % PGSIZE != 0)
+        return MAP_FAILED;
+
+    // 파일 포인터 확인: 닫힌 fd, 콘솔, 파이프는 매핑할 수 없음
+    if (file == NULL || file == STDIN || file == STDOUT || file->inode == NULL)
         return MAP_FAILED;
 
     // offset은 반드시 페이지 정렬
@@ -241,7 +529,7 @@ void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
         return MAP_FAILED;
 
     // 파일 사이즈, length 검사 (이제 file은 NULL 아님이 보장됨)
-    int filesize = sys_filesize(fd); 
+    int filesize = file_length(file); 
     if (filesize == 0 || length == 0 || length > (uintptr_t)addr)
         return MAP_FAILED;
 
@@ -249,7 +537,7 @@ void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
     void *end_page = addr + length;
     for (void *page = addr; page < end_page; page += PGSIZE)
     {
-        if (spt_find_page(&thread_current()->spt, page) != NULL)
+        if (spt_find_page(current_spt(), page) != NULL || is_vdso_page(page))
             return MAP_FAILED;
     }
 
@@ -263,7 +551,7 @@ void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	while (remain_length > 0)
 	{	
 		size_t allocate_length = remain_length > PGSIZE ? PGSIZE : remain_length;
-		if(do_mmap(cur_addr, allocate_length, writable, thread_current()->fd_table[fd], cur_offset, length)==NULL)
+		if(do_mmap(cur_addr, allocate_length, writable, file, cur_offset, length)==NULL)
 			return MAP_FAILED;
 		if(remain_length<allocate_length) break;
 		remain_length -= allocate_length;
@@ -274,17 +562,47 @@ void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	return addr;
 }
 
+/* 공유 메모리 세그먼트 NAME을 ADDR에 SIZE 바이트만큼 매핑합니다.
+ * 세그먼트가 없으면 만듭니다. 해제는 munmap(ADDR)로 합니다. */
+void *sys_shm_map(const char *name, size_t size, void *addr, int writable)
+{
+	char kname[FILE_NAME_BUF];
+
+	if (!get_user_string(kname, name, sizeof kname))
+		return MAP_FAILED;
+	if (kname[0] == '\0' || strlen(kname) > SHM_NAME_MAX)
+		return MAP_FAILED;
+	return shm_map(kname, size, addr, writable);
+}
+
+/* 공유 메모리 세그먼트 NAME의 이름을 지웁니다. */
+bool sys_shm_unlink(const char *name)
+{
+	char kname[FILE_NAME_BUF];
+
+	if (!get_user_string(kname, name, sizeof kname))
+		return false;
+	return shm_unlink(kname);
+}
+
 int sys_exec(char *file_name)
 {
-	check_address(file_name);
+	struct thread *cur = thread_current();
+
+	/* 다른 스레드가 쓰고 있는 주소 공간을 갈아 끼울 수는 없습니다 */
+	if (cur->leader != NULL || cur->clone_cnt > 0)
+		return -1;
 
-	int size = strlen(file_name) + 1;
 	char *fn_copy = palloc_get_page(PAL_ZERO);
 	if ((fn_copy) == NULL)
 	{
 		sys_exit(-1);
 	}
-	strlcpy(fn_copy, file_name, size);
+	if (!get_user_string(fn_copy, file_name, PGSIZE))
+	{
+		palloc_free_page(fn_copy);
+		sys_exit(-1);
+	}
 
 	if (process_exec(fn_copy) == -1)
 	{
@@ -295,15 +613,57 @@ int sys_exec(char *file_name)
 	return 0;
 }
 
+/* CMD_LINE을 실행하는 자식을 fork() 없이 만듭니다. 자식의 fd i는 부모의
+ * fd FD_MAP[i]를 물려받습니다(음수면 비움). FD_MAP이 NULL이면 콘솔만
+ * 물려받습니다. */
+tid_t sys_spawn(const char *cmd_line, const int *fd_map, int nfds)
+{
+	char *cmd_copy;
+	int *kfd_map = NULL;
+	tid_t tid;
+
+	if (fd_map != NULL && (nfds < 0 || nfds > MAX_FD))
+		return TID_ERROR;
+
+	cmd_copy = palloc_get_page(PAL_ZERO);
+	if (cmd_copy == NULL)
+		return TID_ERROR;
+	if (!get_user_string(cmd_copy, cmd_line, PGSIZE))
+	{
+		palloc_free_page(cmd_copy);
+		sys_exit(-1);
+	}
+
+	if (fd_map != NULL)
+	{
+		kfd_map = malloc((nfds + 1) * sizeof *kfd_map);
+		if (kfd_map == NULL)
+		{
+			palloc_free_page(cmd_copy);
+			return TID_ERROR;
+		}
+		if (!copy_from_user(kfd_map, fd_map, nfds * sizeof *kfd_map))
+		{
+			free(kfd_map);
+			palloc_free_page(cmd_copy);
+			sys_exit(-1);
+		}
+	}
+
+	tid = process_spawn(cmd_copy, kfd_map, nfds);
+	free(kfd_map);
+	return tid;
+}
+
 struct file *
 process_get_file(int fd)
 {
 	struct thread *cur = thread_current();
 
-	if (fd < 2 || fd > MAX_FD)
+	if (fd < 2)
 		return NULL;
 
-	return cur->fd_table[fd];
+	return fdt_get(cur, fd);
 }
 
 void sys_halt()
@@ -311,59 +671,292 @@ void sys_halt()
 	power_off();
 }
 
-static int sys_write(int fd, const void *buffer, unsigned size)
+/* 한 번의 전송에 쓰는 바운스 버퍼의 최대 페이지 수.
+ * 이보다 큰 전송은 이 크기 단위로 나눠 처리합니다. */
+#define IO_BOUNCE_PAGES 16
+
+/* readv/writev가 한 번에 받는 최대 iovec 수 */
+#define IOV_MAX 64
+
+/* 여러 유저 버퍼(iovec)를 하나의 연속된 스트림처럼 순회하는 커서 */
+struct iov_iter
+{
+	const struct iovec *iov; /* 현재 iovec */
+	int cnt;				 /* 남은 iovec 수 */
+	size_t ofs;				 /* 현재 iovec 안에서의 위치 */
+};
+
+/* 커서 IT 위치부터 N 바이트를 KBUF와 유저 버퍼 사이에서 복사하고
+ * 커서를 그만큼 옮깁니다. TO_USER가 true면 KBUF -> 유저 방향입니다.
+ * 잘못된 유저 주소를 만나면 false를 반환합니다. */
+static bool
+iov_iter_copy(struct iov_iter *it, uint8_t *kbuf, size_t n, bool to_user)
+{
+	while (n > 0 && it->cnt > 0)
+	{
+		uint8_t *ubuf = (uint8_t *)it->iov->iov_base + it->ofs;
+		size_t left = it->iov->iov_len - it->ofs;
+		size_t step = n < left ? n : left;
+		bool ok = to_user ? copy_to_user(ubuf, kbuf, step)
+						  : copy_from_user(kbuf, ubuf, step);
+
+		if (!ok)
+			return false;
+		kbuf += step;
+		n -= step;
+		it->ofs += step;
+		if (it->ofs == it->iov->iov_len)
+		{
+			it->iov++;
+			it->cnt--;
+			it->ofs = 0;
+		}
+	}
+	return true;
+}
+
+/* FD에서 꺼낸 FILE_OBJ와 커널로 복사해 둔 IOV[IOVCNT]에 대해 IS_WRITE
+ * 방향으로 전송하며, POS가 NULL이 아니면 파일 위치 대신 *POS에서 읽고
+ * 씁니다(pread/pwrite). 유저 메모리에서 폴트가 나면 *FAULT를 true로
+ * 만들고 -1을 반환합니다.
+ *
+ * 유저 버퍼를 커널 바운스 버퍼로 먼저 모으거나(쓰기) 바운스 버퍼에
+ * 다 읽은 뒤 흩뿌리므로(읽기) filesys_lock을 잡은 구간에서는 유저
+ * 메모리를 만지지 않습니다. filesys_lock을 잡은 채 유저 메모리에서
+ * 폴트가 나면 파일 페이지의 스왑 인/아웃이 같은 락을 다시 잡으려
+ * 하기 때문입니다. 전송량이 바운스 버퍼 안에 들어가면 락은 한 번만
+ * 잡습니다. */
+static int
+rw_file(struct file *file_obj, int fd, const struct iovec *iov, int iovcnt, off_t *pos,
+		bool is_write, bool *fault)
 {
-	int i=0;
-	check_buffer(buffer, size, true);
+	bool is_console, is_pipe;
+	size_t total = 0;
+
+	is_console = file_obj == (is_write ? STDOUT : STDIN);
+	/* fd 0과 1에는 콘솔 출력만 씁니다 */
+	if (!is_console && (file_obj == NULL || file_obj == STDIN || file_obj == STDOUT ||
+						(is_write && fd < 2)))
+		return -1;
+	/* 콘솔과 파이프에는 위치 개념이 없습니다. */
+	is_pipe = !is_console && file_is_pipe(file_obj);
+	if ((is_console || is_pipe) && pos != NULL)
+		return -1;
+
+	/* 전송을 시작하기 전에 모든 iovec을 한 번에 검사합니다. */
+	for (int i = 0; i < iovcnt; i++)
+	{
+		if (!user_range_ok(iov[i].iov_base, iov[i].iov_len))
+		{
+			*fault = true;
+			return -1;
+		}
+		total += iov[i].iov_len;
+		if (total > INT32_MAX)
+			return -1;
+	}
+	if (total == 0)
+		return 0;
+
+	size_t pages = DIV_ROUND_UP(total, PGSIZE);
+	if (pages > IO_BOUNCE_PAGES)
+		pages = IO_BOUNCE_PAGES;
+	uint8_t *bounce = palloc_get_multiple(0, pages);
+	if (bounce == NULL && pages > 1)
+	{
+		pages = 1;
+		bounce = palloc_get_page(0);
+	}
+	if (bounce == NULL)
+		return -1;
+
+	struct iov_iter it = {iov, iovcnt, 0};
+	size_t cap = pages * PGSIZE;
+	size_t done = 0;
+	while (done < total)
+	{
+		size_t chunk = total - done < cap ? total - done : cap;
+		size_t n;
+
+		if (is_write && !iov_iter_copy(&it, bounce, chunk, false))
+			goto fault;
+
+		if (is_console)
+		{
+			if (is_write)
+				putbuf((const char *)bounce, chunk);
+			else
+				for (size_t i = 0; i < chunk; i++)
+					bounce[i] = input_getc();
+			n = chunk;
+		}
+		else if (is_pipe)
+		{
+			/* 파이프는 filesys_lock 없이 자기 버퍼에서 기다립니다. */
+			int r = is_write ? pipe_write(file_obj, bounce, chunk)
+							 : pipe_read(file_obj, bounce, chunk);
+			if (r < 0)
+			{
+				palloc_free_multiple(bounce, pages);
+				return done > 0 ? (int)done : -1;
+			}
+			n = r;
+		}
+		else
+		{
+			/* 오프셋을 주는 읽기는 파일 위치도 바꾸지 않으므로 다른
+			   읽기와 함께 들어갑니다 */
+			if (!is_write && pos != NULL)
+			{
+				rwlock_read_acquire(&filesys_lock);
+				n = file_read_at(file_obj, bounce, chunk, *pos);
+				rwlock_read_release(&filesys_lock);
+			}
+			else
+			{
+				rwlock_write_acquire(&filesys_lock);
+				if (is_write)
+					n = pos != NULL ? file_write_at(file_obj, bounce, chunk, *pos)
+									: file_write(file_obj, bounce, chunk);
+				else
+					n = file_read(file_obj, bounce, chunk);
+				rwlock_write_release(&filesys_lock);
+			}
+			if (pos != NULL)
+				*pos += n;
+		}
+
+		if (!is_write && !iov_iter_copy(&it, bounce, n, true))
+			goto fault;
+		done += n;
+		if (n < chunk)
+			break;
+	}
+	palloc_free_multiple(bounce, pages);
+	return done;
+
+fault:
+	palloc_free_multiple(bounce, pages);
+	*fault = true;
+	return -1;
+}
+
+/* read/write 계열 시스템 콜의 공통 구현. FD의 파일로 rw_file()을
+ * 부릅니다. 전송하는 동안 파일의 참조를 쥐고 있으므로, fd 테이블을 함께
+ * 쓰는 clone 스레드가 그사이 FD를 닫아도 파일은 전송이 끝난 뒤에
+ * 닫힙니다. */
+static int
+do_rw(int fd, const struct iovec *iov, int iovcnt, off_t *pos, bool is_write)
+{
+	struct file *file_obj;
+	bool fault = false;
+	int ret;
+
 	// fd가 유효한지 먼저 검사
 	if (fd < 0 || fd >= MAX_FD)
 		return -1;
 
-	struct thread *cur = thread_current();
+	file_obj = fdt_get(thread_current(), fd);
+	ret = rw_file(file_obj, fd, iov, iovcnt, pos, is_write, &fault);
+	fdt_put(file_obj);
+	if (fault)
+		sys_exit(-1);
+	return ret;
+}
+
+/* 유저의 iovec 배열 UIOV[IOVCNT]를 커널로 복사한 뒤 전송합니다. */
+static int
+do_rwv(int fd, const struct iovec *uiov, int iovcnt, bool is_write)
+{
+	struct iovec *iov;
+	int ret;
 
-	if (cur->fd_table[fd] == STDOUT && cur->stdout_count != 0)
+	if (iovcnt < 0 || iovcnt > IOV_MAX)
+		return -1;
+	if (iovcnt == 0)
+		return 0;
+	iov = malloc(iovcnt * sizeof *iov);
+	if (iov == NULL)
+		return -1;
+	if (!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
 	{
-		putbuf(buffer, size);
-		return size;
+		free(iov);
+		sys_exit(-1);
 	}
-	struct file *f = process_get_file(fd);
-	if (f == NULL)
-		return -1;
+	ret = do_rw(fd, iov, iovcnt, NULL, is_write);
+	free(iov);
+	return ret;
+}
+
+static int sys_write(int fd, const void *buffer, unsigned size)
+{
+	struct iovec iov = {(void *)buffer, size};
 
-	lock_acquire(&filesys_lock);
-	int bytes_written = file_write(f, buffer, size);
-	lock_release(&filesys_lock);
-	return bytes_written;
+	return do_rw(fd, &iov, 1, NULL, true);
+}
+
+int sys_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+	return do_rwv(fd, iov, iovcnt, true);
+}
+
+/* 파일 위치를 바꾸지 않고 OFFSET에 씁니다. */
+int sys_pwrite(int fd, const void *buffer, unsigned size, off_t offset)
+{
+	struct iovec iov = {(void *)buffer, size};
+
+	if (offset < 0)
+		return -1;
+	return do_rw(fd, &iov, 1, &offset, true);
 }
 
 void sys_exit(int status)
 {
 	struct thread *cur = thread_current();
-	cur->exit_status = status;
+	struct thread *leader = thread_leader(cur);
+
+	/* 어느 스레드가 부르든 프로세스 전체를 끝냅니다. 그룹이 이미 끝나는
+	 * 중이면 먼저 정해진 종료 코드를 따릅니다 */
+	process_kill_group(leader, status);
+	cur->exit_status = leader->group_status;
+	if (cur == leader)
+		printf("%s: exit(%d)\n", thread_name(), cur->exit_status);
+	thread_exit();
+}
 
-	printf("%s: exit(%d)\n", thread_name(), status);
+/* clone 스레드 하나만 끝냅니다. join()이 STATUS를 받습니다. 프로세스의
+ * 첫 스레드가 부르면 exit()과 같습니다. */
+void sys_clone_exit(int status)
+{
+	struct thread *cur = thread_current();
+
+	if (cur->leader == NULL || process_dying())
+		sys_exit(status);
+	cur->exit_status = status;
 	thread_exit();
 }
 
 bool sys_create(const char *file, unsigned initial_size)
 {
-	lock_acquire(&filesys_lock);
-	check_address(file);
-	if (file == NULL )
-	{
-		sys_exit(-1);
-	}
-	bool succ = filesys_create(file, initial_size);
-	lock_release(&filesys_lock);
+	char name[FILE_NAME_BUF];
+
+	if (!get_user_string(name, file, sizeof name))
+		return false;
+	rwlock_write_acquire(&filesys_lock);
+	bool succ = filesys_create(name, initial_size);
+	rwlock_write_release(&filesys_lock);
 	return succ;
 }
 
 bool sys_remove(const char *file)
 {
-	check_address(file);
-	lock_acquire(&filesys_lock);	
-	bool succ= filesys_remove(file);
-	lock_release(&filesys_lock);
+	char name[FILE_NAME_BUF];
+
+	if (!get_user_string(name, file, sizeof name))
+		return false;
+	rwlock_write_acquire(&filesys_lock);	
+	bool succ= filesys_remove(name);
+	rwlock_write_release(&filesys_lock);
 	return succ;
 }
 
@@ -379,94 +972,178 @@ int sys_filesize(int fd)
 	}
 
 	// 파일 객체 가져오기
-	struct file *file_obj = cur->fd_table[fd];
-	if (file_obj == NULL)
+	struct file *file_obj = fdt_get(cur, fd);
+	if (file_obj == NULL || file_obj == STDIN || file_obj == STDOUT || file_is_pipe(file_obj))
 	{
+		fdt_put(file_obj);
 		return -1;
 	}
 
 	off_t size = file_length(file_obj);
+	fdt_put(file_obj);
 	return size;
 }
 
-int sys_read(int fd, void *buffer, unsigned size)
+/* 일반 파일을 가리키는 FD의 파일 객체를 참조를 잡아 반환합니다. 다 쓰면
+ * fdt_put()으로 놓아야 합니다. 콘솔이나 파이프, 닫힌 fd면 NULL을
+ * 반환합니다. */
+static struct file *
+get_regular_file(int fd)
 {
+	struct file *file_obj = process_get_file(fd);
 
-	if (size == 0)
-		return 0;
-
-	check_buffer(buffer, size, false); // 페이지 단위 검사
+	if (file_obj == STDIN || file_obj == STDOUT || file_is_pipe(file_obj))
+	{
+		fdt_put(file_obj);
+		return NULL;
+	}
+	return file_obj;
+}
 
-	struct thread *cur = thread_current();
+/* FD_IN의 LEN 바이트를 FD_OUT으로 유저 버퍼를 거치지 않고 복사합니다.
+ * OFF_IN/OFF_OUT이 NULL이면 각 파일의 현재 위치를 쓰고 옮기며, 아니면
+ * 가리키는 유저 변수의 오프셋을 쓰고 복사한 만큼 갱신합니다.
+ * 복사한 바이트 수를 반환하고, 같은 파일의 겹치는 범위면 -1입니다.
+ *
+ * 데이터는 페이지 단위 커널 버퍼를 거치며, 섹터 정렬된 부분은
+ * inode_read_at()/inode_write_at()이 디스크와 이 버퍼 사이에서 바로
+ * 옮깁니다. 유저 메모리를 만지지 않으므로 청크마다 락을 한 번만
+ * 잡습니다. 이 파일 시스템은 희소 파일이 없어 0으로 찬 구간도 실제로
+ * 써야 하므로 건너뛰지 않습니다. */
+int sys_copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len)
+{
+	struct file *in, *out;
+	off_t pos_in = 0, pos_out = 0;
+	int ret = -1;
 
-	if (fd < 0 || fd >= MAX_FD)
+	/* 파일 참조를 잡기 전에 유저 메모리를 읽어, 폴트로 끝나도 참조가
+	 * 남지 않게 합니다. */
+	if (off_in != NULL && !copy_from_user(&pos_in, off_in, sizeof pos_in))
+		sys_exit(-1);
+	if (off_out != NULL && !copy_from_user(&pos_out, off_out, sizeof pos_out))
+		sys_exit(-1);
+	in = get_regular_file(fd_in);
+	out = get_regular_file(fd_out);
+	if (in == NULL || out == NULL)
+		goto out;
+	if (off_in == NULL)
+		pos_in = file_tell(in);
+	if (off_out == NULL)
+		pos_out = file_tell(out);
+	if (pos_in < 0 || pos_out < 0)
+		goto out;
+	if (len > INT32_MAX)
+		len = INT32_MAX;
+	ret = 0;
+	if (len == 0)
+		goto out;
+
+	/* 같은 inode 안에서 범위가 겹치면 복사 순서에 따라 결과가 달라집니다. */
+	ret = -1;
+	if (file_get_inode(in) == file_get_inode(out) &&
+		(size_t)pos_in < pos_out + len && (size_t)pos_out < pos_in + len)
+		goto out;
+
+	size_t pages = DIV_ROUND_UP(len, PGSIZE);
+	if (pages > IO_BOUNCE_PAGES)
+		pages = IO_BOUNCE_PAGES;
+	uint8_t *buf = palloc_get_multiple(0, pages);
+	if (buf == NULL && pages > 1)
 	{
-		return -1;
+		pages = 1;
+		buf = palloc_get_page(0);
 	}
+	if (buf == NULL)
+		goto out;
 
-	// stdin 처리
-	if (cur->fd_table[fd] == STDIN)
+	size_t cap = pages * PGSIZE;
+	size_t done = 0;
+	while (done < len)
 	{
-		if (cur->stdin_count != 0)
-		{
-			for (unsigned i = 0; i < size; i++)
-			{
-				((char *)buffer)[i] = input_getc();
-			}
-			return size;
-		}
-		return -1;
+		size_t chunk = len - done < cap ? len - done : cap;
+		off_t n, written = 0;
+
+		rwlock_write_acquire(&filesys_lock);
+		n = file_read_at(in, buf, chunk, pos_in);
+		if (n > 0)
+			written = file_write_at(out, buf, n, pos_out);
+		rwlock_write_release(&filesys_lock);
+
+		pos_in += written;
+		pos_out += written;
+		done += written;
+		if (n <= 0 || written < n || (size_t)n < chunk)
+			break;
 	}
+	palloc_free_multiple(buf, pages);
+
+	if (off_in == NULL)
+		file_seek(in, pos_in);
+	if (off_out == NULL)
+		file_seek(out, pos_out);
+	fdt_put(in);
+	fdt_put(out);
+	if (off_in != NULL && !copy_to_user(off_in, &pos_in, sizeof pos_in))
+		sys_exit(-1);
+	if (off_out != NULL && !copy_to_user(off_out, &pos_out, sizeof pos_out))
+		sys_exit(-1);
+	return done;
 
-	struct file *file_obj = cur->fd_table[fd];
+out:
+	fdt_put(in);
+	fdt_put(out);
+	return ret;
+}
 
-	if (file_obj == NULL || file_obj == STDIN || file_obj == STDOUT)
-	{
-		return -1;
-	}
+int sys_read(int fd, void *buffer, unsigned size)
+{
+	struct iovec iov = {buffer, size};
 
-	// 파일 읽기
-	lock_acquire(&filesys_lock);
-	int bytes_read = file_read(file_obj, buffer, size);
-	lock_release(&filesys_lock);
-	return bytes_read;
+	return do_rw(fd, &iov, 1, NULL, false);
 }
 
-int find_unused_fd(const char *file)
+int sys_readv(int fd, const struct iovec *iov, int iovcnt)
 {
-	struct thread *cur = thread_current();
+	return do_rwv(fd, iov, iovcnt, false);
+}
 
-	while (cur->fd_table[cur->fd_idx] && cur->fd_idx < MAX_FD)
-		cur->fd_idx++;
+/* 파일 위치를 바꾸지 않고 OFFSET에서 읽습니다. */
+int sys_pread(int fd, void *buffer, unsigned size, off_t offset)
+{
+	struct iovec iov = {buffer, size};
 
-	if (cur->fd_idx >= MAX_FD)
+	if (offset < 0)
 		return -1;
+	return do_rw(fd, &iov, 1, &offset, false);
+}
 
-	cur->fd_table[cur->fd_idx] = file;
-
-	return cur->fd_idx;
+/* FILE을 가장 낮은 빈 fd에 넣고 그 fd를 반환합니다. 테이블이 가득
+ * 찼으면 -1을 반환합니다. */
+int find_unused_fd(struct file *file)
+{
+	return fdt_alloc(thread_current(), file);
 }
 
 int sys_open(const char *file)
 {
-	//디버깅용 
-	struct therad * thread= thread_current(); 
+	char name[FILE_NAME_BUF];
 
-	check_address(file);
-	if (file == NULL || strcmp(file, "") == 0)
+	if (!get_user_string(name, file, sizeof name) || name[0] == '\0')
 	{
 		return -1;
 	}
-	lock_acquire(&filesys_lock);
-	struct file *file_obj = filesys_open(file);
+	rwlock_write_acquire(&filesys_lock);
+	struct file *file_obj = filesys_open(name);
 	if (file_obj == NULL)
 	{
-		lock_release(&filesys_lock);
+		rwlock_write_release(&filesys_lock);
 		return -1;
 	}
 
 	int fd = find_unused_fd(file_obj);
-	lock_release(&filesys_lock);
+	if (fd < 0)
+		file_close(file_obj);
+	rwlock_write_release(&filesys_lock);
 	return fd;
 }
 
@@ -476,17 +1153,18 @@ void sys_seek(int fd, unsigned position)
 	struct thread *cur = thread_current();
 
 	/* 유효하지 않은 파일 디스크립터인 경우 아무 작업도 하지 않음 */
-	if (fd < 0 || fd >= MAX_FD || cur->fd_table[fd] == STDIN || cur->fd_table[fd] == STDOUT)
+	if (fd < 0 || fd >= MAX_FD)
 	{
 		return;
 	}
 
 	/* fd 테이블에서 해당 파일 객체 가져오기 */
-	struct file *file_obj = cur->fd_table[fd];
+	struct file *file_obj = fdt_get(cur, fd);
 
-	/* 파일이 열려 있지 않다면 리턴 */
-	if (file_obj == NULL)
+	/* 파일이 열려 있지 않거나 콘솔, 파이프라면 리턴 */
+	if (file_obj == NULL || file_obj == STDIN || file_obj == STDOUT || file_is_pipe(file_obj))
 	{
+		fdt_put(file_obj);
 		return;
 	}
 
@@ -497,6 +1175,7 @@ void sys_seek(int fd, unsigned position)
 
 	/* 파일의 현재 읽기/쓰기 위치를 position으로 이동 */
 	file_seek(file_obj, position);
+	fdt_put(file_obj);
 }
 
 /* 현재 열린 파일의 커서 위치를 바이트 단위로 반환하는 시스템 콜 */
@@ -511,41 +1190,182 @@ unsigned sys_tell(int fd)
 	}
 
 	/* fd 테이블에서 해당 파일 객체 가져오기 */
-	struct file *file_obj = cur->fd_table[fd];
+	struct file *file_obj = fdt_get(cur, fd);
 
-	/* 파일이 열려 있지 않다면 -1 반환 */
-	if (file_obj == NULL)
+	/* 파일이 열려 있지 않거나 콘솔, 파이프라면 -1 반환 */
+	if (file_obj == NULL || file_obj == STDIN || file_obj == STDOUT || file_is_pipe(file_obj))
 	{
+		fdt_put(file_obj);
 		return -1;
 	}
 
 	/* 현재 파일의 커서 위치 반환 */
-	return file_tell(file_obj);
+	unsigned pos = file_tell(file_obj);
+	fdt_put(file_obj);
+	return pos;
 }
 
 void sys_close(int fd)
 {
-	struct thread *curr = thread_current();
+	struct thread *curr = thread_leader(thread_current());
 	if (fd < 0 || fd >= MAX_FD)
 		return;
 
-	if (curr->fd_table[fd] == STDIN)
-		curr->stdin_count--;
+	/* 자리를 먼저 비우고 그 자리의 참조를 놓습니다. 다른 스레드가 이
+	 * 파일로 읽거나 쓰는 중이면 그쪽이 참조를 놓을 때 닫힙니다. */
+	fdt_put(fdt_clear(curr, fd));
+}
 
-	if (curr->fd_table[fd] == STDOUT)
-		curr->stdout_count--;
+/* 파이프를 만들고 읽기 끝과 쓰기 끝의 fd를 유저 배열 FDS에 씁니다. */
+int sys_pipe(int *fds)
+{
+	struct thread *cur = thread_current();
+	struct file *read_end, *write_end;
+	int kfds[2];
 
-	struct file *file_object = curr->fd_table[fd];
-	if (file_object == NULL || file_object == STDIN || file_object == STDOUT)
+	if (!pipe_create(&read_end, &write_end))
+		return -1;
+	kfds[0] = fdt_alloc(cur, read_end);
+	kfds[1] = kfds[0] < 0 ? -1 : fdt_alloc(cur, write_end);
+	if (kfds[1] < 0)
 	{
-		curr->fd_table[fd] = NULL;
-		return;
+		/* 테이블에 들어갔던 읽기 끝은 그새 다른 스레드가 잡았을 수 있습니다 */
+		if (kfds[0] >= 0)
+			fdt_put(fdt_clear(cur, kfds[0]));
+		else
+			pipe_close(read_end);
+		pipe_close(write_end);
+		return -1;
+	}
+	if (!copy_to_user(fds, kfds, sizeof kfds))
+		sys_exit(-1);
+	return 0;
+}
+
+/* FILE의 상태가 바뀔 때 깨워지는 큐. 언제나 준비돼 있는 객체는 NULL. */
+static struct poll_queue *
+poll_queue_of(struct file *file)
+{
+	if (file == (struct file *)STDIN)
+		return input_poll_queue();
+	if (file_is_pipe(file))
+		return pipe_poll_queue(file);
+	return NULL;
+}
+
+/* PFD의 fd가 지금 막힘 없이 할 수 있는 일을 revents에 채웁니다. */
+static short
+poll_one(struct thread *cur, struct pollfd *pfd)
+{
+	struct file *file;
+	short revents;
+
+	if (pfd->fd < 0)
+		return pfd->revents = 0;
+	file = fdt_get(cur, pfd->fd);
+	if (file == NULL)
+		revents = POLLNVAL;
+	else if (file == (struct file *)STDIN)
+		revents = input_ready() ? POLLIN : 0;
+	else if (file == (struct file *)STDOUT)
+		revents = POLLOUT;
+	else if (file_is_pipe(file))
+		revents = pipe_poll(file);
+	else
+		revents = POLLIN | POLLOUT;
+	fdt_put(file);
+	return pfd->revents = revents & (pfd->events | POLLERR | POLLHUP | POLLNVAL);
+}
+
+/* FDS의 NFDS개 fd 가운데 하나라도 준비될 때까지 최대 TIMEOUT 밀리초
+ * 기다립니다. 기다리는 동안에는 파이프와 콘솔 입력의 poll 큐마다
+ * 웨이터를 하나씩 걸어 두고 세마포어 하나에서 잠들며, 시간 초과도
+ * 같은 세마포어를 up하는 타이머 알람으로 처리합니다. 깨어나면 전부
+ * 다시 훑으므로 큐에는 "바뀌었을 수 있다"는 신호만 있으면 됩니다. */
+int sys_poll(struct pollfd *ufds, unsigned nfds, int timeout)
+{
+	struct thread *cur = thread_current();
+	struct pollfd *fds;
+	struct poll_waiter *waiters;
+	struct file **files;
+	struct semaphore sema;
+	struct block_threads_struct alarm;
+	int ready = 0;
+	unsigned i;
+
+	if (nfds > MAX_FD)
+		return -1;
+	fds = malloc((nfds + 1) * sizeof *fds);
+	waiters = calloc(nfds + 1, sizeof *waiters);
+	files = calloc(nfds + 1, sizeof *files);
+	if (fds == NULL || waiters == NULL || files == NULL)
+	{
+		free(fds);
+		free(waiters);
+		free(files);
+		return -1;
 	}
-	decrease_dup_count(file_object);
+	if (!copy_from_user(fds, ufds, nfds * sizeof *fds))
+	{
+		free(fds);
+		free(waiters);
+		free(files);
+		sys_exit(-1);
+	}
+
+	/* 웨이터를 먼저 걸고 나서 훑어야, 훑은 뒤 잠들기 전에 생긴
+	 * 사건을 놓치지 않습니다. 웨이터를 건 파일은 참조를 쥐고 있어서
+	 * 기다리는 동안 다른 스레드가 fd를 닫아도 큐가 사라지지 않습니다. */
+	sema_init(&sema, 0);
+	if (timeout != 0)
+		for (i = 0; i < nfds; i++)
+		{
+			struct poll_queue *q;
+
+			if (fds[i].fd < 0)
+				continue;
+			files[i] = fdt_get(cur, fds[i].fd);
+			q = poll_queue_of(files[i]);
+			if (q != NULL)
+				poll_queue_add(q, &waiters[i], &sema);
+		}
+	alarm.sema = NULL;
+	if (timeout > 0)
+		timer_alarm_set(&alarm, timer_ticks() + DIV_ROUND_UP((int64_t)timeout * TIMER_FREQ, 1000), &sema);
 
-	if (check_dup_count(file_object) == 0)
-		file_close(file_object);
-	curr->fd_table[fd] = NULL;
+	for (;;)
+	{
+		ready = 0;
+		for (i = 0; i < nfds; i++)
+			if (poll_one(cur, &fds[i]) != 0)
+				ready++;
+		/* 알람이 울렸으면 alarm.sema는 NULL로 돌아가 있습니다. */
+		if (ready > 0 || timeout == 0 || (timeout > 0 && alarm.sema == NULL))
+			break;
+		/* 스레드 그룹이 끝나는 중이면 그대로 돌아가 syscall_handler에서
+		   끝납니다 */
+		if (!process_sleep(&sema))
+			break;
+	}
+
+	for (i = 0; i < nfds; i++)
+	{
+		poll_queue_remove(&waiters[i]);
+		fdt_put(files[i]);
+	}
+	if (timeout > 0)
+		timer_alarm_cancel(&alarm);
+	free(files);
+
+	if (!copy_to_user(ufds, fds, nfds * sizeof *fds))
+	{
+		free(fds);
+		free(waiters);
+		sys_exit(-1);
+	}
+	free(fds);
+	free(waiters);
+	return ready;
 }
 
 int sys_wait(tid_t pid)
@@ -556,34 +1376,88 @@ int sys_wait(tid_t pid)
 
 int sys_dup2(int oldfd, int newfd)
 {
-	struct thread *cur = thread_current();
+	struct thread *cur = thread_leader(thread_current());
 
-	/* oldfd가 유효하지 않으면, 실패하며 -1을 반환하고, newfd는 닫히지 않습니다. */
-	if (oldfd < 0 || oldfd >= MAX_FD)
-		return -1;
+	struct file *old_obj;
 
-	if (cur->fd_table[oldfd] == NULL)
+	/* oldfd가 유효하지 않으면, 실패하며 -1을 반환하고, newfd는 닫히지 않습니다. */
+	struct file *file_obj = fdt_get(cur, oldfd);
+	if (file_obj == NULL || newfd < 0 || newfd >= MAX_FD)
+	{
+		fdt_put(file_obj);
 		return -1;
+	}
 
 	/* oldfd와 newfd가 같으면, 아무 동작도 하지 않고 newfd를 반환합니다. */
 	if (oldfd == newfd)
+	{
+		fdt_put(file_obj);
 		return newfd;
+	}
 
-	if (cur->fd_table[oldfd] == STDIN)
-		cur->stdin_count++;
-	else if (cur->fd_table[oldfd] == STDOUT)
-		cur->stdout_count++;
-	else
-		increase_dup_count(cur->fd_table[oldfd]);
-
-	/* newfd가 이미 열려 있는 경우, 조용히 닫은 후에 oldfd를 복제합니다. */
-	if (cur->fd_table[newfd] != NULL)
+	/* newfd가 이미 열려 있는 경우, 조용히 닫은 후에 oldfd를 복제합니다.
+	 * 비우기와 넣기를 한 번에 해서 그사이 다른 스레드가 newfd를 차지하지
+	 * 못하게 하고, fdt_get()으로 잡은 참조는 newfd 자리가 넘겨받습니다. */
+	if (!fdt_replace(cur, newfd, file_obj, &old_obj))
 	{
-		lock_acquire(&filesys_lock);
-		sys_close(newfd);
-		lock_release(&filesys_lock);
+		fdt_put(file_obj);
+		return -1;
 	}
-	cur->fd_table[newfd] = cur->fd_table[oldfd];
+	fdt_put(old_obj);
 
 	return newfd;
-}
\ No newline at end of file
+}
+/* CLOCK의 현재 시각을 TS에 씁니다. 틱 수에 TSC로 잰 틱 안의 시간을
+ * 더하므로 틱(10ms)보다 잘게 잴 수 있습니다. */
+int sys_clock_gettime(int clock, struct timespec *ts)
+{
+	struct timespec now;
+	int64_t ns;
+
+	if (clock != CLOCK_MONOTONIC)
+		return -1;
+	ns = timer_nanoseconds();
+	now.tv_sec = ns / 1000000000;
+	now.tv_nsec = ns % 1000000000;
+	if (!copy_to_user(ts, &now, sizeof now))
+		sys_exit(-1);
+	return 0;
+}
+
+/* REQ만큼 잠듭니다. 한 틱 이상이면 틱 단위로 올려서 타이머 휠에
+ * 걸어 재우고, 한 틱보다 짧으면 timer_nsleep()이 hrtimer로 재웁니다. */
+int sys_nanosleep(const struct timespec *req)
+{
+	struct timespec ts;
+	int64_t ns;
+
+	if (!copy_from_user(&ts, req, sizeof ts))
+		sys_exit(-1);
+	if (ts.tv_sec < 0 || ts.tv_sec > INT32_MAX || ts.tv_nsec < 0 ||
+		ts.tv_nsec >= 1000000000)
+		return -1;
+	ns = ts.tv_sec * 1000000000 + ts.tv_nsec;
+	if (ns >= NS_PER_TICK)
+		timer_sleep(DIV_ROUND_UP(ns, NS_PER_TICK));
+	else if (ns > 0)
+		timer_nsleep(ns);
+	return 0;
+}
+
+/* 이 프로세스의 자원 사용량을 USAGE에 씁니다. */
+int sys_getrusage(struct rusage *usage)
+{
+	struct thread_usage *u = thread_usage();
+	struct rusage ru;
+
+	ru.utime_ticks = u->user_ticks;
+	ru.stime_ticks = u->kernel_ticks;
+	ru.page_faults = u->page_faults;
+	ru.swap_ins = u->swap_ins;
+	ru.swap_outs = u->swap_outs;
+	ru.sectors_read = u->sectors_read;
+	ru.sectors_written = u->sectors_written;
+	if (!copy_to_user(usage, &ru, sizeof ru))
+		sys_exit(-1);
+	return 0;
+}
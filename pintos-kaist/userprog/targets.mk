@@ -2,5 +2,11 @@ userprog_SRC  = userprog/process.c	# Process loading.
 userprog_SRC += userprog/exception.c	# User exception handler.
 userprog_SRC += userprog/syscall-entry.S # System call entry.
 userprog_SRC += userprog/syscall.c	# System call handler.
+userprog_SRC += userprog/usercopy.S	# User memory accessors.
+userprog_SRC += userprog/uring.c	# Submission/completion rings.
+userprog_SRC += userprog/fdtable.c	# File descriptor tables.
+userprog_SRC += userprog/pipe.c		# Pipes.
+userprog_SRC += userprog/futex.c	# Fast user-space locking.
+userprog_SRC += userprog/vdso.c	# Read-only page shared with user programs.
 userprog_SRC += userprog/gdt.c		# GDT initialization.
 userprog_SRC += userprog/tss.c		# TSS management.
@@ -2,8 +2,8 @@
 #include <debug.h>
 #include <stddef.h>
 #include "userprog/gdt.h"
+#include "threads/cpu.h"
 #include "threads/thread.h"
-#include "threads/palloc.h"
 #include "threads/vaddr.h"
 #include "intrinsic.h"
 
@@ -43,32 +43,39 @@
  *      not in use, so we can always use that.  Thus, when the
  *      scheduler switches threads, it also changes the TSS's
  *      stack pointer to point to the new thread's kernel stack.
- *      (The call is in schedule in thread.c.) */
+ *      (The call is in schedule in thread.c.)
+ *
+ *  Each CPU switches threads on its own, so each has its own TSS.
+ *  syscall-entry.S finds it through struct cpu, too. */
 
-/* Kernel TSS. */
-struct task_state *tss;
+/* Kernel TSSs, one per CPU. */
+static struct task_state tss_table[NCPU_MAX];
 
-/* Initializes the kernel TSS. */
+/* Initializes this CPU's TSS.  Each CPU calls this once, before
+ * gdt_init(). */
 void
 tss_init (void) {
 	/* Our TSS is never used in a call gate or task gate, so only a
 	 * few fields of it are ever referenced, and those are the only
 	 * ones we initialize. */
-	tss = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+	struct cpu *cpu = this_cpu ();
+
+	cpu->tss = &tss_table[cpu->id];
 	tss_update (thread_current ());
 }
 
-/* Returns the kernel TSS. */
+/* Returns this CPU's TSS. */
 struct task_state *
 tss_get (void) {
+	struct task_state *tss = this_cpu ()->tss;
+
 	ASSERT (tss != NULL);
 	return tss;
 }
 
-/* Sets the ring 0 stack pointer in the TSS to point to the end
- * of the thread stack. */
+/* Sets the ring 0 stack pointer in this CPU's TSS to point to the
+ * end of the thread stack. */
 void
 tss_update (struct thread *next) {
-	ASSERT (tss != NULL);
-	tss->rsp0 = (uint64_t) next + PGSIZE;
+	tss_get ()->rsp0 = (uint64_t) next + PGSIZE;
 }
@@ -0,0 +1,446 @@
+#include "userprog/uring.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include "filesys/file.h"
+#include "filesys/filesys.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/fdtable.h"
+#include "userprog/pipe.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "userprog/usercopy.h"
+#include "userprog/vdso.h"
+#include "vm/vm.h"
+
+/* 제출/완료 링.
+ *
+ * 링 자체는 평범한 익명 유저 페이지입니다. 커널 워커 스레드는 다른
+ * 주소 공간에서 돌기 때문에 유저 메모리를 만지지 않고 커널 버퍼로만
+ * 파일 I/O를 합니다. 유저 메모리와의 복사(쓰기 데이터 가져오기, 읽은
+ * 데이터 돌려주기, 링 인덱스 갱신)와 fd 테이블 조작은 모두 프로세스가
+ * ring_enter()를 부를 때 그 스레드에서 합니다. 그래서 완료 엔트리는
+ * 다음 ring_enter() 때 게시됩니다. */
+
+/* 요청 하나가 한 번에 옮기는 최대 바이트 수 */
+#define RING_IO_PAGES 16
+
+/* 프로세스별 링 상태 */
+struct io_ring
+{
+	struct ring *uring;			/* 유저 주소의 링 페이지 */
+	uint32_t sq_head;			/* 커널 쪽 사본. 유저 값은 믿지 않음 */
+	uint32_t cq_tail;
+	struct lock lock;			/* done, pending 보호 */
+	struct list done;			/* 워커가 끝낸, 게시 대기 중인 요청 */
+	int pending;				/* 워커가 아직 끝내지 않은 요청 수 */
+	int inflight;				/* 제출했지만 게시하지 않은 요청 수 */
+	struct semaphore done_sema; /* 워커가 요청을 끝낼 때마다 up */
+};
+
+/* 요청 */
+struct ring_req
+{
+	struct list_elem elem;
+	struct io_ring *ring;
+	struct ring_sqe sqe;
+	struct file *file; /* 고정해 둔 파일, OPEN이면 연 파일 */
+	uint8_t *buf;	   /* 커널 버퍼 */
+	size_t pages;
+	int64_t res;
+};
+
+/* 워커 큐 */
+static struct list ring_queue;
+static struct lock ring_queue_lock;
+static struct semaphore ring_queue_sema;
+static bool ring_worker_started;
+
+static void ring_worker(void *aux);
+static void ring_execute(struct ring_req *req);
+static void ring_release(struct ring_req *req);
+
+void uring_init(void)
+{
+	list_init(&ring_queue);
+	lock_init(&ring_queue_lock);
+	sema_init(&ring_queue_sema, 0);
+}
+
+/* 페이지 정렬된 빈 유저 주소 UADDR에 링을 만듭니다.
+ * 프로세스당 링은 하나이며 성공하면 0을 반환합니다. */
+int uring_setup(struct ring *uaddr)
+{
+	struct thread *cur = thread_current();
+	struct io_ring *r;
+	struct ring hdr = {0};
+
+	if (cur->ring != NULL || uaddr == NULL || pg_ofs(uaddr) != 0 ||
+		!is_user_vaddr(uaddr) || spt_find_page(current_spt(), uaddr) != NULL ||
+		is_vdso_page(uaddr))
+		return -1;
+
+	lock_acquire(&ring_queue_lock);
+	if (!ring_worker_started &&
+		thread_create("ring-worker", PRI_DEFAULT, ring_worker, NULL) != TID_ERROR)
+		ring_worker_started = true;
+	lock_release(&ring_queue_lock);
+	if (!ring_worker_started)
+		return -1;
+
+	r = malloc(sizeof *r);
+	if (r == NULL)
+		return -1;
+	if (!vm_alloc_page(VM_ANON, uaddr, true) ||
+		!copy_to_user(uaddr, &hdr, offsetof(struct ring, sqes)))
+	{
+		free(r);
+		return -1;
+	}
+	r->uring = uaddr;
+	r->sq_head = 0;
+	r->cq_tail = 0;
+	lock_init(&r->lock);
+	list_init(&r->done);
+	r->pending = 0;
+	r->inflight = 0;
+	sema_init(&r->done_sema, 0);
+	cur->ring = r;
+	return 0;
+}
+
+/* 일반 파일 FD를 찾아 참조를 잡아서, 요청이 끝날 때까지 닫히지 않도록
+ * 고정합니다. */
+static struct file *
+ring_pin_file(int fd)
+{
+	struct thread *cur = thread_current();
+	struct file *file;
+
+	if (fd < 2)
+		return NULL;
+	file = fdt_get(cur, fd);
+	if (file == (struct file *)STDIN || file == (struct file *)STDOUT || file_is_pipe(file))
+	{
+		fdt_put(file);
+		return NULL;
+	}
+	return file;
+}
+
+/* SQE를 요청으로 만듭니다. 커널 버퍼와 쓰기 데이터는 여기서
+ * 준비합니다. 워커가 할 일이 없으면 false를 반환하며, 이때 결과는
+ * REQ->res에 들어 있습니다. */
+static bool
+ring_prepare(struct ring_req *req)
+{
+	struct ring_sqe *sqe = &req->sqe;
+
+	req->res = -1;
+	switch (sqe->opcode)
+	{
+	case RING_OP_NOP:
+		req->res = 0;
+		return false;
+	case RING_OP_CLOSE:
+	{
+		struct file *file = fdt_clear(thread_current(), sqe->fd);
+
+		if (file == NULL)
+			return false;
+		fdt_put(file);
+		req->res = 0;
+		return false;
+	}
+	case RING_OP_READ:
+	case RING_OP_WRITE:
+		if (sqe->len > RING_IO_PAGES * PGSIZE)
+			sqe->len = RING_IO_PAGES * PGSIZE;
+		if (!user_range_ok((void *)sqe->addr, sqe->len))
+			return false;
+		req->pages = sqe->len > 0 ? DIV_ROUND_UP(sqe->len, PGSIZE) : 1;
+		break;
+	case RING_OP_OPEN:
+		req->pages = 1;
+		break;
+	case RING_OP_SEEK:
+		if (sqe->off < 0)
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	if (req->pages > 0)
+	{
+		req->buf = palloc_get_multiple(0, req->pages);
+		if (req->buf == NULL)
+			return false;
+	}
+	if (sqe->opcode == RING_OP_OPEN)
+	{
+		/* 잘못된 주소(-1)나 한 페이지에 끝나지 않는 이름은 WRITE의
+		 * 복사 실패처럼 이 SQE만 실패시킵니다 */
+		int64_t len = strncpy_from_user((char *)req->buf, (const char *)sqe->addr, PGSIZE);
+
+		return len >= 0 && len < PGSIZE;
+	}
+	if (sqe->opcode == RING_OP_WRITE &&
+		!copy_from_user(req->buf, (const void *)sqe->addr, sqe->len))
+		return false;
+	req->file = ring_pin_file(sqe->fd);
+	return req->file != NULL;
+}
+
+/* 완료된 REQ의 결과를 프로세스에 반영합니다. 프로세스 스레드에서
+ * 불리며, 읽은 데이터를 유저 버퍼로 돌려주고 OPEN으로 연 파일을
+ * fd 테이블에 넣습니다. */
+static void
+ring_complete(struct ring_req *req)
+{
+	switch (req->sqe.opcode)
+	{
+	case RING_OP_READ:
+		if (req->res > 0 && !copy_to_user((void *)req->sqe.addr, req->buf, req->res))
+			req->res = -1;
+		break;
+	case RING_OP_OPEN:
+		if (req->file != NULL)
+		{
+			req->res = find_unused_fd(req->file);
+			if (req->res >= 0)
+				req->file = NULL;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/* REQ의 커널 자원을 돌려주고 REQ를 해제합니다. */
+static void
+ring_release(struct ring_req *req)
+{
+	/* fdt_put()은 닫을 때 filesys_lock을 스스로 잡습니다 */
+	if (req->file != NULL && req->sqe.opcode == RING_OP_OPEN)
+	{
+		rwlock_write_acquire(&filesys_lock);
+		file_close(req->file);
+		rwlock_write_release(&filesys_lock);
+	}
+	else if (req->file != NULL)
+		fdt_put(req->file);
+	if (req->buf != NULL)
+		palloc_free_multiple(req->buf, req->pages);
+	free(req);
+}
+
+/* 끝난 요청들을 완료 큐에 빈자리가 있는 만큼 게시하고 그 수를
+ * 반환합니다. 완료 큐가 가득 차면 *FULL을 true로 만듭니다. */
+static unsigned
+ring_reap(struct io_ring *r, bool *full)
+{
+	struct ring *u = r->uring;
+	unsigned posted = 0;
+	uint32_t cq_head;
+
+	*full = false;
+	if (!copy_from_user(&cq_head, &u->cq_head, sizeof cq_head))
+		sys_exit(-1);
+	for (;;)
+	{
+		struct ring_req *req;
+		struct ring_cqe cqe;
+
+		if (r->cq_tail - cq_head >= RING_ENTRIES)
+		{
+			*full = true;
+			break;
+		}
+		lock_acquire(&r->lock);
+		req = list_empty(&r->done) ? NULL
+								   : list_entry(list_pop_front(&r->done), struct ring_req, elem);
+		lock_release(&r->lock);
+		if (req == NULL)
+			break;
+
+		ring_complete(req);
+		cqe.user_data = req->sqe.user_data;
+		cqe.res = req->res;
+		ring_release(req);
+		r->inflight--;
+		if (!copy_to_user(&u->cqes[r->cq_tail % RING_ENTRIES], &cqe, sizeof cqe))
+			sys_exit(-1);
+		r->cq_tail++;
+		posted++;
+	}
+	if (posted > 0 && !copy_to_user(&u->cq_tail, &r->cq_tail, sizeof r->cq_tail))
+		sys_exit(-1);
+	return posted;
+}
+
+/* 링에 쌓인 요청을 최대 TO_SUBMIT개 제출하고, 이번 호출에서 완료가
+ * MIN_COMPLETE개 게시될 때까지 기다립니다. 제출한 요청 수를 반환합니다.
+ * 게시되지 않은 요청이 RING_ENTRIES개면 더 받지 않으므로, 완료 큐를
+ * 비우지 않는 프로세스가 커널 메모리를 계속 쌓을 수는 없습니다. */
+int uring_enter(unsigned to_submit, unsigned min_complete)
+{
+	struct io_ring *r = thread_current()->ring;
+	struct ring *u;
+	unsigned submitted = 0, posted = 0;
+	uint32_t sq_tail;
+	bool full;
+
+	if (r == NULL)
+		return -1;
+	u = r->uring;
+
+	if (!copy_from_user(&sq_tail, &u->sq_tail, sizeof sq_tail))
+		sys_exit(-1);
+	while (submitted < to_submit && r->sq_head != sq_tail && r->inflight < RING_ENTRIES)
+	{
+		struct ring_req *req = calloc(1, sizeof *req);
+
+		if (req == NULL)
+			break;
+		if (!copy_from_user(&req->sqe, &u->sqes[r->sq_head % RING_ENTRIES], sizeof req->sqe))
+		{
+			free(req);
+			sys_exit(-1);
+		}
+		r->sq_head++;
+		submitted++;
+		r->inflight++;
+		req->ring = r;
+
+		if (ring_prepare(req))
+		{
+			lock_acquire(&r->lock);
+			r->pending++;
+			lock_release(&r->lock);
+			lock_acquire(&ring_queue_lock);
+			list_push_back(&ring_queue, &req->elem);
+			lock_release(&ring_queue_lock);
+			sema_up(&ring_queue_sema);
+		}
+		else
+		{
+			/* 바로 끝난 요청. 워커를 거치지 않고 게시를 기다립니다. */
+			lock_acquire(&r->lock);
+			list_push_back(&r->done, &req->elem);
+			lock_release(&r->lock);
+		}
+	}
+	if (!copy_to_user(&u->sq_head, &r->sq_head, sizeof r->sq_head))
+		sys_exit(-1);
+
+	for (;;)
+	{
+		bool idle;
+
+		posted += ring_reap(r, &full);
+		if (posted >= min_complete || full)
+			break;
+		lock_acquire(&r->lock);
+		idle = r->pending == 0 && list_empty(&r->done);
+		lock_release(&r->lock);
+		if (idle)
+			break;
+		sema_down(&r->done_sema);
+	}
+	return submitted;
+}
+
+/* 현재 프로세스의 링을 없앱니다. 워커가 처리 중인 요청이 끝나기를
+ * 기다린 뒤, 게시되지 않은 요청을 모두 버립니다. */
+void uring_destroy(void)
+{
+	struct thread *cur = thread_current();
+	struct io_ring *r = cur->ring;
+
+	if (r == NULL)
+		return;
+	for (;;)
+	{
+		int pending;
+
+		lock_acquire(&r->lock);
+		pending = r->pending;
+		lock_release(&r->lock);
+		if (pending == 0)
+			break;
+		sema_down(&r->done_sema);
+	}
+	while (!list_empty(&r->done))
+		ring_release(list_entry(list_pop_front(&r->done), struct ring_req, elem));
+	cur->ring = NULL;
+	free(r);
+}
+
+/* 워커 스레드. 큐에서 요청을 꺼내 커널 버퍼로만 파일 I/O를 합니다. */
+static void
+ring_worker(void *aux UNUSED)
+{
+	for (;;)
+	{
+		struct ring_req *req;
+		struct io_ring *r;
+
+		sema_down(&ring_queue_sema);
+		lock_acquire(&ring_queue_lock);
+		req = list_entry(list_pop_front(&ring_queue), struct ring_req, elem);
+		lock_release(&ring_queue_lock);
+
+		ring_execute(req);
+
+		r = req->ring;
+		lock_acquire(&r->lock);
+		list_push_back(&r->done, &req->elem);
+		r->pending--;
+		lock_release(&r->lock);
+		sema_up(&r->done_sema);
+	}
+}
+
+static void
+ring_execute(struct ring_req *req)
+{
+	struct ring_sqe *sqe = &req->sqe;
+	/* 오프셋을 주는 읽기만 다른 읽기와 함께 들어갑니다 */
+	bool shared = sqe->opcode == RING_OP_READ && sqe->off >= 0;
+
+	if (shared)
+		rwlock_read_acquire(&filesys_lock);
+	else
+		rwlock_write_acquire(&filesys_lock);
+	switch (sqe->opcode)
+	{
+	case RING_OP_READ:
+		req->res = sqe->off >= 0 ? file_read_at(req->file, req->buf, sqe->len, sqe->off)
+								 : file_read(req->file, req->buf, sqe->len);
+		break;
+	case RING_OP_WRITE:
+		req->res = sqe->off >= 0 ? file_write_at(req->file, req->buf, sqe->len, sqe->off)
+								 : file_write(req->file, req->buf, sqe->len);
+		break;
+	case RING_OP_OPEN:
+		req->file = filesys_open((const char *)req->buf);
+		req->res = req->file != NULL ? 0 : -1;
+		break;
+	case RING_OP_SEEK:
+		file_seek(req->file, sqe->off);
+		req->res = 0;
+		break;
+	default:
+		req->res = -1;
+		break;
+	}
+	if (shared)
+		rwlock_read_release(&filesys_lock);
+	else
+		rwlock_write_release(&filesys_lock);
+}
@@ -0,0 +1,56 @@
+#include "userprog/vdso.h"
+#include <debug.h>
+#include "threads/cpu.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+
+/* VDSO 페이지.
+ *
+ * 커널 페이지 하나를 모든 유저 프로세스의 VDSO_ADDR에 읽기 전용으로
+ * 매핑합니다. 타이머 인터럽트가 틱 수와 load average를, 문맥 전환이
+ * 지금 도는 스레드의 tid를 바로 써 넣으므로 유저 프로그램은 시스템
+ * 콜 없이 이 값들을 읽을 수 있습니다.
+ *
+ * CPU가 하나뿐이면 유저 코드가 이 페이지를 읽는 순간의 tid는 항상
+ * 읽는 스레드 자신의 것입니다. CPU가 여럿이면 한 페이지에 CPU마다
+ * 다른 값을 담을 수 없으므로 tid에는 -1을 씁니다. 페이지는 SPT에 넣지 않으므로 쫓겨나지
+ * 않으며, 주소 공간을 지우기 전에 vdso_unmap()으로 매핑만 걷어 내야
+ * pml4_destroy()가 이 페이지를 해제하지 않습니다. */
+
+static struct vdso_data *vdso;
+
+/* VDSO 페이지를 할당합니다. */
+void
+vdso_init (void) {
+	vdso = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+}
+
+/* PML4의 VDSO_ADDR에 VDSO 페이지를 읽기 전용으로 매핑합니다. */
+bool
+vdso_map (uint64_t *pml4) {
+	ASSERT (vdso != NULL);
+	return pml4_set_page (pml4, (void *) VDSO_ADDR, vdso, false);
+}
+
+/* PML4에서 VDSO 페이지의 매핑을 걷어 냅니다. */
+void
+vdso_unmap (uint64_t *pml4) {
+	pml4_clear_page (pml4, (void *) VDSO_ADDR);
+}
+
+/* 타이머 인터럽트에서 매 틱 호출됩니다. */
+void
+vdso_tick (int64_t ticks) {
+	if (vdso == NULL)
+		return;
+	vdso->ticks = ticks;
+	vdso->load_avg = thread_get_load_avg ();
+}
+
+/* NEXT로 문맥을 전환할 때 호출됩니다. */
+void
+vdso_switch (struct thread *next) {
+	if (vdso != NULL)
+		vdso->tid = cpu_cnt > 1 ? -1 : next->tid;
+}
@@ -5,6 +5,12 @@
 #include "lib/kernel/bitmap.h"
 #include "devices/disk.h"
 #include "threads/mmu.h"
+#include "threads/synch.h"
+#include "filesys/filesys.h"
+#include "filesys/file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
@@ -12,7 +18,42 @@ static bool anon_swap_in(struct page *page, void *kva);
 static bool anon_swap_out(struct page *page);
 static void anon_destroy(struct page *page);
 
-struct bitmap *swap_table;
+/* 스왑 장치. 원시 디스크 전체이거나,
+ * 파일 시스템 디스크 위에 연속으로 할당된 스왑 파일의 섹터 구간입니다. */
+struct swap_device
+{
+	struct disk *disk;	 /* 스왑 영역이 있는 디스크 */
+	disk_sector_t base;	 /* 스왑 영역의 첫 섹터 */
+	struct bitmap *slots; /* 슬롯 사용 여부, true면 사용 중 */
+	int prio;			 /* 클수록 먼저 사용 */
+	struct file *file;	 /* 스왑 파일이면 열린 파일, 원시 디스크면 NULL */
+};
+
+#define SWAP_DEV_MAX 8
+
+/* 우선순위 내림차순으로 정렬된 스왑 장치들.
+ * 우선순위가 같은 장치들은 등록된 순서를 유지합니다. */
+static struct swap_device swap_devs[SWAP_DEV_MAX];
+static size_t swap_dev_cnt;
+
+/* 같은 우선순위 장치들 사이에서 슬롯을 번갈아 할당하기 위한 커서 */
+static unsigned swap_rotor;
+
+/* swap_devs의 슬롯 비트맵을 보호합니다 */
+static struct lock swap_lock;
+
+/* 커맨드라인으로 받은 스왑 장치 설정.
+ * 옵션 파싱은 malloc_init() 이전에 일어나므로 정적 배열에 보관했다가
+ * vm_anon_init()에서 디스크와 파일 시스템이 준비된 뒤에 적용합니다. */
+struct swap_spec
+{
+	bool is_file;
+	char name[32]; /* "hdC:D" 또는 스왑 파일 이름 */
+	size_t page_cnt; /* 스왑 파일 크기 (페이지) */
+	int prio;
+};
+static struct swap_spec swap_specs[SWAP_DEV_MAX];
+static size_t swap_spec_cnt;
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations anon_ops = {
@@ -22,17 +63,284 @@ static const struct page_operations anon_ops = {
 	.type = VM_ANON,
 };
 
+static bool swap_add_device(struct disk *disk, disk_sector_t base,
+							size_t slot_cnt, int prio, struct file *file);
+static bool swap_open_disk(const char *name, int prio);
+static bool swap_open_file(const char *name, size_t page_cnt, int prio);
+static struct swap_device *swap_slot_alloc(size_t *slot);
+static void swap_slot_free(struct swap_device *dev, size_t slot);
+static void swap_io(struct swap_device *dev, size_t slot, void *kva, bool write);
+
+/* SPEC의 ",PRIO" 꼬리를 떼어 *PRIO에 저장합니다. 없으면 0입니다. */
+static void
+split_prio(char *spec, int *prio)
+{
+	char *comma = strchr(spec, ',');
+	*prio = 0;
+	if (comma != NULL)
+	{
+		*comma = '\0';
+		*prio = atoi(comma + 1);
+	}
+}
+
+/* -swap-disk=hdC:D[,PRIO] */
+bool swap_add_disk_option(const char *spec)
+{
+	if (spec == NULL || swap_spec_cnt >= SWAP_DEV_MAX)
+		return false;
+
+	struct swap_spec *s = &swap_specs[swap_spec_cnt];
+	strlcpy(s->name, spec, sizeof s->name);
+	split_prio(s->name, &s->prio);
+	if (strlen(s->name) != 5 || s->name[0] != 'h' || s->name[1] != 'd' || s->name[3] != ':')
+		return false;
+
+	s->is_file = false;
+	swap_spec_cnt++;
+	return true;
+}
+
+/* -swap-file=NAME:PAGES[,PRIO] */
+bool swap_add_file_option(const char *spec)
+{
+	if (spec == NULL || swap_spec_cnt >= SWAP_DEV_MAX)
+		return false;
+
+	struct swap_spec *s = &swap_specs[swap_spec_cnt];
+	strlcpy(s->name, spec, sizeof s->name);
+	split_prio(s->name, &s->prio);
+
+	char *colon = strchr(s->name, ':');
+	if (colon == NULL || colon == s->name)
+		return false;
+	*colon = '\0';
+	s->page_cnt = atoi(colon + 1);
+	if (s->page_cnt == 0)
+		return false;
+
+	s->is_file = true;
+	swap_spec_cnt++;
+	return true;
+}
+
 /* Initialize the data for anonymous pages */
 void vm_anon_init(void)
 {
+	bool default_listed = false;
+
+	lock_init(&swap_lock);
+
 	/* TODO: Set up the swap_disk. */
 	swap_disk = disk_get(1, 1);
-	/** TODO: bitmap 자료구조로 스왑 테이블 만들기
-	 * bitmap_create로 만들기
-	 * 스왑 테이블 엔트리에 이 엔트리가 비어있다는 비트 필요
-	 * bitmap 공부가 필요할듯
-	 */
-	swap_table = bitmap_create(disk_size(swap_disk) / (PGSIZE / DISK_SECTOR_SIZE));
+
+	for (size_t i = 0; i < swap_spec_cnt; i++)
+	{
+		struct swap_spec *s = &swap_specs[i];
+		bool ok;
+
+		if (s->is_file)
+			ok = swap_open_file(s->name, s->page_cnt, s->prio);
+		else
+		{
+			ok = swap_open_disk(s->name, s->prio);
+			if (swap_disk != NULL && !strcmp(s->name, "hd1:1"))
+				default_listed = true;
+		}
+
+		if (!ok)
+			printf("swap: cannot use %s, ignored\n", s->name);
+	}
+
+	/* 기본 스왑 디스크(hd1:1)는 따로 지정하지 않아도 우선순위 0으로 사용합니다 */
+	if (!default_listed && swap_disk != NULL)
+		swap_add_device(swap_disk, 0, disk_size(swap_disk) / SECTORS_PER_PAGE, 0, NULL);
+}
+
+/* 스왑 장치를 우선순위 순서를 지키며 swap_devs에 추가합니다. */
+static bool
+swap_add_device(struct disk *disk, disk_sector_t base, size_t slot_cnt,
+				int prio, struct file *file)
+{
+	if (swap_dev_cnt >= SWAP_DEV_MAX || slot_cnt == 0)
+		return false;
+
+	struct bitmap *slots = bitmap_create(slot_cnt);
+	if (slots == NULL)
+		return false;
+
+	/* 같은 우선순위끼리는 뒤에 붙도록 삽입 위치를 찾습니다 */
+	size_t pos = swap_dev_cnt;
+	while (pos > 0 && swap_devs[pos - 1].prio < prio)
+	{
+		swap_devs[pos] = swap_devs[pos - 1];
+		pos--;
+	}
+
+	swap_devs[pos] = (struct swap_device){
+		.disk = disk,
+		.base = base,
+		.slots = slots,
+		.prio = prio,
+		.file = file,
+	};
+	swap_dev_cnt++;
+	return true;
+}
+
+/* "hdC:D" 이름의 원시 디스크를 스왑 장치로 등록합니다.
+ * 부트 디스크(hd0:0)와 파일 시스템 디스크는 사용할 수 없습니다. */
+static bool
+swap_open_disk(const char *name, int prio)
+{
+	int chan_no = name[2] - '0';
+	int dev_no = name[4] - '0';
+
+	if (chan_no < 0 || dev_no < 0 || dev_no > 1 || (chan_no == 0 && dev_no == 0))
+		return false;
+
+	struct disk *disk = disk_get(chan_no, dev_no);
+	if (disk == NULL || disk == filesys_disk)
+		return false;
+
+	return swap_add_device(disk, 0, disk_size(disk) / SECTORS_PER_PAGE, prio, NULL);
+}
+
+/* 파일 시스템에 PAGE_CNT 페이지 크기의 스왑 파일 NAME을 미리 할당하고
+ * 스왑 장치로 등록합니다. 파일의 섹터가 연속이어야 하며,
+ * 이후로는 파일 시스템을 거치지 않고 해당 섹터를 직접 읽고 씁니다. */
+static bool
+swap_open_file(const char *name, size_t page_cnt, int prio)
+{
+	off_t length = page_cnt * PGSIZE;
+	struct file *file = filesys_open(name);
+
+	if (file == NULL)
+	{
+		if (!filesys_create(name, length))
+			return false;
+		file = filesys_open(name);
+		if (file == NULL)
+			return false;
+	}
+
+	if (file_length(file) < length)
+		goto fail;
+
+	/* 파일이 디스크 위에 연속으로 놓여 있는지 확인합니다 */
+	struct inode *inode = file_get_inode(file);
+	disk_sector_t base = inode_byte_to_sector(inode, 0);
+	for (off_t ofs = 0; ofs < length; ofs += DISK_SECTOR_SIZE)
+		if (inode_byte_to_sector(inode, ofs) != base + ofs / DISK_SECTOR_SIZE)
+			goto fail;
+
+	/* 스왑으로 쓰는 동안 유저 프로세스가 파일을 덮어쓰지 못하게 막습니다 */
+	file_deny_write(file);
+	if (!swap_add_device(filesys_disk, base, page_cnt, prio, file))
+		goto fail;
+	return true;
+
+fail:
+	file_close(file);
+	return false;
+}
+
+/* 빈 스왑 슬롯 하나를 할당해 *SLOT에 저장하고 해당 장치를 반환합니다.
+ * 가장 높은 우선순위 그룹부터 찾으며, 그룹 안에서는 장치를 번갈아 사용해
+ * 여러 디스크에 스왑 I/O가 나뉘도록 합니다. 빈 슬롯이 없으면 NULL을 반환합니다. */
+static struct swap_device *
+swap_slot_alloc(size_t *slot)
+{
+	struct swap_device *found = NULL;
+	size_t i = 0;
+
+	lock_acquire(&swap_lock);
+	while (i < swap_dev_cnt && found == NULL)
+	{
+		/* [i, j)는 우선순위가 같은 장치들입니다 */
+		size_t j = i;
+		while (j < swap_dev_cnt && swap_devs[j].prio == swap_devs[i].prio)
+			j++;
+
+		size_t n = j - i;
+		for (size_t k = 0; k < n; k++)
+		{
+			struct swap_device *dev = &swap_devs[i + (swap_rotor + k) % n];
+			size_t idx = bitmap_scan_and_flip(dev->slots, 0, 1, false);
+			if (idx != BITMAP_ERROR)
+			{
+				swap_rotor++;
+				*slot = idx;
+				found = dev;
+				break;
+			}
+		}
+		i = j;
+	}
+	lock_release(&swap_lock);
+
+	return found;
+}
+
+static void
+swap_slot_free(struct swap_device *dev, size_t slot)
+{
+	lock_acquire(&swap_lock);
+	ASSERT(bitmap_test(dev->slots, slot));
+	bitmap_reset(dev->slots, slot);
+	lock_release(&swap_lock);
+}
+
+/* DEV의 SLOT 번째 슬롯과 KVA 사이에서 한 페이지를 읽거나 씁니다. */
+static void
+swap_io(struct swap_device *dev, size_t slot, void *kva, bool write)
+{
+	disk_sector_t sector = dev->base + slot * SECTORS_PER_PAGE;
+
+	for (int i = 0; i < SECTORS_PER_PAGE; i++)
+	{
+		if (write)
+			disk_write(dev->disk, sector + i, kva + (i * DISK_SECTOR_SIZE));
+		else
+			disk_read(dev->disk, sector + i, kva + (i * DISK_SECTOR_SIZE));
+	}
+}
+
+/* KVA의 한 페이지를 새 스왑 슬롯에 쓰고 그 위치를 SLOT에 기록합니다.
+ * 익명 페이지와 공유 메모리(shm) 페이지가 함께 씁니다.
+ * 빈 슬롯이 없으면 false를 반환합니다. */
+bool swap_slot_save(struct anon_page *slot, void *kva)
+{
+	size_t idx;
+	struct swap_device *dev = swap_slot_alloc(&idx);
+
+	if (dev == NULL)
+		return false;
+	swap_io(dev, idx, kva, true);
+	thread_usage()->swap_outs++;
+	slot->swap_idx = idx;
+	slot->swap_dev = dev;
+	return true;
+}
+
+/* SLOT에 스왑 아웃된 페이지를 KVA로 읽어 오고 슬롯을 비웁니다. */
+void swap_slot_load(struct anon_page *slot, void *kva)
+{
+	ASSERT(slot->swap_idx != -1);
+
+	swap_io(slot->swap_dev, slot->swap_idx, kva, false);
+	thread_usage()->swap_ins++;
+	swap_slot_discard(slot);
+}
+
+/* SLOT이 스왑 슬롯을 가지고 있으면 읽지 않고 반납합니다. */
+void swap_slot_discard(struct anon_page *slot)
+{
+	if (slot->swap_idx == -1)
+		return;
+	swap_slot_free(slot->swap_dev, slot->swap_idx);
+	slot->swap_idx = -1;
+	slot->swap_dev = NULL;
 }
 
 /* Initialize the file mapping */
@@ -46,6 +354,7 @@ bool anon_initializer(struct page *page, enum vm_type type, void *kva)
 
 	struct anon_page *anon_page = &page->anon;
 	anon_page->swap_idx = -1;
+	anon_page->swap_dev = NULL;
 	
 
 	return true;
@@ -63,14 +372,8 @@ anon_swap_in(struct page *page, void *kva)
 	 */
 
 	struct anon_page *anon_page = &page->anon;
-	int swap_idx = anon_page->swap_idx;
-	if(swap_idx !=-1){
-		for(int i=0; i<8; i++){
-			disk_read(swap_disk, (swap_idx * 8 )+ i , kva + (i * DISK_SECTOR_SIZE));
-		}
-		
-		bitmap_set(swap_table, swap_idx, false);
-		anon_page->swap_idx = -1;
+	if(anon_page->swap_idx !=-1){
+		swap_slot_load(anon_page, kva);
 		return true;
 	}
 	return false;
@@ -94,24 +397,13 @@ anon_swap_out(struct page *page)
 	struct anon_page *anon_page = &page->anon;
 	struct frame *frame = page->frame;
 
-	int table_idx = bitmap_scan_and_flip(swap_table, 0, 1, 0);
-	if (table_idx == BITMAP_ERROR)
-	{
-		ASSERT(bitmap_test(swap_table, table_idx) == false);
+	if (!swap_slot_save(anon_page, frame->kva))
 		return false;
-	}
-
-
-	for(int i=0; i<8; i++){
-		disk_write(swap_disk, (table_idx * 8) + i, frame->kva + (DISK_SECTOR_SIZE * i));
-	}
 
 	frame->r_cnt--;
 	page->frame->page = NULL;
 	page->frame = NULL;
 
-	anon_page->swap_idx=table_idx;
-
 	return true;
 
 }
@@ -129,8 +421,7 @@ anon_destroy(struct page *page)
 
     pml4_clear_page(thread_current()->pml4, page->va);
 
-    if (anon_page->swap_idx != -1)
-        bitmap_set(swap_table, anon_page->swap_idx, false);
+    swap_slot_discard(anon_page);
 
     if (page->frame != NULL) {
 		page->frame->r_cnt--;
@@ -63,13 +63,14 @@ file_backed_swap_in(struct page *page, void *kva)
 	size_t length= aux->read_bytes;
 	off_t offset = aux->ofs;
 
-	lock_acquire(&filesys_lock);
+	/* 오프셋을 주고 읽기만 하므로 다른 읽기와 함께 들어갑니다 */
+	rwlock_read_acquire(&filesys_lock);
 	if (file_read_at(file, kva, length, offset) != (int)length) {
         // 읽기 실패 시 처리
-		lock_release(&filesys_lock);
+		rwlock_read_release(&filesys_lock);
         return false;
     }
-	lock_release(&filesys_lock);
+	rwlock_read_release(&filesys_lock);
 
 	size_t page_zero_bytes = PGSIZE - length;
     if (page_zero_bytes > 0) {
@@ -99,9 +100,9 @@ file_backed_swap_out(struct page *page)
 
 	if(pml4_is_dirty(thread_current()->pml4, page->va)){
 		
-		lock_acquire(&filesys_lock);
+		rwlock_write_acquire(&filesys_lock);
 		file_write_at(file, page->frame->kva, read_bytes, offset);
-		lock_release(&filesys_lock);
+		rwlock_write_release(&filesys_lock);
 		pml4_set_dirty(thread_current()->pml4, page->va, 0);
 	}
 
@@ -125,9 +126,9 @@ file_backed_destroy(struct page *page)
 
 	if(pml4_is_dirty(thread_current()->pml4, page->va)){
 		
-		lock_acquire(&filesys_lock);
+		rwlock_write_acquire(&filesys_lock);
 		file_write_at(file, page->frame->kva, read_bytes, offset);
-		lock_release(&filesys_lock);
+		rwlock_write_release(&filesys_lock);
 		pml4_set_dirty(thread_current()->pml4, page->va, 0);
 	}
 
@@ -195,9 +196,9 @@ munmap_cleaner(struct page *page)
 	
 	if(pml4_is_dirty(thread_current()->pml4, page->va)){
 		
-		lock_acquire(&filesys_lock);
+		rwlock_write_acquire(&filesys_lock);
 		file_write_at(file, page->frame->kva, read_bytes, offset);
-		lock_release(&filesys_lock);
+		rwlock_write_release(&filesys_lock);
 		pml4_set_dirty(thread_current()->pml4, page->va, 0);
 	}
 	free(aux);
@@ -209,11 +210,12 @@ munmap_cleaner(struct page *page)
 void do_munmap(void *addr)
 {
 	struct thread *thread = thread_current(); 
-	struct page *page = spt_find_page(&thread->spt, addr);
+	struct supplemental_page_table *spt = current_spt();
+	struct page *page = spt_find_page(spt, addr);
 	ASSERT(page != NULL);
 		
 	// 페이지 제거
-	hash_delete(&thread->spt.spt_hash, &page->hash_elem);
+	spt_remove_page(spt, page);
 	munmap_cleaner(page);
 	// free(page);
 	pml4_clear_page(thread->pml4, pg_round_down(addr));
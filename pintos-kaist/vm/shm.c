@@ -0,0 +1,483 @@
+/* shm.c: 여러 프로세스가 함께 매핑하는 이름 있는 공유 메모리 세그먼트. */
+
+#include "vm/vm.h"
+#include "vm/shm.h"
+#include <round.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/rcu.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/vdso.h"
+
+/* 세그먼트의 한 페이지.
+ *
+ * 세그먼트 페이지의 프레임은 그 페이지를 매핑한 모든 프로세스가 함께
+ * 씁니다. 프레임 테이블에는 프로세스의 페이지 대신 슬롯의 대표 페이지
+ * (anchor)가 올라가므로, 매핑한 프로세스가 모두 떠나도 내용은 세그먼트가
+ * 지워질 때까지 남습니다. 프레임의 r_cnt는 대표 페이지 몫 1에 프레임을
+ * 매핑한 페이지 수를 더한 값입니다.
+ *
+ * 대표 페이지가 교체 대상으로 뽑히면 익명 페이지와 같은 스왑 장치에
+ * 내용을 쓰고, mappers에 있는 모든 매핑의 PTE를 지웁니다. 다음 폴트에서
+ * 처음 들어온 프로세스가 프레임을 다시 올리고 나머지는 그 프레임을
+ * 함께 매핑합니다.
+ *
+ * lock은 anchor.frame과 swap, mappers를 함께 보호합니다. 프레임을 올리는
+ * 쪽과 내보내는 쪽이 이 락으로 줄을 서므로, 두 프로세스가 같은 슬롯에
+ * 프레임을 따로 올리거나 스왑 아웃 도중에 새 매핑이 끼어들지 않습니다.
+ * 세그먼트 하나에 락 하나를 두면 프레임을 받다가 같은 세그먼트의 다른
+ * 슬롯을 내보낼 때 제 락을 다시 잡게 되므로 슬롯마다 둡니다. */
+struct shm_slot
+{
+	struct page anchor;	  /* 프레임 테이블에 올라가는 대표 페이지 */
+	struct anon_page swap; /* 스왑 아웃된 위치, swap_idx가 -1이면 없음 */
+	struct list mappers;  /* 이 프레임을 매핑하고 있는 페이지들 */
+	struct lock lock;	  /* 위 세 멤버를 보호 */
+};
+
+struct shm_segment
+{
+	char name[SHM_NAME_MAX + 1];
+	size_t page_cnt;
+	int ref_cnt;		   /* 이름 몫 1과 세그먼트를 가리키는 매핑 페이지 수 */
+	bool linked;		   /* shm_list에 이름이 남아 있으면 true */
+	struct list_elem elem; /* shm_list 원소 */
+	struct shm_slot *slots; /* page_cnt개 */
+};
+
+static bool shm_swap_in(struct page *page, void *kva);
+static bool shm_anchor_swap_out(struct page *page);
+static void shm_destroy(struct page *page);
+
+/* 프로세스의 주소 공간에 들어가는 매핑 페이지 */
+static const struct page_operations shm_ops = {
+	.swap_in = shm_swap_in,
+	.swap_out = NULL,
+	.destroy = shm_destroy,
+	.type = VM_SHM,
+};
+
+/* 세그먼트 슬롯의 대표 페이지 */
+static const struct page_operations shm_anchor_ops = {
+	.swap_in = NULL,
+	.swap_out = shm_anchor_swap_out,
+	.destroy = NULL,
+	.type = VM_SHM,
+};
+
+/* 이름이 붙어 있는 세그먼트들. 이미 있는 세그먼트를 매핑할 때는 RCU
+ * 읽기 구간에서 락 없이 찾습니다. */
+static struct list shm_list;
+
+/* shm_list를 고치는 쪽과 세그먼트의 linked를 보호합니다. 슬롯의 프레임과
+ * 스왑, mappers는 슬롯마다 있는 락이 따로 보호합니다. */
+static struct lock shm_lock;
+
+void vm_shm_init(void)
+{
+	list_init(&shm_list);
+	lock_init(&shm_lock);
+}
+
+/* NAME 세그먼트를 찾습니다. RCU 읽기 구간 안이나 shm_lock을 쥔 채로
+ * 불러야 합니다. 읽기 구간에서 찾은 세그먼트는 shm_tryget()으로 참조를
+ * 얻어야 구간 밖에서 쓸 수 있습니다. */
+static struct shm_segment *
+shm_lookup(const char *name)
+{
+	struct list_elem *e;
+
+	for (e = list_begin_rcu(&shm_list); e != list_end(&shm_list); e = list_next_rcu(e))
+	{
+		struct shm_segment *seg = list_entry(e, struct shm_segment, elem);
+		if (!strcmp(seg->name, name))
+			return seg;
+	}
+	return NULL;
+}
+
+/* PAGE_CNT 페이지짜리 빈 세그먼트 NAME을 만들어 shm_list에 넣습니다.
+ * 페이지는 처음 폴트가 날 때 0으로 채워진 프레임을 받습니다. shm_lock을
+ * 쥔 채로 불러야 하며, 참조는 이름 몫 하나만 갖고 시작합니다. */
+static struct shm_segment *
+shm_create(const char *name, size_t page_cnt)
+{
+	struct shm_segment *seg = malloc(sizeof *seg);
+
+	if (seg == NULL)
+		return NULL;
+	seg->slots = malloc(page_cnt * sizeof *seg->slots);
+	if (seg->slots == NULL)
+	{
+		free(seg);
+		return NULL;
+	}
+
+	strlcpy(seg->name, name, sizeof seg->name);
+	seg->page_cnt = page_cnt;
+	seg->ref_cnt = 1;
+	seg->linked = true;
+	for (size_t i = 0; i < page_cnt; i++)
+	{
+		struct shm_slot *slot = &seg->slots[i];
+
+		slot->anchor = (struct page){
+			.operations = &shm_anchor_ops,
+			.va = NULL,
+			.frame = NULL,
+			.writable = true,
+			.shm = {.seg = seg, .idx = i},
+		};
+		slot->swap.swap_idx = -1;
+		slot->swap.swap_dev = NULL;
+		list_init(&slot->mappers);
+		lock_init(&slot->lock);
+	}
+	list_push_back_rcu(&shm_list, &seg->elem);
+	return seg;
+}
+
+/* 이름도 매핑도 남지 않은 SEG의 프레임과 스왑 슬롯을 돌려주고 해제합니다.
+ * 읽기 구간에서 shm_list를 훑던 쪽이 아직 SEG를 보고 있을 수 있으므로
+ * 구조체는 유예 기간이 지난 뒤 해제합니다.
+ *
+ * 대표 페이지를 내보내는 쪽은 프레임을 프레임 테이블에서 꺼내기 전에
+ * shm_anchor_pin()으로 참조를 얻어 두므로, 여기까지 왔으면 어느 프레임도
+ * 교체 중이 아니고 모두 프레임 테이블에 있습니다. */
+static void
+shm_free(struct shm_segment *seg)
+{
+	for (size_t i = 0; i < seg->page_cnt; i++)
+	{
+		struct shm_slot *slot = &seg->slots[i];
+		struct frame *frame;
+
+		lock_acquire(&slot->lock);
+		frame = slot->anchor.frame;
+		ASSERT(list_empty(&slot->mappers));
+		if (frame != NULL)
+		{
+			list_remove(&frame->frame_elem);
+			palloc_free_page(frame->kva);
+			free(frame);
+			slot->anchor.frame = NULL;
+		}
+		swap_slot_discard(&slot->swap);
+		lock_release(&slot->lock);
+	}
+	free(seg->slots);
+	rcu_free(seg);
+}
+
+/* 참조가 남아 있으면 SEG 참조를 하나 얻고 true를 반환합니다. 이미
+ * 0이면 해제되는 중이므로 false를 반환합니다. */
+static bool
+shm_tryget(struct shm_segment *seg)
+{
+	int cnt = __atomic_load_n(&seg->ref_cnt, __ATOMIC_RELAXED);
+
+	do
+	{
+		if (cnt == 0)
+			return false;
+	} while (!__atomic_compare_exchange_n(&seg->ref_cnt, &cnt, cnt + 1, true,
+										  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+	return true;
+}
+
+/* 이미 참조를 쥐고 있는 SEG의 참조를 하나 더 얻습니다. */
+static void
+shm_get(struct shm_segment *seg)
+{
+	ASSERT(seg->ref_cnt > 0);
+	__atomic_add_fetch(&seg->ref_cnt, 1, __ATOMIC_RELAXED);
+}
+
+/* SEG에 대한 참조 하나를 놓습니다. */
+static void
+shm_put(struct shm_segment *seg)
+{
+	ASSERT(seg->ref_cnt > 0);
+	if (__atomic_sub_fetch(&seg->ref_cnt, 1, __ATOMIC_ACQ_REL) == 0)
+		shm_free(seg);
+}
+
+/* uninit 페이지를 매핑 페이지로 바꿉니다. aux로 받은 struct shm_page의
+ * seg, idx, map_cnt를 옮겨 받고 세그먼트 참조를 하나 가져갑니다.
+ * 프레임은 shm_claim_page()가 폴트 때 붙입니다. */
+bool shm_initializer(struct page *page, enum vm_type type UNUSED, void *kva UNUSED)
+{
+	struct shm_page *aux = page->uninit.aux;
+
+	page->operations = &shm_ops;
+	page->shm = (struct shm_page){
+		.seg = aux->seg,
+		.idx = aux->idx,
+		.owner = thread_leader(thread_current()),
+		.map_cnt = aux->map_cnt,
+	};
+	free(aux);
+
+	/* shm_map()이나 fork하는 부모의 매핑 페이지가 참조를 쥐고 있습니다 */
+	shm_get(page->shm.seg);
+	return true;
+}
+
+/* 매핑 페이지는 shm_claim_page()에서만 프레임을 받습니다. */
+static bool
+shm_swap_in(struct page *page UNUSED, void *kva UNUSED)
+{
+	return true;
+}
+
+/* 폴트가 난 매핑 페이지 PAGE에 세그먼트 슬롯의 프레임을 매핑합니다.
+ * 아무도 올려 두지 않았으면 새 프레임을 받아 스왑에서 읽거나 0으로
+ * 채웁니다. */
+bool shm_claim_page(struct page *page)
+{
+	struct shm_slot *slot = &page->shm.seg->slots[page->shm.idx];
+	struct frame *frame;
+	bool success = false;
+
+	/* 프레임을 확인하고 매핑을 mappers에 올릴 때까지 슬롯 락을 쥡니다.
+	 * vm_get_frame()이 다른 슬롯의 대표 페이지를 내보낼 수는 있지만, 이
+	 * 슬롯은 프레임이 없으므로 교체 대상에 오르지 않습니다. */
+	lock_acquire(&slot->lock);
+	frame = slot->anchor.frame;
+	if (frame == NULL)
+	{
+		frame = vm_get_frame();
+		if (slot->swap.swap_idx != -1)
+			swap_slot_load(&slot->swap, frame->kva);
+		else
+			memset(frame->kva, 0, PGSIZE);
+		frame->page = &slot->anchor;
+		frame->r_cnt = 1;
+		slot->anchor.frame = frame;
+	}
+
+	if (pml4_set_page(thread_current()->pml4, page->va, frame->kva, page->writable))
+	{
+		page->frame = frame;
+		frame->r_cnt++;
+		list_push_back(&slot->mappers, &page->shm.elem);
+		success = true;
+	}
+	lock_release(&slot->lock);
+	return success;
+}
+
+/* 교체 대상으로 고른 대표 페이지 ANCHOR의 세그먼트에 참조를 얻습니다.
+ * vm_get_victim()이 프레임을 프레임 테이블에서 꺼내기 전에 부르며,
+ * 참조는 shm_anchor_swap_out()이 끝날 때 놓습니다. 세그먼트가 이미
+ * 해제되는 중이면 false를 반환하고, 그 프레임은 shm_free()가 거둡니다. */
+bool shm_anchor_pin(struct page *anchor)
+{
+	ASSERT(anchor->operations == &shm_anchor_ops);
+	return shm_tryget(anchor->shm.seg);
+}
+
+/* 대표 페이지 PAGE의 프레임을 스왑으로 내보냅니다. 프레임을 매핑한
+ * 모든 프로세스의 PTE를 지우므로 vm_evict_frame()이 따로 지울 것은
+ * 없습니다. shm_anchor_pin()으로 얻은 참조를 놓습니다. */
+static bool
+shm_anchor_swap_out(struct page *page)
+{
+	struct shm_segment *seg = page->shm.seg;
+	struct shm_slot *slot = &seg->slots[page->shm.idx];
+	struct frame *frame = page->frame;
+
+	lock_acquire(&slot->lock);
+	if (!swap_slot_save(&slot->swap, frame->kva))
+	{
+		/* 프레임은 그대로 슬롯에 남으므로 shm_free()가 찾을 수 있게
+		 * 프레임 테이블에 되돌립니다 */
+		list_push_back(&frame_table->frame_list, &frame->frame_elem);
+		lock_release(&slot->lock);
+		shm_put(seg);
+		return false;
+	}
+
+	while (!list_empty(&slot->mappers))
+	{
+		struct page *mapper = list_entry(list_pop_front(&slot->mappers),
+										 struct page, shm.elem);
+
+		pml4_clear_page(mapper->shm.owner->pml4, mapper->va);
+		mapper->frame = NULL;
+	}
+
+	frame->r_cnt = 0;
+	frame->page = NULL;
+	page->frame = NULL;
+	lock_release(&slot->lock);
+	shm_put(seg);
+	return true;
+}
+
+/* 매핑 페이지를 지웁니다. 프레임은 세그먼트 몫이므로 남겨 둡니다.
+ * PAGE는 호출자가 해제합니다. */
+static void
+shm_destroy(struct page *page)
+{
+	struct shm_slot *slot = &page->shm.seg->slots[page->shm.idx];
+
+	/* 대표 페이지가 내보내지는 중이면 page->frame이 그 안에서 지워지므로
+	 * 슬롯 락을 쥐고 봅니다 */
+	lock_acquire(&slot->lock);
+	if (page->frame != NULL)
+	{
+		list_remove(&page->shm.elem);
+		pml4_clear_page(thread_current()->pml4, page->va);
+		page->frame->r_cnt--;
+		page->frame = NULL;
+	}
+	lock_release(&slot->lock);
+	shm_put(page->shm.seg);
+}
+
+/* SEG의 IDX 번째 페이지를 현재 프로세스의 VA에 매핑 페이지로 넣습니다. */
+static bool
+shm_add_page(struct shm_segment *seg, size_t idx, void *va, bool writable,
+			 size_t map_cnt)
+{
+	struct shm_page *aux = malloc(sizeof *aux);
+	struct page *page;
+
+	if (aux == NULL)
+		return false;
+	aux->seg = seg;
+	aux->idx = idx;
+	aux->map_cnt = map_cnt;
+	if (!vm_alloc_page_with_initializer(VM_SHM, va, writable, NULL, aux))
+	{
+		free(aux);
+		return false;
+	}
+
+	/* 내용은 세그먼트에 있으므로 지연 로딩할 것이 없습니다.
+	 * uninit 상태를 바로 거쳐 매핑 페이지로 만듭니다. */
+	page = spt_find_page(current_spt(), va);
+	return swap_in(page, NULL);
+}
+
+/* fork 중인 자식의 SPT에 부모 매핑 페이지 SRC와 같은 세그먼트 페이지를
+ * 넣습니다. 자식은 첫 폴트 때 같은 프레임을 매핑합니다. */
+bool shm_copy_page(struct page *src)
+{
+	return shm_add_page(src->shm.seg, src->shm.idx, src->va, src->writable,
+						src->shm.map_cnt);
+}
+
+/* 현재 프로세스에서 ADDR부터 PAGE_CNT 페이지의 매핑 페이지를 지웁니다. */
+static void
+shm_remove_pages(void *addr, size_t page_cnt)
+{
+	struct supplemental_page_table *spt = current_spt();
+
+	for (size_t i = 0; i < page_cnt; i++)
+	{
+		struct page *page = spt_find_page(spt, addr + i * PGSIZE);
+
+		if (page == NULL || page_get_type(page) != VM_SHM)
+			continue;
+		spt_remove_page(spt, page);
+		vm_dealloc_page(page);
+	}
+}
+
+/* 세그먼트 NAME의 앞 SIZE 바이트를 현재 프로세스의 ADDR에 매핑합니다.
+ * 세그먼트가 없으면 SIZE를 페이지 단위로 올린 크기로 새로 만듭니다.
+ * 성공하면 ADDR을, 실패하면 NULL을 반환합니다. */
+void *shm_map(const char *name, size_t size, void *addr, bool writable)
+{
+	struct supplemental_page_table *spt = current_spt();
+	size_t page_cnt = DIV_ROUND_UP(size, PGSIZE);
+	struct shm_segment *seg;
+
+	if (addr == NULL || pg_ofs(addr) != 0 || page_cnt == 0)
+		return NULL;
+	if (!is_user_vaddr(addr) || page_cnt > ((uint64_t)KERN_BASE - (uint64_t)addr) / PGSIZE)
+		return NULL;
+	for (size_t i = 0; i < page_cnt; i++)
+		if (spt_find_page(spt, addr + i * PGSIZE) != NULL ||
+			is_vdso_page(addr + i * PGSIZE))
+			return NULL;
+
+	/* 매핑하는 동안 세그먼트가 사라지지 않도록 참조를 하나 쥡니다. 이미
+	 * 있는 세그먼트는 락 없이 찾고, 없을 때만 shm_lock을 쥐고 만듭니다.
+	 * 찾은 뒤에 이름이 지워졌으면 같은 이름으로 새로 만들어야 하므로
+	 * 놓고 다시 찾습니다. */
+	rcu_read_lock();
+	seg = shm_lookup(name);
+	if (seg != NULL && !shm_tryget(seg))
+		seg = NULL;
+	rcu_read_unlock();
+	if (seg != NULL && !__atomic_load_n(&seg->linked, __ATOMIC_ACQUIRE))
+	{
+		shm_put(seg);
+		seg = NULL;
+	}
+
+	if (seg == NULL)
+	{
+		lock_acquire(&shm_lock);
+		seg = shm_lookup(name);
+		if (seg == NULL)
+			seg = shm_create(name, page_cnt);
+		if (seg != NULL)
+			shm_get(seg);
+		lock_release(&shm_lock);
+		if (seg == NULL)
+			return NULL;
+	}
+	if (seg->page_cnt < page_cnt)
+	{
+		shm_put(seg);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < page_cnt; i++)
+		if (!shm_add_page(seg, i, addr + i * PGSIZE, writable, i == 0 ? page_cnt : 0))
+		{
+			shm_remove_pages(addr, i);
+			addr = NULL;
+			break;
+		}
+	shm_put(seg);
+	return addr;
+}
+
+/* shm_map()으로 ADDR에 만든 매핑을 통째로 지웁니다. */
+void shm_unmap(void *addr)
+{
+	struct page *page = spt_find_page(current_spt(), addr);
+
+	if (page == NULL || page_get_type(page) != VM_SHM || page->shm.map_cnt == 0)
+		return;
+	shm_remove_pages(addr, page->shm.map_cnt);
+}
+
+/* 세그먼트 NAME의 이름을 지웁니다. 이미 매핑한 프로세스는 계속 쓸 수
+ * 있고, 마지막 매핑이 사라질 때 세그먼트가 해제됩니다. */
+bool shm_unlink(const char *name)
+{
+	struct shm_segment *seg;
+
+	lock_acquire(&shm_lock);
+	seg = shm_lookup(name);
+	if (seg == NULL)
+	{
+		lock_release(&shm_lock);
+		return false;
+	}
+	__atomic_store_n(&seg->linked, false, __ATOMIC_RELEASE);
+	list_remove_rcu(&seg->elem);
+	lock_release(&shm_lock);
+
+	/* 이름 몫의 참조를 놓습니다 */
+	shm_put(seg);
+	return true;
+}
@@ -13,6 +13,7 @@ void vm_init(void)
 {
 	vm_anon_init();
 	vm_file_init();
+	vm_shm_init();
 #ifdef EFILESYS /* For project 4 */
 	pagecache_init();
 #endif
@@ -54,7 +55,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 									vm_initializer *init, void *aux)
 {
 
-	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct supplemental_page_table *spt = current_spt();
 	ASSERT(spt!=NULL);
 
 	/* 이미 해당 page가 SPT에 존재하는지 확인합니다 */
@@ -75,6 +76,9 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 		case VM_FILE:
 			page_initializer = file_backed_initializer;
 			break;
+		case VM_SHM:
+			page_initializer = shm_initializer;
+			break;
 		default:
 			free(page);
 			goto err;
@@ -99,6 +103,31 @@ err:
 	return false;
 }
 
+/* 현재 스레드가 속한 프로세스의 SPT. clone 스레드는 leader의 것을 씁니다. */
+struct supplemental_page_table *
+current_spt(void)
+{
+	return &thread_leader(thread_current())->spt;
+}
+
+/* SPT 락을 잡습니다. 폴트 처리처럼 이미 잡고 있는 경로에서 다시 불려도
+ * 되도록, 새로 잡았을 때만 true를 반환합니다. */
+static bool
+spt_lock(struct supplemental_page_table *spt)
+{
+	if (lock_held_by_current_thread(&spt->lock))
+		return false;
+	lock_acquire(&spt->lock);
+	return true;
+}
+
+static void
+spt_unlock(struct supplemental_page_table *spt, bool taken)
+{
+	if (taken)
+		lock_release(&spt->lock);
+}
+
 /* Find VA from spt and return page. On error, return NULL. */
 /* 가상 주소를 통해 SPT에서 페이지를 찾아 리턴합니다.
  * 에러가 발생하면 NULL을 리턴하세요 */
@@ -112,7 +141,9 @@ spt_find_page(struct supplemental_page_table *spt, void *va)
 	struct page temp;
 	temp.va = pg_round_down(va);
 	
+	bool taken = spt_lock(spt);
 	struct hash_elem *e = hash_find(&spt->spt_hash, &temp.hash_elem);
+	spt_unlock(spt, taken);
 	
 	if (e == NULL)
 		return NULL;
@@ -128,7 +159,9 @@ bool spt_insert_page(struct supplemental_page_table *spt,
 {
 	int succ = false;
 	ASSERT(page!=NULL);
+	bool taken = spt_lock(spt);
 	struct hash_elem * e=hash_insert(&spt->spt_hash, &page->hash_elem);
+	spt_unlock(spt, taken);
 	if(e!=NULL) return succ; //실패했음
 
 	succ=true;
@@ -137,7 +170,9 @@ bool spt_insert_page(struct supplemental_page_table *spt,
 
 void spt_remove_page(struct supplemental_page_table *spt, struct page *page)
 {
+	bool taken = spt_lock(spt);
 	hash_delete(&spt->spt_hash, &page->hash_elem);	
+	spt_unlock(spt, taken);
 	// vm_dealloc_page(page); //<< 이거 쓰면 swap out~->swap in이 안될 것 같은데? 
 
 }
@@ -147,15 +182,25 @@ static struct frame *
 vm_get_victim(void)
 {
 	struct frame *victim;
+	struct list_elem *e;
 	/* TODO: 교체 정책을 여기서 구현해서 희생자 페이지 찾기 */
 
 	ASSERT(list_empty(&frame_table->frame_list)==false);
-		
 
-	victim = list_entry(list_pop_front(&frame_table->frame_list), struct frame, frame_elem);
-	ASSERT(victim!=NULL);
-
-	return victim;
+	for (e = list_begin(&frame_table->frame_list); e != list_end(&frame_table->frame_list);
+		 e = list_next(e))
+	{
+		victim = list_entry(e, struct frame, frame_elem);
+
+		/* shm 대표 페이지는 꺼내기 전에 세그먼트를 붙잡아 둡니다. 해제되는
+		 * 중인 세그먼트의 프레임은 shm_free()가 가져가도록 남겨 둡니다 */
+		if (victim->page != NULL && page_get_type(victim->page) == VM_SHM &&
+			!shm_anchor_pin(victim->page))
+			continue;
+		list_remove(e);
+		return victim;
+	}
+	return NULL;
 }
 
 /* 한 페이지를 교체(evict)하고 해당 프레임을 반환합니다.
@@ -168,6 +213,11 @@ vm_evict_frame(void)
 
 	struct page *page =victim->page;
 	if (page) {
+		/* shm 대표 페이지는 swap_out이 매핑한 모든 프로세스에서 PTE를 지우고
+		 * 연결도 끊습니다. 세그먼트가 그 안에서 해제될 수 있으므로 끝난
+		 * 뒤에는 PAGE를 건드리지 않습니다 */
+		if (page_get_type(page) == VM_SHM)
+			return swap_out(page) ? victim : NULL;
 		if (!swap_out(page))
 			return NULL;
 		pml4_clear_page(thread_current()->pml4, page->va);
@@ -185,7 +235,7 @@ vm_evict_frame(void)
  * 사용 가능한 페이지가 없으면 페이지를 교체(evict)하여 반환합니다.
  * 이 함수는 항상 유효한 주소를 반환합니다. 즉, 사용자 풀 메모리가 가득 차면,
  * 이 함수는 프레임을 교체하여 사용 가능한 메모리 공간을 확보합니다.*/
-static struct frame *
+struct frame *
 vm_get_frame(void)
 {
 	struct frame *frame = malloc(sizeof(struct frame));
@@ -246,17 +296,45 @@ vm_handle_wp(struct page *page)
 /* 인터럽트 프레임, addr=폴트를 일으킨 주소(코드일 수도있고 데이터일수도 있음),
 user=사용자 접근인지 커널 접근인지, write=true면 쓰기 허용 false면 읽기만
 not_present: true면 존재하지 않는 페이지, false면 권한없어서 페이지 폴트 에러  */
+/* 유저 모드의 rsp를 구합니다. 커널 모드 폴트(시스템 콜 중 유저 메모리
+ * 접근)라면, 유저 모드에서 커널로 들어올 때 만든 intr_frame이 항상
+ * 커널 스택 맨 위(tss의 rsp0 바로 아래)에 있으므로 거기서 읽습니다. */
+static uintptr_t
+user_stack_pointer(struct intr_frame *f, bool user)
+{
+	struct intr_frame *uf;
+
+	if (user)
+		return f->rsp;
+	uf = (struct intr_frame *)((uint8_t *)thread_current() + PGSIZE) - 1;
+	return uf->rsp;
+}
+
+static bool handle_fault(struct supplemental_page_table *spt, struct intr_frame *f,
+						 void *addr, bool user, bool write, bool not_present);
+
+/* 같은 SPT를 쓰는 clone 스레드들이 한 페이지를 동시에 claim하지 않도록
+ * 폴트 처리 전체를 SPT 락 안에서 합니다. */
 bool vm_try_handle_fault(struct intr_frame *f , void *addr ,
-						 bool user UNUSED, bool write , bool not_present )
+						 bool user, bool write , bool not_present )
 {
 
 	// ASSERT(addr!=NULL);
     if (!is_user_vaddr(addr)) return false;
 
-    struct supplemental_page_table *spt = &thread_current()->spt;
+    struct supplemental_page_table *spt = current_spt();
+	bool taken = spt_lock(spt);
+	bool succ = handle_fault(spt, f, addr, user, write, not_present);
+	spt_unlock(spt, taken);
+	return succ;
+}
+
+static bool handle_fault(struct supplemental_page_table *spt, struct intr_frame *f,
+						 void *addr, bool user, bool write, bool not_present)
+{
 	// addr = pg_round_down(addr);
     struct page *page = spt_find_page(spt, addr);
-	uintptr_t rsp = thread_current()->user_rsp; // 유저 스택의 rsp 가져오기
+	uintptr_t rsp = user_stack_pointer(f, user); // 유저 스택의 rsp 가져오기
 
 	if (page && write && !not_present) {
         if (!page->writable) {  
@@ -296,7 +374,7 @@ void vm_dealloc_page(struct page *page)
 /* VA에 할당된 페이지를 요구합니다 . */
 bool vm_claim_page(void *va)
 {
-	struct page *page = spt_find_page(&thread_current()->spt, va);
+	struct page *page = spt_find_page(current_spt(), va);
 	/* TODO: Fill this function */
 	if(page==NULL) return false;
 
@@ -307,6 +385,10 @@ bool vm_claim_page(void *va)
 static bool
 vm_do_claim_page(struct page *page)
 {
+	/* 공유 메모리 페이지는 새 프레임 대신 세그먼트의 프레임을 매핑합니다 */
+	if (page_get_type(page) == VM_SHM)
+		return shm_claim_page(page);
+
 	struct frame *frame = vm_get_frame();
 	
 	/* Set links */
@@ -341,6 +423,7 @@ size_t page_hash(const struct hash_elem *e, void * aux){
 /* Initialize new supplemental page table */
 void supplemental_page_table_init(struct supplemental_page_table *spt)
 {
+	lock_init(&spt->lock);
 	if(!hash_init(&spt->spt_hash, page_hash, is_less, NULL))
 		return;
 }
@@ -371,7 +454,7 @@ static void *duplicate_aux(struct page *src_page, enum vm_type type)
 }
 
 bool page_table_copy(struct page* src_page, void *va){
-	struct page *page= spt_find_page(&thread_current()->spt, va);
+	struct page *page= spt_find_page(current_spt(), va);
 	if(page==NULL) return false;
 
 	if(page->frame == NULL){
@@ -388,7 +471,19 @@ bool page_table_copy(struct page* src_page, void *va){
 	return swap_in(page, src_page->frame->kva);
 }
 
+static bool spt_copy(struct supplemental_page_table *dst, struct supplemental_page_table *src);
+
+/* 부모의 clone 스레드가 도중에 SRC를 바꾸지 못하도록 SRC의 락을 잡고
+ * 복사합니다. */
 bool supplemental_page_table_copy(struct supplemental_page_table *dst , struct supplemental_page_table *src )
+{
+	lock_acquire(&src->lock);
+	bool succ = spt_copy(dst, src);
+	lock_release(&src->lock);
+	return succ;
+}
+
+static bool spt_copy(struct supplemental_page_table *dst, struct supplemental_page_table *src)
 {
    struct hash_iterator i;
    hash_first(&i, &src->spt_hash);
@@ -430,6 +525,12 @@ bool supplemental_page_table_copy(struct supplemental_page_table *dst , struct s
 	  
 		  continue;
 	  }
+	  else if (type == VM_SHM)
+	  {
+		  if (!shm_copy_page(src_page))
+			  return false;
+		  continue;
+	  }
 	  else if(type==VM_ANON){
 		  // 3. type이 anon 이면 
 		  if (!vm_alloc_page(type, upage, writable)) // uninit page 생성 & 초기화
@@ -470,4 +571,4 @@ void supplemental_page_table_kill(struct supplemental_page_table *spt)
 	*/
 	// hash_destroy(&spt->spt_hash, page_desturctor);
 	hash_clear(&spt->spt_hash, page_desturctor);
-}
\ No newline at end of file
+}
\ No newline at end of file